@@ -0,0 +1,222 @@
+/*
+  ==============================================================================
+
+    ConcurrencyChecks.cpp
+
+  ==============================================================================
+*/
+
+#include "ConcurrencyChecks.h"
+#include "../../Source/DSP/ParameterEventQueue.h"
+#include "../../Source/DSP/DelayMemory.h"
+#include "../../Source/DSP/DelayKernels.h"
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+namespace
+{
+    constexpr int blockSize = 64;
+
+    // Each producer counts up on a slot of its own; a float holds every count exactly
+    constexpr int numProducers = 4;
+    constexpr int changesPerProducer = 50000;
+    constexpr float producerStride = 1 << 20;
+
+    // Sample n of a channel: spread over [-1, 1) and exact in float
+    float getTestSample (juce::int64 n, int channel) noexcept
+    {
+        return static_cast<float> ((n * 31 + channel * 977) % 65536 - 32768) / 32768.0f;
+    }
+
+    // A few steps of the 16-bit formats, which every history may have passed through
+    constexpr float swapTolerance = 4.0f * 2.0f / 32768.0f;
+    constexpr int numSwaps = 40;
+}
+
+bool checkParameterEventQueue()
+{
+    ghostline::ParameterEventQueue queue;
+    queue.reset();
+
+    std::atomic<int> producersDone { 0 };
+    std::vector<std::thread> producers;
+
+    for (int producer = 0; producer < numProducers; ++producer)
+    {
+        producers.emplace_back ([&queue, &producersDone, producer]
+        {
+            // A full queue drops the change, so wait for room and offer it again
+            for (int count = 1; count <= changesPerProducer; ++count)
+                while (! queue.add (producer, static_cast<float> (producer) * producerStride + static_cast<float> (count), true))
+                    std::this_thread::yield();
+
+            producersDone.fetch_add (1);
+        });
+    }
+
+    // As processSamples runs it: schedule a block, then apply up to each change in turn
+    float values[ghostline::ParameterEventQueue::maxSlots] = {};
+    float lastSeen[numProducers] = {};
+    juce::int64 applied = 0;
+    int outOfOrder = 0;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds (60);
+
+    for (;;)
+    {
+        const bool finished = producersDone.load() == numProducers;
+
+        queue.beginBlock (blockSize);
+
+        for (int start = 0; start < blockSize; start = queue.getNextEventSample())
+        {
+            applied += queue.applyUntil (start, values);
+
+            for (int producer = 0; producer < numProducers; ++producer)
+            {
+                outOfOrder += values[producer] < lastSeen[producer] ? 1 : 0;
+                lastSeen[producer] = values[producer];
+            }
+        }
+
+        // Everything added before the producers finished has been scheduled by now
+        if (finished || std::chrono::steady_clock::now() > deadline)
+            break;
+    }
+
+    for (auto& producer : producers)
+        producer.join();
+
+    int wrongFinalValues = 0;
+
+    for (int producer = 0; producer < numProducers; ++producer)
+        wrongFinalValues += values[producer] != static_cast<float> (producer) * producerStride + static_cast<float> (changesPerProducer) ? 1 : 0;
+
+    const juce::int64 expected = static_cast<juce::int64> (numProducers) * changesPerProducer;
+    const bool passed = applied == expected && outOfOrder == 0 && wrongFinalValues == 0;
+
+    std::printf ("{\"check\": \"parameterEventQueue\", \"producers\": %d, \"added\": %lld, \"applied\": %lld, "
+                 "\"outOfOrder\": %d, \"wrongFinalValues\": %d, \"passed\": %s}\n",
+                 numProducers, static_cast<long long> (expected), static_cast<long long> (applied),
+                 outOfOrder, wrongFinalValues, passed ? "true" : "false");
+
+    return passed;
+}
+
+bool checkDelayMemorySwaps()
+{
+    using Format = ghostline::DelayStorageFormat;
+
+    const ghostline::DelayMemoryLayout layouts[] { { 2, 48000, Format::float32 },
+                                                   { 1, 96000, Format::int16 },
+                                                   { 4, 40000, Format::float64 },
+                                                   { 2, 96000, Format::blockFloat16 },
+                                                   { 1, 48000, Format::float32 },
+                                                   { 4, 96000, Format::int16 } };
+
+    ghostline::DelayMemoryManager manager;
+    manager.prepare (layouts[0]);
+
+    std::atomic<bool> stop { false };
+    std::atomic<int> swaps { 0 };
+    juce::int64 samplesChecked = 0;
+    int damagedSamples = 0;
+    float largestError = 0.0f;
+
+    // Writes a block at a time, at about ten times real time, and checks the
+    // history each time it takes over a new memory. A channel a layout adds
+    // only has history from the swap that added it
+    std::thread audio ([&]
+    {
+        std::vector<float> input (blockSize * 8);
+        juce::int64 channelStart[4] = {};
+
+        while (! stop.load())
+        {
+            const auto previous = manager.getActive()->getLayout();
+
+            if (manager.adoptPending())
+            {
+                // The newest half of the shorter history, well clear of the reserve the worker keeps
+                auto* memory = manager.getActive();
+                const auto written = memory->getSamplesWritten();
+                const auto first = juce::jmax (juce::int64 (0), written - juce::jmin (previous.size, memory->getLayout().size) / 2);
+                const int numChannels = juce::jmin (previous.numChannels, memory->getLayout().numChannels);
+
+                for (int channel = 0; channel < numChannels; ++channel)
+                    memory->visitChannel (channel, [&] (const auto& history)
+                    {
+                        for (auto n = juce::jmax (first, channelStart[channel]); n < written; ++n)
+                        {
+                            const auto error = std::abs (static_cast<float> (history.read (memory->getPosition (n))) - getTestSample (n, channel));
+                            largestError = juce::jmax (largestError, error);
+                            damagedSamples += error > swapTolerance ? 1 : 0;
+                        }
+                    });
+
+                for (int channel = 0; channel < numChannels; ++channel)
+                    samplesChecked += written - juce::jmax (first, channelStart[channel]);
+
+                for (int channel = numChannels; channel < memory->getLayout().numChannels; ++channel)
+                    channelStart[channel] = written;
+
+                swaps.fetch_add (1);
+            }
+
+            auto* memory = manager.getActive();
+            const auto written = memory->getSamplesWritten();
+            const int numSamples = static_cast<int> (input.size());
+
+            for (int channel = 0; channel < memory->getLayout().numChannels; ++channel)
+            {
+                for (int i = 0; i < numSamples; ++i)
+                    input[static_cast<size_t> (i)] = getTestSample (written + i, channel);
+
+                memory->visitChannel (channel, [&] (const auto& history)
+                {
+                    int writePosition = memory->getWritePosition();
+                    ghostline::recordDelayInput (history, input.data(), numSamples, writePosition);
+                });
+            }
+
+            memory->advance (numSamples);
+            std::this_thread::sleep_for (std::chrono::milliseconds (1));
+        }
+    });
+
+    // Swaps come after anything from no writing at all to several laps of the
+    // history; every few, a second request overtakes the first before the
+    // audio thread has taken it
+    int completed = 0;
+
+    for (int swap = 1; swap <= numSwaps; ++swap)
+    {
+        const auto& layout = layouts[swap % std::size (layouts)];
+        std::this_thread::sleep_for (std::chrono::milliseconds ((swap * 37) % 150));
+
+        if (swap % 5 == 0)
+            manager.requestLayout (layouts[(swap + 2) % std::size (layouts)]);
+
+        manager.requestLayout (layout);
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds (10);
+
+        while (manager.getActive()->getLayout() != layout && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for (std::chrono::milliseconds (1));
+
+        completed += manager.getActive()->getLayout() == layout ? 1 : 0;
+    }
+
+    stop.store (true);
+    audio.join();
+
+    const bool passed = completed == numSwaps && damagedSamples == 0;
+
+    std::printf ("{\"check\": \"delayMemorySwaps\", \"requested\": %d, \"completed\": %d, \"swaps\": %d, "
+                 "\"samplesChecked\": %lld, \"damagedSamples\": %d, \"maxError\": %.3g, \"passed\": %s}\n",
+                 numSwaps, completed, swaps.load(), static_cast<long long> (samplesChecked),
+                 damagedSamples, largestError, passed ? "true" : "false");
+
+    return passed;
+}
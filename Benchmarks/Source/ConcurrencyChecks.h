@@ -0,0 +1,26 @@
+/*
+  ==============================================================================
+
+    ConcurrencyChecks.h
+    Stress checks for the structures the audio thread shares with others.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/** Several threads add parameter changes as fast as they can while a
+    simulated audio thread drains them block by block. Prints one JSON
+    object and returns false if any change was lost, applied twice or
+    applied out of order.
+*/
+bool checkParameterEventQueue();
+
+/** A simulated audio thread writes a known signal into the delay memory
+    while the message thread keeps moving it between layouts: sizes,
+    channel counts and every storage format. Prints one JSON object and
+    returns false if any swap lost or changed the newest history.
+*/
+bool checkDelayMemorySwaps();
@@ -0,0 +1,106 @@
+/*
+  ==============================================================================
+
+    DelayStorageBenchmark.cpp
+
+  ==============================================================================
+*/
+
+#include "DelayStorageBenchmark.h"
+#include "../../Source/DSP/CompactDelayBuffer.h"
+
+#include <chrono>
+#include <cstdio>
+
+namespace
+{
+    constexpr double bufferSeconds = 60.0;
+    constexpr int blockSize = 512;
+
+    const char* getFormatName (ghostline::DelayStorageFormat format)
+    {
+        switch (format)
+        {
+            case ghostline::DelayStorageFormat::float32:       return "float32";
+            case ghostline::DelayStorageFormat::int16:         return "int16";
+            case ghostline::DelayStorageFormat::blockFloat16:  return "blockFloat16";
+            default:                                           break;
+        }
+
+        return "unknown";
+    }
+
+    // One channel, fixed read distance, feedback on so every write lands in the history.
+    // A short distance keeps the read head in cache; a long one makes every read a miss.
+    double measureNanosecondsPerSample (ghostline::DelayStorageFormat format, double sampleRate,
+                                        double delaySeconds, double secondsToProcess)
+    {
+        const int size = static_cast<int> (sampleRate * bufferSeconds);
+
+        ghostline::MirroredDelayBuffer floatBuffer;
+        ghostline::CompactDelayBuffer compactBuffer;
+
+        if (format == ghostline::DelayStorageFormat::float32)
+            floatBuffer.setSize (1, size);
+        else
+            compactBuffer.setSize (1, size, format);
+
+        std::vector<float> audio (blockSize);
+        std::vector<float> delaySamples (blockSize, static_cast<float> (delaySeconds * sampleRate) + 0.5f);
+        juce::Random random (1234);
+
+        int writePosition = 0;
+
+        ghostline::DelayKernelContext context;
+        context.channelData = audio.data();
+        context.delayBuffer = format == ghostline::DelayStorageFormat::float32 ? floatBuffer.getWritePointer (0) : nullptr;
+        context.delayBufferSize = size;
+        context.writePosition = &writePosition;
+        context.delaySamples = delaySamples.data();
+        context.numSamples = blockSize;
+        context.feedback = 0.5f;
+
+        const auto& kernel = ghostline::getDelayKernel();
+        const int numBlocks = juce::jmax (1, static_cast<int> (secondsToProcess * sampleRate / blockSize));
+        double elapsed = 0.0;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            for (auto& sample : audio)
+                sample = random.nextFloat() * 2.0f - 1.0f;
+
+            const auto start = std::chrono::steady_clock::now();
+
+            if (format == ghostline::DelayStorageFormat::float32)
+                kernel.process (context);
+            else
+                compactBuffer.process (0, context);
+
+            elapsed += std::chrono::duration<double, std::nano> (std::chrono::steady_clock::now() - start).count();
+        }
+
+        return elapsed / (static_cast<double> (numBlocks) * blockSize);
+    }
+}
+
+void runDelayStorageBenchmark (double sampleRate, double secondsToProcess)
+{
+    const int size = static_cast<int> (sampleRate * bufferSeconds);
+
+    for (auto format : { ghostline::DelayStorageFormat::float32,
+                         ghostline::DelayStorageFormat::int16,
+                         ghostline::DelayStorageFormat::blockFloat16 })
+    {
+        const auto bytes = ghostline::CompactDelayBuffer::getBytesPerChannel (size, format);
+
+        for (double delaySeconds : { 0.3, 30.0 })
+        {
+            const double nsPerSample = measureNanosecondsPerSample (format, sampleRate, delaySeconds, secondsToProcess);
+
+            std::printf ("{\"benchmark\": \"delayStorage\", \"format\": \"%s\", \"sampleRate\": %.0f, "
+                         "\"bufferSeconds\": %.0f, \"bytesPerChannel\": %zu, \"delaySeconds\": %.1f, "
+                         "\"nsPerSample\": %.3f}\n",
+                         getFormatName (format), sampleRate, bufferSeconds, bytes, delaySeconds, nsPerSample);
+        }
+    }
+}
@@ -0,0 +1,17 @@
+/*
+  ==============================================================================
+
+    DelayStorageBenchmark.h
+    Memory and throughput of each long-delay storage format.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/** Runs the 60 s echo loop in every storage format and prints one JSON object
+    per format and read distance to stdout.
+*/
+void runDelayStorageBenchmark (double sampleRate, double secondsToProcess);
@@ -0,0 +1,229 @@
+/*
+  ==============================================================================
+
+    InterpolationBenchmark.cpp
+
+  ==============================================================================
+*/
+
+#include "InterpolationBenchmark.h"
+#include "../../Source/DSP/DelayKernels.h"
+
+#include <chrono>
+#include <cstdio>
+
+namespace
+{
+    constexpr double bufferSeconds = 1.0;
+    constexpr int blockSize = 512;
+
+    const char* getModeName (ghostline::InterpolationMode mode)
+    {
+        switch (mode)
+        {
+            case ghostline::InterpolationMode::linear:    return "linear";
+            case ghostline::InterpolationMode::hermite:   return "hermite";
+            case ghostline::InterpolationMode::lagrange:  return "lagrange";
+            case ghostline::InterpolationMode::allpass:   return "allpass";
+            case ghostline::InterpolationMode::sinc:      return "sinc";
+            default:                                      break;
+        }
+
+        return "unknown";
+    }
+
+    constexpr ghostline::InterpolationMode allModes[] { ghostline::InterpolationMode::linear,
+                                                        ghostline::InterpolationMode::hermite,
+                                                        ghostline::InterpolationMode::lagrange,
+                                                        ghostline::InterpolationMode::allpass,
+                                                        ghostline::InterpolationMode::sinc };
+
+    //==============================================================================
+    // Runs the same input through the scalar loop and through process, each on
+    // its own history, and returns the largest difference between their outputs.
+    // Blocks vary in length and the history is short, so both wraps, chunk tails
+    // and the scalar fallbacks all come up. With settledDistance > 0 the read
+    // head stays there and process is ignored: the settled loop runs instead.
+    float measureLargestKernelError (ghostline::DelayKernelFunction process, ghostline::InterpolationMode mode,
+                                     float feedback, float settledDistance)
+    {
+        constexpr int size = 4096;
+        constexpr int numSamples = 8 * size;
+
+        ghostline::MirroredDelayBuffer referenceBuffer, testedBuffer;
+        referenceBuffer.setSize (1, size);
+        testedBuffer.setSize (1, size);
+
+        std::vector<float> reference (blockSize), tested (blockSize), delaySamples (blockSize);
+        juce::Random random (1234);
+
+        int referencePosition = 0, testedPosition = 0;
+        float referenceState = 0.0f, testedState = 0.0f;
+
+        auto makeContext = [&] (float* audio, ghostline::MirroredDelayBuffer& buffer, int& position, float& state)
+        {
+            ghostline::DelayKernelContext context;
+            context.channelData = audio;
+            context.delayBuffer = buffer.getWritePointer (0);
+            context.delayBufferSize = size;
+            context.writePosition = &position;
+            context.delaySamples = delaySamples.data();
+            context.interpolation = mode;
+            context.interpolatorState = &state;
+            context.feedback = feedback;
+            return context;
+        };
+
+        auto referenceContext = makeContext (reference.data(), referenceBuffer, referencePosition, referenceState);
+        auto testedContext = makeContext (tested.data(), testedBuffer, testedPosition, testedState);
+
+        // Keeps the loop within [-1, 1], where the tolerance applies
+        const float amplitude = 0.25f * (1.0f - std::abs (feedback));
+
+        // A slow sweep across most of the history, and a fast one close to the
+        // write head, where chunks have to fall back to single samples
+        const float margin = static_cast<float> (ghostline::interpolationMargin);
+        double phase = 0.0;
+        float largestError = 0.0f;
+
+        for (int done = 0; done < numSamples;)
+        {
+            const int length = juce::jmin (numSamples - done, 1 + random.nextInt (blockSize));
+
+            for (int i = 0; i < length; ++i, ++done)
+            {
+                const bool near = (done / size) % 2 != 0;
+                const float sweep = static_cast<float> (std::sin (phase));
+                phase += near ? 0.01 : 0.0007;
+
+                delaySamples[static_cast<size_t> (i)] = settledDistance > 0.0f ? settledDistance
+                                                      : near ? margin + 24.0f * (1.0f + sweep)
+                                                             : 0.5f * size + 0.45f * size * sweep;
+                reference[static_cast<size_t> (i)] = tested[static_cast<size_t> (i)] = amplitude * (random.nextFloat() * 2.0f - 1.0f);
+            }
+
+            referenceContext.numSamples = testedContext.numSamples = length;
+            ghostline::processDelayLoop (referenceContext);
+
+            if (settledDistance > 0.0f)
+                ghostline::processSettledDelayLoop (testedContext, settledDistance);
+            else
+                process (testedContext);
+
+            for (int i = 0; i < length; ++i)
+                largestError = juce::jmax (largestError, std::abs (reference[static_cast<size_t> (i)] - tested[static_cast<size_t> (i)]));
+        }
+
+        return largestError;
+    }
+
+    bool reportKernelCheck (const char* kernelName, ghostline::InterpolationMode mode, float feedback, float distance, float error)
+    {
+        const bool passed = error <= ghostline::delayKernelTolerance;
+
+        std::printf ("{\"check\": \"interpolation\", \"mode\": \"%s\", \"kernel\": \"%s\", \"feedback\": %.2f, "
+                     "\"distance\": %.0f, \"maxError\": %.3g, \"passed\": %s}\n",
+                     getModeName (mode), kernelName, feedback, distance, error, passed ? "true" : "false");
+
+        return passed;
+    }
+
+    // One channel of the float echo loop with the read head swept by a slow
+    // sine, as MODDEPTH does, so every read lands on a new fraction. With
+    // kernel null the head stays put and the settled loop runs instead.
+    double measureNanosecondsPerSample (const ghostline::DelayKernel* kernel, ghostline::InterpolationMode mode,
+                                        double sampleRate, double secondsToProcess)
+    {
+        const int size = static_cast<int> (sampleRate * bufferSeconds);
+
+        ghostline::MirroredDelayBuffer buffer;
+        buffer.setSize (1, size);
+
+        std::vector<float> audio (blockSize);
+        std::vector<float> delaySamples (blockSize);
+        juce::Random random (1234);
+
+        int writePosition = 0;
+        float interpolatorState = 0.0f;
+
+        ghostline::DelayKernelContext context;
+        context.channelData = audio.data();
+        context.delayBuffer = buffer.getWritePointer (0);
+        context.delayBufferSize = size;
+        context.writePosition = &writePosition;
+        context.delaySamples = delaySamples.data();
+        context.numSamples = blockSize;
+        context.interpolation = mode;
+        context.interpolatorState = &interpolatorState;
+        context.feedback = 0.5f;
+
+        const double centre = 0.3 * sampleRate;
+        const double depth = 0.01 * sampleRate;
+        const double phaseIncrement = juce::MathConstants<double>::twoPi * 0.5 / sampleRate;
+        double phase = 0.0;
+
+        const int numBlocks = juce::jmax (1, static_cast<int> (secondsToProcess * sampleRate / blockSize));
+        double elapsed = 0.0;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            for (int i = 0; i < blockSize; ++i)
+            {
+                audio[static_cast<size_t> (i)] = random.nextFloat() * 2.0f - 1.0f;
+                delaySamples[static_cast<size_t> (i)] = static_cast<float> (centre + depth * std::sin (phase));
+                phase += phaseIncrement;
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+
+            if (kernel != nullptr)
+                kernel->process (context);
+            else
+                ghostline::processSettledDelayLoop (context, static_cast<float> (centre));
+
+            elapsed += std::chrono::duration<double, std::nano> (std::chrono::steady_clock::now() - start).count();
+        }
+
+        return elapsed / (static_cast<double> (numBlocks) * blockSize);
+    }
+}
+
+void runInterpolationBenchmark (double sampleRate, double secondsToProcess)
+{
+    for (auto mode : allModes)
+    {
+        for (const auto* kernel : { &ghostline::getScalarDelayKernel(), &ghostline::getDelayKernel(),
+                                    static_cast<const ghostline::DelayKernel*> (nullptr) })
+        {
+            const double nsPerSample = measureNanosecondsPerSample (kernel, mode, sampleRate, secondsToProcess);
+
+            std::printf ("{\"benchmark\": \"interpolation\", \"mode\": \"%s\", \"kernel\": \"%s\", "
+                         "\"sampleRate\": %.0f, \"nsPerSample\": %.3f}\n",
+                         getModeName (mode), kernel != nullptr ? kernel->name : "Settled", sampleRate, nsPerSample);
+        }
+    }
+}
+
+bool checkInterpolationKernels()
+{
+    bool passed = true;
+
+    for (auto mode : allModes)
+    {
+        for (float feedback : { 0.0f, 0.5f, -0.9f })
+        {
+            // Every vector kernel the CPU has, on modulated read distances
+            for (const auto& kernel : ghostline::getAvailableDelayKernels())
+                if (kernel.process != ghostline::getScalarDelayKernel().process)
+                    passed &= reportKernelCheck (kernel.name, mode, feedback, 0.0f,
+                                                 measureLargestKernelError (kernel.process, mode, feedback, 0.0f));
+
+            // The settled loop only matches at whole-sample distances, either side of where it starts to pay
+            for (float distance : { 5.0f, 31.0f, 32.0f, 33.0f, 1000.0f, 4000.0f })
+                passed &= reportKernelCheck ("Settled", mode, feedback, distance,
+                                             measureLargestKernelError (nullptr, mode, feedback, distance));
+        }
+    }
+
+    return passed;
+}
@@ -0,0 +1,27 @@
+/*
+  ==============================================================================
+
+    InterpolationBenchmark.h
+    Cost of each fractional-delay interpolator, scalar and vectorised, and
+    a check that the vectorised ones agree with the scalar reference.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/** Runs the modulated echo loop with every interpolation mode, on the scalar
+    reference and on the fastest kernel for this CPU, and prints one JSON
+    object per mode and kernel to stdout.
+*/
+void runInterpolationBenchmark (double sampleRate, double secondsToProcess);
+
+/** Runs every kernel the CPU supports, and the settled loop at whole-sample
+    distances, against the scalar reference in every interpolation mode,
+    with the read head swept and feedback on. Prints one JSON object per
+    comparison and returns false if any drifted further than
+    ghostline::delayKernelTolerance.
+*/
+bool checkInterpolationKernels();
@@ -0,0 +1,67 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Ghostline benchmark runner. Results are printed as JSON lines.
+
+        GhostlineBenchmarks [--micro] [--processor] [--check] [--full] [--seconds N]
+
+    --micro runs the delay storage and interpolation kernels on their own,
+    --processor the whole plug-in, --check compares the vectorised kernels
+    against the scalar reference and stresses the structures the audio
+    thread shares; with none of them, all three run, and the exit code is 1
+    if a check failed. --full sweeps every processor configuration instead
+    of one axis at a time. --seconds sets how much audio each measurement
+    processes.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "ConcurrencyChecks.h"
+#include "DelayStorageBenchmark.h"
+#include "InterpolationBenchmark.h"
+#include "ProcessorBenchmark.h"
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // The processor owns timers and a worker thread, which need the message manager
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::StringArray args;
+
+    for (int i = 1; i < argc; ++i)
+        args.add (argv[i]);
+
+    const bool runMicro = args.contains ("--micro");
+    const bool runProcessor = args.contains ("--processor");
+    const bool runChecks = args.contains ("--check");
+    const bool runAll = ! runMicro && ! runProcessor && ! runChecks;
+    const int secondsIndex = args.indexOf ("--seconds");
+    const double seconds = secondsIndex >= 0 ? juce::jmax (0.1, args[secondsIndex + 1].getDoubleValue()) : 20.0;
+
+    bool passed = true;
+
+    if (runAll || runChecks)
+    {
+        passed &= checkInterpolationKernels();
+        passed &= checkParameterEventQueue();
+        passed &= checkDelayMemorySwaps();
+    }
+
+    if (runAll || runMicro)
+    {
+        for (double sampleRate : { 48000.0, 192000.0 })
+        {
+            runDelayStorageBenchmark (sampleRate, seconds);
+            runInterpolationBenchmark (sampleRate, seconds);
+        }
+    }
+
+    // Whole-plug-in runs cover many configurations; a few seconds each is plenty
+    if (runAll || runProcessor)
+        runProcessorBenchmark (args.contains ("--full"), secondsIndex >= 0 ? seconds : 2.0);
+
+    return passed ? 0 : 1;
+}
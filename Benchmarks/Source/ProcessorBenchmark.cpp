@@ -0,0 +1,192 @@
+/*
+  ==============================================================================
+
+    ProcessorBenchmark.cpp
+
+  ==============================================================================
+*/
+
+#include "ProcessorBenchmark.h"
+#include "../../Source/PluginProcessor.h"
+
+#include <chrono>
+#include <cstdio>
+
+namespace
+{
+    // Long enough for the delay smoothers, the governor and the caches to settle
+    constexpr double warmUpSeconds = 0.5;
+
+    struct Preset
+    {
+        const char* name;
+        std::vector<std::pair<const char*, float>> values;   // Parameter ID and plain value
+    };
+
+    // ADAPTIVE is off throughout: the governor would trade quality for time mid-run
+    const std::vector<Preset>& getPresets()
+    {
+        static const std::vector<Preset> presets
+        {
+            { "default",    {} },
+            { "modulated",  { { "MODDEPTH", 0.5f }, { "MODRATE", 0.3f } } },
+            { "sinc",       { { "MODDEPTH", 0.5f }, { "MODRATE", 0.3f }, { "INTERP", 4.0f } } },
+            { "saturated",  { { "SATURATION", 1.0f }, { "OVERSAMPLE", 2.0f }, { "FEEDBACK", 0.95f }, { "OVERDRIVE", 0.15f } } },
+            { "tape",       { { "TAPEMODE", 1.0f }, { "WOW", 0.5f }, { "FLUTTER", 0.5f }, { "HISS", 0.2f }, { "TAPEAGE", 0.5f } } },
+            { "loopFilter", { { "LOOPHP", 150.0f }, { "LOOPLP", 4000.0f }, { "LOOPTILT", 3.0f }, { "LOOPDC", 1.0f } } },
+            { "diffusion",  { { "DIFFUSION", 0.7f }, { "DIFFSIZE", 0.8f }, { "FEEDBACK", 0.6f } } },
+            { "pingPong",   { { "STEREOMODE", 2.0f }, { "FEEDBACK", 0.6f }, { "RIGHTOFFSET", 15.0f } } },
+            { "multiHead",  { { "HEADMODE", 1.0f }, { "HEADCOUNT", 8.0f }, { "MODDEPTH", 0.3f } } },
+            { "longInt16",  { { "LONGMODE", 1.0f }, { "LONGTIME", 30.0f }, { "STORAGE", 1.0f } } },
+            { "everything", { { "MODDEPTH", 0.5f }, { "INTERP", 4.0f }, { "SATURATION", 2.0f }, { "OVERSAMPLE", 1.0f },
+                              { "TAPEMODE", 1.0f }, { "WOW", 0.5f }, { "FLUTTER", 0.5f }, { "HEADMODE", 1.0f },
+                              { "LOOPHP", 150.0f }, { "LOOPLP", 4000.0f }, { "DIFFUSION", 0.5f },
+                              { "STEREOMODE", 1.0f } } }
+        };
+
+        return presets;
+    }
+
+    struct Layout
+    {
+        const char* name;
+        juce::AudioChannelSet channels;
+    };
+
+    std::vector<Layout> getLayouts()
+    {
+        return { { "mono",   juce::AudioChannelSet::mono() },
+                 { "stereo", juce::AudioChannelSet::stereo() },
+                 { "5.1",    juce::AudioChannelSet::create5point1() },
+                 { "7.1.4",  juce::AudioChannelSet::create7point1point4() } };
+    }
+
+    const std::vector<int> blockSizes { 1, 16, 64, 256, 512, 1024, 4096 };
+    const std::vector<double> sampleRates { 44100.0, 48000.0, 96000.0, 192000.0, 384000.0 };
+
+    struct Result
+    {
+        double nsPerSample = 0.0;          // Per channel, averaged over the run
+        double worstBlockMicroseconds = 0.0;
+    };
+
+    Result measure (const Preset& preset, const Layout& layout, double sampleRate, int blockSize, double secondsToProcess)
+    {
+        GhostlineAudioProcessor processor;
+
+        auto setParameter = [&processor] (const char* parameterID, float value)
+        {
+            if (auto* parameter = processor.apvts.getParameter (parameterID))
+                parameter->setValueNotifyingHost (parameter->convertTo0to1 (value));
+            else
+                jassertfalse;
+        };
+
+        setParameter ("ADAPTIVE", 0.0f);
+
+        for (const auto& [parameterID, value] : preset.values)
+            setParameter (parameterID, value);
+
+        juce::AudioProcessor::BusesLayout buses;
+        buses.inputBuses.add (layout.channels);
+        buses.outputBuses.add (layout.channels);
+
+        if (! processor.setBusesLayout (buses))
+            return {};
+
+        const int numChannels = layout.channels.size();
+        processor.setRateAndBufferSizeDetails (sampleRate, blockSize);
+        processor.prepareToPlay (sampleRate, blockSize);
+
+        juce::AudioBuffer<float> buffer (numChannels, blockSize);
+        juce::MidiBuffer midi;
+        juce::Random random (1234);
+
+        const auto numWarmUpBlocks = static_cast<int> (warmUpSeconds * sampleRate / blockSize) + 1;
+        const auto numBlocks = juce::jmax (1, static_cast<int> (secondsToProcess * sampleRate / blockSize));
+
+        Result result;
+        double elapsed = 0.0;
+
+        for (int block = 0; block < numWarmUpBlocks + numBlocks; ++block)
+        {
+            // Noise throughout, so the silence detector never lets the loop idle
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                auto* data = buffer.getWritePointer (channel);
+
+                for (int i = 0; i < blockSize; ++i)
+                    data[i] = (random.nextFloat() * 2.0f - 1.0f) * 0.25f;
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+            processor.processBlock (buffer, midi);
+            const double blockNanoseconds = std::chrono::duration<double, std::nano> (std::chrono::steady_clock::now() - start).count();
+
+            if (block < numWarmUpBlocks)
+                continue;
+
+            elapsed += blockNanoseconds;
+            result.worstBlockMicroseconds = juce::jmax (result.worstBlockMicroseconds, blockNanoseconds * 0.001);
+        }
+
+        processor.releaseResources();
+
+        result.nsPerSample = elapsed / (static_cast<double> (numBlocks) * blockSize * numChannels);
+        return result;
+    }
+
+    void report (const Preset& preset, const Layout& layout, double sampleRate, int blockSize, double secondsToProcess)
+    {
+        const auto result = measure (preset, layout, sampleRate, blockSize, secondsToProcess);
+
+        // Cycles at the nominal clock; turbo and power states make this an estimate
+        const double cyclesPerNanosecond = juce::SystemStats::getCpuSpeedInMegahertz() * 0.001;
+        const double blockMicroseconds = 1.0e6 * blockSize / sampleRate;
+
+        std::printf ("{\"benchmark\": \"processor\", \"preset\": \"%s\", \"layout\": \"%s\", \"channels\": %d, "
+                     "\"sampleRate\": %.0f, \"blockSize\": %d, \"nsPerSample\": %.3f, \"cyclesPerSample\": %.1f, "
+                     "\"worstBlockMicroseconds\": %.3f, \"worstBlockLoad\": %.4f}\n",
+                     preset.name, layout.name, layout.channels.size(), sampleRate, blockSize,
+                     result.nsPerSample, result.nsPerSample * cyclesPerNanosecond,
+                     result.worstBlockMicroseconds, result.worstBlockMicroseconds / blockMicroseconds);
+        std::fflush (stdout);
+    }
+}
+
+void runProcessorBenchmark (bool fullSweep, double secondsToProcess)
+{
+    const auto& presets = getPresets();
+    const auto layouts = getLayouts();
+
+    if (fullSweep)
+    {
+        for (const auto& preset : presets)
+            for (const auto& layout : layouts)
+                for (double sampleRate : sampleRates)
+                    for (int blockSize : blockSizes)
+                        report (preset, layout, sampleRate, blockSize, secondsToProcess);
+
+        return;
+    }
+
+    const auto& basePreset = presets.front();
+    const auto& baseLayout = layouts[1];
+    constexpr double baseSampleRate = 48000.0;
+    constexpr int baseBlockSize = 512;
+
+    for (int blockSize : blockSizes)
+        report (basePreset, baseLayout, baseSampleRate, blockSize, secondsToProcess);
+
+    for (double sampleRate : sampleRates)
+        if (sampleRate != baseSampleRate)
+            report (basePreset, baseLayout, sampleRate, baseBlockSize, secondsToProcess);
+
+    for (const auto& layout : layouts)
+        if (layout.name != baseLayout.name)
+            report (basePreset, layout, baseSampleRate, baseBlockSize, secondsToProcess);
+
+    for (const auto& preset : presets)
+        if (preset.name != basePreset.name)
+            report (preset, baseLayout, baseSampleRate, baseBlockSize, secondsToProcess);
+}
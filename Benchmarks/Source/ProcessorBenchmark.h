@@ -0,0 +1,22 @@
+/*
+  ==============================================================================
+
+    ProcessorBenchmark.h
+    Cost of the whole plug-in across block sizes, sample rates, bus layouts
+    and parameter presets.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/** Runs GhostlineAudioProcessor, without its editor, on noise and prints one
+    JSON object per configuration to stdout.
+
+    By default each axis is swept on its own around a 48 kHz, 512-sample,
+    stereo, default-preset baseline. fullSweep runs every combination
+    instead, which takes hours at the default length.
+*/
+void runProcessorBenchmark (bool fullSweep, double secondsToProcess);
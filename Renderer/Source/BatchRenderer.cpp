@@ -0,0 +1,290 @@
+/*
+  ==============================================================================
+
+    BatchRenderer.cpp
+
+  ==============================================================================
+*/
+
+#include "BatchRenderer.h"
+#include "../../Source/PluginProcessor.h"
+
+namespace
+{
+    // Decoded audio held ahead of the processor, and processed audio held
+    // behind it, per channel
+    constexpr int readAheadSamples = 1 << 16;
+    constexpr int writeBehindSamples = 1 << 16;
+
+    juce::String applySettings (GhostlineAudioProcessor& processor, const RenderSettings& settings)
+    {
+        if (settings.state.getSize() > 0)
+        {
+            // Either the host blob or the XML inside it, as saved by hand
+            auto xml = juce::AudioProcessor::getXmlFromBinary (settings.state.getData(), static_cast<int> (settings.state.getSize()));
+
+            if (xml == nullptr)
+                xml = juce::parseXML (settings.state.toString());
+
+            if (xml == nullptr || ! xml->hasTagName (processor.apvts.state.getType()))
+                return "The state is not a Ghostline state";
+
+            processor.apvts.replaceState (juce::ValueTree::fromXml (*xml));
+        }
+
+        for (const auto& parameterID : settings.overrides.getAllKeys())
+        {
+            auto* parameter = processor.apvts.getParameter (parameterID);
+
+            if (parameter == nullptr)
+                return "Unknown parameter " + parameterID;
+
+            const float value = settings.overrides[parameterID].getFloatValue();
+            parameter->setValueNotifyingHost (parameter->convertTo0to1 (value));
+        }
+
+        return {};
+    }
+
+    juce::AudioChannelSet getChannelSet (int numChannels)
+    {
+        const auto canonical = juce::AudioChannelSet::canonicalChannelSet (numChannels);
+        return canonical.isDisabled() ? juce::AudioChannelSet::discreteChannels (numChannels) : canonical;
+    }
+}
+
+//==============================================================================
+class BatchRenderer::Worker  : public juce::Thread
+{
+public:
+    Worker (BatchRenderer& o, int index)
+        : juce::Thread ("Ghostline render " + juce::String (index)),
+          owner (o),
+          ioThread ("Ghostline render I/O " + juce::String (index))
+    {
+    }
+
+    ~Worker() override
+    {
+        stopThread (-1);
+        ioThread.stopThread (2000);
+    }
+
+    void run() override
+    {
+        ioThread.startThread();
+
+        for (;;)
+        {
+            const int index = owner.nextInput++;
+
+            if (threadShouldExit() || index >= owner.inputs->size())
+                break;
+
+            owner.finish (index, render ((*owner.inputs)[index]));
+        }
+
+        ioThread.stopThread (2000);
+    }
+
+    GhostlineAudioProcessor processor;
+
+private:
+    RenderResult render (const juce::File& input)
+    {
+        RenderResult result;
+        result.input = input;
+        const auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+        result.error = renderInto (result);
+        result.wallSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) * 0.001;
+        return result;
+    }
+
+    juce::String renderInto (RenderResult& result)
+    {
+        std::unique_ptr<juce::AudioFormatReader> source (owner.formatManager.createReaderFor (result.input));
+
+        if (source == nullptr)
+            return "Can't read the file";
+
+        const auto numChannels = static_cast<int> (source->numChannels);
+        const double sampleRate = source->sampleRate;
+        const auto lengthInSamples = source->lengthInSamples;
+
+        if (numChannels <= 0 || sampleRate <= 0.0)
+            return "The file has no audio";
+
+        juce::AudioProcessor::BusesLayout buses;
+        buses.inputBuses.add (getChannelSet (numChannels));
+        buses.outputBuses.add (getChannelSet (numChannels));
+
+        if (! processor.setBusesLayout (buses))
+            return "Can't process " + juce::String (numChannels) + " channels";
+
+        auto [writer, temporary] = createWriter (*source, result);
+
+        if (writer == nullptr)
+            return "Can't write " + result.output.getFullPathName();
+
+        {
+            // Both take ownership; from here on the I/O thread decodes ahead and encodes behind
+            juce::BufferingAudioReader reader (source.release(), ioThread, readAheadSamples);
+            reader.setReadTimeout (-1);
+            juce::AudioFormatWriter::ThreadedWriter output (writer.release(), ioThread, writeBehindSamples);
+
+            const int blockSize = owner.settings.blockSize;
+            processor.setNonRealtime (true);
+            processor.setRateAndBufferSizeDetails (sampleRate, blockSize);
+            processor.prepareToPlay (sampleRate, blockSize);
+
+            juce::AudioBuffer<float> buffer (numChannels, blockSize);
+            juce::MidiBuffer midi;
+
+            auto process = [&] (int numSamples)
+            {
+                juce::AudioBuffer<float> block (buffer.getArrayOfWritePointers(), numChannels, numSamples);
+                processor.processBlock (block, midi);
+
+                // Full means the disk is behind; give the I/O thread a moment
+                while (! output.write (block.getArrayOfReadPointers(), numSamples))
+                    juce::Thread::sleep (1);
+
+                result.audioSeconds += numSamples / sampleRate;
+            };
+
+            for (juce::int64 position = 0; position < lengthInSamples && ! threadShouldExit();)
+            {
+                const auto numSamples = static_cast<int> (juce::jmin (static_cast<juce::int64> (blockSize), lengthInSamples - position));
+
+                if (! reader.read (buffer.getArrayOfWritePointers(), numChannels, position, numSamples))
+                    return "Reading failed";
+
+                process (numSamples);
+                position += numSamples;
+            }
+
+            // The settings are fixed, so the tail the processor reports now is the whole of it
+            const double tailSeconds = juce::jmin (processor.getTailLengthSeconds(), owner.settings.maxTailSeconds);
+            auto tailRemaining = static_cast<juce::int64> (std::ceil (tailSeconds * sampleRate));
+
+            while (tailRemaining > 0 && ! threadShouldExit())
+            {
+                const auto numSamples = static_cast<int> (juce::jmin (static_cast<juce::int64> (blockSize), tailRemaining));
+                buffer.clear();
+                process (numSamples);
+                tailRemaining -= numSamples;
+            }
+
+            processor.releaseResources();
+        }
+
+        if (threadShouldExit())
+            return "Cancelled";
+
+        if (! temporary->overwriteTargetFileWithTemporary())
+            return "Can't replace " + result.output.getFullPathName();
+
+        return {};
+    }
+
+    /** The input's own format where it can be written, else WAV, into a
+        temporary file beside the output so a failed render leaves nothing behind.
+    */
+    std::pair<std::unique_ptr<juce::AudioFormatWriter>, std::unique_ptr<juce::TemporaryFile>>
+        createWriter (const juce::AudioFormatReader& source, RenderResult& result)
+    {
+        const auto& settings = owner.settings;
+        const auto input = result.input;
+        const auto directory = settings.outputDirectory.isDirectory() ? settings.outputDirectory : input.getParentDirectory();
+
+        juce::WavAudioFormat wav;
+        auto* inputFormat = owner.formatManager.findFormatForFileExtension (input.getFileExtension());
+
+        for (auto* format : { inputFormat, static_cast<juce::AudioFormat*> (&wav) })
+        {
+            if (format == nullptr)
+                continue;
+
+            const auto extension = format == inputFormat ? input.getFileExtension() : juce::String (".wav");
+            result.output = directory.getChildFile (input.getFileNameWithoutExtension() + settings.suffix + extension);
+
+            const auto depths = format->getPossibleBitDepths();
+            const int wantedBits = source.usesFloatingPointData ? 32 : static_cast<int> (source.bitsPerSample);
+            const int bits = depths.contains (wantedBits) || depths.isEmpty() ? wantedBits : depths.getLast();
+
+            auto temporary = std::make_unique<juce::TemporaryFile> (result.output);
+            auto stream = std::make_unique<juce::FileOutputStream> (temporary->getFile());
+
+            if (stream->failedToOpen())
+                continue;
+
+            // On success the writer owns the stream
+            std::unique_ptr<juce::AudioFormatWriter> writer (format->createWriterFor (stream.get(), source.sampleRate, source.numChannels,
+                                                                                      bits, source.metadataValues, 0));
+
+            if (writer != nullptr)
+            {
+                stream.release();
+                return { std::move (writer), std::move (temporary) };
+            }
+        }
+
+        return {};
+    }
+
+    BatchRenderer& owner;
+    juce::TimeSliceThread ioThread;
+};
+
+//==============================================================================
+BatchRenderer::BatchRenderer (RenderSettings newSettings, int numWorkers)
+    : settings (std::move (newSettings))
+{
+    formatManager.registerBasicFormats();
+
+    // The processors are built here, on the message thread, and each is then only used by its worker
+    for (int i = 0; i < juce::jmax (1, numWorkers); ++i)
+    {
+        workers.push_back (std::make_unique<Worker> (*this, i));
+
+        if (settingsError.isEmpty())
+            settingsError = applySettings (workers.back()->processor, settings);
+    }
+}
+
+BatchRenderer::~BatchRenderer()
+{
+    workers.clear();
+}
+
+std::vector<RenderResult> BatchRenderer::render (const juce::Array<juce::File>& filesToRender,
+                                                 std::function<void (const RenderResult&)> onFinished)
+{
+    jassert (settingsError.isEmpty());
+
+    inputs = &filesToRender;
+    nextInput = 0;
+    results.assign (static_cast<size_t> (filesToRender.size()), {});
+    finished = std::move (onFinished);
+
+    for (auto& worker : workers)
+        worker->startThread();
+
+    for (auto& worker : workers)
+        worker->waitForThreadToExit (-1);
+
+    inputs = nullptr;
+    finished = nullptr;
+    return std::move (results);
+}
+
+void BatchRenderer::finish (int index, RenderResult result)
+{
+    const juce::ScopedLock sl (resultLock);
+
+    if (finished != nullptr)
+        finished (result);
+
+    results[static_cast<size_t> (index)] = std::move (result);
+}
@@ -0,0 +1,87 @@
+/*
+  ==============================================================================
+
+    BatchRenderer.h
+    Runs Ghostline over audio files offline, several files at a time.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/** What every file in a batch is rendered with. */
+struct RenderSettings
+{
+    /** A blob from getStateInformation(), or the XML it wraps. Empty keeps the defaults. */
+    juce::MemoryBlock state;
+
+    /** Plain parameter values applied on top of the state, by parameter ID. */
+    juce::StringPairArray overrides;
+
+    /** Where the renders go; an invalid directory puts each next to its input. */
+    juce::File outputDirectory;
+    juce::String suffix { "_ghostline" };
+
+    int blockSize = 4096;
+
+    /** The tail is cut here however long the settings say it rings. Hiss and
+        feedback at or above unity never decay on their own.
+    */
+    double maxTailSeconds = 60.0;
+};
+
+/** One file's outcome. */
+struct RenderResult
+{
+    juce::File input, output;
+    juce::String error;          // Empty on success
+    double audioSeconds = 0.0;   // Rendered, tail included
+    double wallSeconds = 0.0;
+};
+
+//==============================================================================
+/**
+    Renders each input, followed by its tail, to a file of the same format
+    (WAV where that format can't be written).
+
+    Files are shared out among numWorkers threads, each owning one processor,
+    which it prepares afresh for every file. Each worker also owns an I/O
+    thread that reads ahead of it and writes behind it, so decoding, the
+    echo and encoding overlap and only a few blocks of any file are in memory
+    at once, however long the file.
+
+    onFinished is called from the worker threads as each file completes.
+*/
+class BatchRenderer
+{
+public:
+    BatchRenderer (RenderSettings settings, int numWorkers);
+    ~BatchRenderer();
+
+    /** Blocks until every file has been rendered or has failed. */
+    std::vector<RenderResult> render (const juce::Array<juce::File>& inputs,
+                                      std::function<void (const RenderResult&)> onFinished = {});
+
+    /** Why the state or an override couldn't be applied; empty if they all were. */
+    juce::String getSettingsError() const      { return settingsError; }
+
+private:
+    class Worker;
+
+    void finish (int index, RenderResult result);
+
+    const RenderSettings settings;
+    juce::AudioFormatManager formatManager;
+    std::vector<std::unique_ptr<Worker>> workers;
+    juce::String settingsError;
+
+    // The batch in progress
+    const juce::Array<juce::File>* inputs = nullptr;
+    std::atomic<int> nextInput { 0 };
+    std::vector<RenderResult> results;
+    std::function<void (const RenderResult&)> finished;
+    juce::CriticalSection resultLock;
+};
@@ -0,0 +1,129 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Ghostline batch renderer.
+
+        GhostlineRender [options] <file or folder>...
+
+        --state <file>     Settings saved by the plug-in, as a state blob or its XML
+        --set ID=value     A parameter in its own units, e.g. --set DELAYTIME=0.25;
+                           repeatable, and applied after --state
+        --output <folder>  Where the renders go; by default next to each input
+        --suffix <text>    Added to each output name; "_ghostline" by default
+        --jobs <n>         Files rendered at once; one per CPU by default
+        --block <n>        Samples per processBlock call; 4096 by default
+        --max-tail <s>     Longest tail rendered after each file; 60 s by default
+
+    Folders are searched, not recursively, for every format the renderer reads.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "BatchRenderer.h"
+
+namespace
+{
+    int fail (const juce::String& message)
+    {
+        std::fprintf (stderr, "%s\n", message.toRawUTF8());
+        return 1;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // The processors own timers and worker threads, which need the message manager
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    RenderSettings settings;
+    int numJobs = juce::SystemStats::getNumCpus();
+    juce::Array<juce::File> inputs;
+
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const juce::String arg (argv[i]);
+        const bool hasValue = i + 1 < argc;
+
+        auto value = [&] { return juce::String (argv[++i]); };
+        auto file = [&] { return juce::File::getCurrentWorkingDirectory().getChildFile (value()); };
+
+        if (arg.startsWith ("--") && ! hasValue)
+            return fail (arg + " needs a value");
+
+        if (arg == "--state")
+        {
+            const auto stateFile = file();
+
+            if (! stateFile.loadFileAsData (settings.state))
+                return fail ("Can't read " + stateFile.getFullPathName());
+        }
+        else if (arg == "--set")
+        {
+            const auto assignment = value();
+
+            if (! assignment.containsChar ('='))
+                return fail ("--set expects ID=value, not " + assignment);
+
+            settings.overrides.set (assignment.upToFirstOccurrenceOf ("=", false, false),
+                                    assignment.fromFirstOccurrenceOf ("=", false, false));
+        }
+        else if (arg == "--output")
+        {
+            settings.outputDirectory = file();
+
+            if (! settings.outputDirectory.createDirectory())
+                return fail ("Can't create " + settings.outputDirectory.getFullPathName());
+        }
+        else if (arg == "--suffix")    settings.suffix = value();
+        else if (arg == "--jobs")      numJobs = juce::jmax (1, value().getIntValue());
+        else if (arg == "--block")     settings.blockSize = juce::jlimit (1, 1 << 16, value().getIntValue());
+        else if (arg == "--max-tail")  settings.maxTailSeconds = juce::jmax (0.0, value().getDoubleValue());
+        else if (arg.startsWith ("--"))
+            return fail ("Unknown option " + arg);
+        else
+        {
+            const auto input = juce::File::getCurrentWorkingDirectory().getChildFile (arg);
+
+            if (input.isDirectory())
+                inputs.addArray (input.findChildFiles (juce::File::findFiles, false, formats.getWildcardForAllFormats()));
+            else if (input.existsAsFile())
+                inputs.add (input);
+            else
+                return fail ("No such file " + input.getFullPathName());
+        }
+    }
+
+    if (inputs.isEmpty())
+        return fail ("Usage: GhostlineRender [--state file] [--set ID=value]... [--output folder] [--suffix text]\n"
+                     "                       [--jobs n] [--block n] [--max-tail seconds] <file or folder>...");
+
+    BatchRenderer renderer (std::move (settings), juce::jmin (numJobs, inputs.size()));
+
+    if (renderer.getSettingsError().isNotEmpty())
+        return fail (renderer.getSettingsError());
+
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+    const auto results = renderer.render (inputs, [] (const RenderResult& result)
+    {
+        if (result.error.isEmpty())
+            std::printf ("%s -> %s (%.1f s of audio in %.2f s)\n", result.input.getFullPathName().toRawUTF8(),
+                         result.output.getFullPathName().toRawUTF8(), result.audioSeconds, result.wallSeconds);
+        else
+            std::fprintf (stderr, "%s: %s\n", result.input.getFullPathName().toRawUTF8(), result.error.toRawUTF8());
+    });
+
+    const double seconds = (juce::Time::getMillisecondCounterHiRes() - startTime) * 0.001;
+    const auto numFailed = std::count_if (results.begin(), results.end(), [] (const auto& r) { return r.error.isNotEmpty(); });
+
+    std::printf ("%d files, %d failed, %.2f s, %.2f files/s\n", inputs.size(), static_cast<int> (numFailed),
+                 seconds, inputs.size() / juce::jmax (seconds, 1.0e-3));
+
+    return numFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,169 @@
+/*
+  ==============================================================================
+
+    BlockProfiler.cpp
+
+  ==============================================================================
+*/
+
+#include "BlockProfiler.h"
+
+namespace ghostline
+{
+
+//==============================================================================
+void BlockProfiler::prepare (double sampleRate) noexcept
+{
+    currentSampleRate.store (sampleRate, std::memory_order_relaxed);
+    clear();
+}
+
+void BlockProfiler::clear() noexcept
+{
+    for (auto& count : histogram)
+        count.store (0, std::memory_order_relaxed);
+
+    numBlocks.store (0, std::memory_order_relaxed);
+    numOverruns.store (0, std::memory_order_relaxed);
+    busyTicks.store (0, std::memory_order_relaxed);
+    budgetTicks.store (0, std::memory_order_relaxed);
+    worstTicks.store (0, std::memory_order_relaxed);
+    lastLoad.store (0.0f, std::memory_order_relaxed);
+    peakLoad.store (0.0f, std::memory_order_relaxed);
+}
+
+void BlockProfiler::beginBlock() noexcept
+{
+    if (resetRequested.exchange (false, std::memory_order_relaxed))
+        clear();
+
+    blockStartTicks = juce::Time::getHighResolutionTicks();
+}
+
+double BlockProfiler::endBlock (int numSamples) noexcept
+{
+    const auto elapsedTicks = juce::Time::getHighResolutionTicks() - blockStartTicks;
+    const auto ticksPerSecond = static_cast<double> (juce::Time::getHighResolutionTicksPerSecond());
+    const double elapsed = static_cast<double> (elapsedTicks) / ticksPerSecond;
+
+    if (numSamples <= 0)
+        return elapsed;
+
+    const double budget = numSamples / currentSampleRate.load (std::memory_order_relaxed);
+    const auto blockLoad = static_cast<float> (elapsed / budget);
+    const int bucket = juce::jmin (numBuckets - 1, static_cast<int> (blockLoad / bucketWidth));
+
+    increment (histogram[static_cast<size_t> (bucket)]);
+    increment (numBlocks);
+    increment (busyTicks, static_cast<juce::uint64> (elapsedTicks));
+    increment (budgetTicks, static_cast<juce::uint64> (budget * ticksPerSecond));
+
+    if (blockLoad > 1.0f)
+        increment (numOverruns);
+
+    lastLoad.store (blockLoad, std::memory_order_relaxed);
+
+    if (blockLoad > peakLoad.load (std::memory_order_relaxed))
+        peakLoad.store (blockLoad, std::memory_order_relaxed);
+
+    if (elapsedTicks > worstTicks.load (std::memory_order_relaxed))
+        worstTicks.store (elapsedTicks, std::memory_order_relaxed);
+
+    // Fill the slot, then publish it
+    const auto index = blocksTraced.load (std::memory_order_relaxed);
+    auto& event = trace[static_cast<size_t> (index % traceCapacity)];
+    event.startTicks.store (blockStartTicks, std::memory_order_relaxed);
+    event.durationTicks.store (elapsedTicks, std::memory_order_relaxed);
+    event.numSamples.store (numSamples, std::memory_order_relaxed);
+    blocksTraced.store (index + 1, std::memory_order_release);
+
+    return elapsed;
+}
+
+//==============================================================================
+BlockProfiler::Statistics BlockProfiler::getStatistics() const noexcept
+{
+    Statistics statistics;
+
+    for (size_t i = 0; i < histogram.size(); ++i)
+        statistics.histogram[i] = histogram[i].load (std::memory_order_relaxed);
+
+    statistics.numBlocks = numBlocks.load (std::memory_order_relaxed);
+    statistics.numOverruns = numOverruns.load (std::memory_order_relaxed);
+    statistics.lastLoad = lastLoad.load (std::memory_order_relaxed);
+    statistics.peakLoad = peakLoad.load (std::memory_order_relaxed);
+
+    if (const auto budget = budgetTicks.load (std::memory_order_relaxed); budget > 0)
+        statistics.meanLoad = static_cast<float> (static_cast<double> (busyTicks.load (std::memory_order_relaxed)) / static_cast<double> (budget));
+
+    statistics.worstMicroseconds = 1.0e6 * static_cast<double> (worstTicks.load (std::memory_order_relaxed))
+                                     / static_cast<double> (juce::Time::getHighResolutionTicksPerSecond());
+    return statistics;
+}
+
+bool BlockProfiler::writeTrace (const juce::File& file) const
+{
+    struct Block
+    {
+        juce::int64 startTicks, durationTicks;
+        int numSamples;
+    };
+
+    // Copy first, then drop whatever the audio thread may have been rewriting meanwhile
+    std::vector<Block> blocks;
+    blocks.reserve (traceCapacity);
+
+    const auto end = blocksTraced.load (std::memory_order_acquire);
+    auto first = end > traceCapacity ? end - traceCapacity : 0;
+
+    for (auto i = first; i < end; ++i)
+    {
+        const auto& event = trace[static_cast<size_t> (i % traceCapacity)];
+        blocks.push_back ({ event.startTicks.load (std::memory_order_relaxed),
+                            event.durationTicks.load (std::memory_order_relaxed),
+                            event.numSamples.load (std::memory_order_relaxed) });
+    }
+
+    // The slot of block 'after' may have been half written before 'after' was published
+    std::atomic_thread_fence (std::memory_order_acquire);
+    const auto after = blocksTraced.load (std::memory_order_relaxed);
+
+    if (after + 1 > first + traceCapacity)
+    {
+        const auto overwritten = juce::jmin (end - first, after + 1 - traceCapacity - first);
+        blocks.erase (blocks.begin(), blocks.begin() + static_cast<std::ptrdiff_t> (overwritten));
+        first += overwritten;
+    }
+
+    const double sampleRate = currentSampleRate.load (std::memory_order_relaxed);
+    const double microsecondsPerTick = 1.0e6 / static_cast<double> (juce::Time::getHighResolutionTicksPerSecond());
+    const auto origin = blocks.empty() ? juce::int64 (0) : blocks.front().startTicks;
+
+    juce::FileOutputStream out (file);
+
+    if (! out.openedOk() || ! out.setPosition (0) || ! out.truncate().wasOk())
+        return false;
+
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+
+    for (size_t i = 0; i < blocks.size(); ++i)
+    {
+        const auto& block = blocks[i];
+        const double budget = 1.0e6 * block.numSamples / sampleRate;
+        const double duration = static_cast<double> (block.durationTicks) * microsecondsPerTick;
+
+        out << "{\"name\": \"processBlock\", \"cat\": \"audio\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1, "
+            << "\"ts\": " << juce::String (static_cast<double> (block.startTicks - origin) * microsecondsPerTick, 3)
+            << ", \"dur\": " << juce::String (duration, 3)
+            << ", \"args\": {\"block\": " << juce::String (first + i)
+            << ", \"samples\": " << block.numSamples
+            << ", \"load\": " << juce::String (duration / budget, 4) << "}}"
+            << (i + 1 < blocks.size() ? ",\n" : "\n");
+    }
+
+    out << "]}\n";
+    out.flush();
+    return out.getStatus().wasOk();
+}
+
+} // namespace ghostline
@@ -0,0 +1,97 @@
+/*
+  ==============================================================================
+
+    BlockProfiler.h
+    Times every processBlock call against its real-time budget, for the CPU
+    meter and for trace captures, without locking or allocating on the
+    audio thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace ghostline
+{
+
+//==============================================================================
+/**
+    The load of a block is its time / its duration as audio, so 1 means the
+    block took exactly as long as it lasts and anything above is an overrun:
+    a dropout unless the host has slack elsewhere.
+
+    The audio thread is the only writer. Every count is an atomic it updates
+    with plain relaxed stores, so readers on other threads see each one whole,
+    if not always all of them from the same block. The last traceCapacity
+    blocks are kept as well, for writeTrace().
+*/
+class BlockProfiler
+{
+public:
+    /** Histogram buckets, bucketWidth of the budget each; the last also takes everything above. */
+    static constexpr int numBuckets = 40;
+    static constexpr float bucketWidth = 0.05f;
+
+    static constexpr int traceCapacity = 8192;
+
+    void prepare (double sampleRate) noexcept;
+
+    /** Brackets the work being measured. Audio thread. endBlock() returns
+        the block's time in seconds.
+    */
+    void beginBlock() noexcept;
+    double endBlock (int numSamples) noexcept;
+
+    /** Clears the counts at the start of the next block. Any thread. */
+    void requestReset() noexcept                           { resetRequested.store (true, std::memory_order_relaxed); }
+
+    struct Statistics
+    {
+        std::array<juce::uint32, numBuckets> histogram {};
+        juce::uint64 numBlocks = 0, numOverruns = 0;
+        float lastLoad = 0.0f, peakLoad = 0.0f, meanLoad = 0.0f;
+        double worstMicroseconds = 0.0;
+    };
+
+    /** Any thread. */
+    Statistics getStatistics() const noexcept;
+
+    /** Writes the blocks still held as Chrome trace JSON, which chrome://tracing
+        and Perfetto open: one slice per block, with its size and load. Any
+        thread but the audio thread; blocks overwritten while copying are left out.
+    */
+    bool writeTrace (const juce::File& file) const;
+
+private:
+    void clear() noexcept;
+
+    template <typename Type>
+    static void increment (std::atomic<Type>& value, Type amount = 1) noexcept
+    {
+        value.store (value.load (std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    std::atomic<double> currentSampleRate { 44100.0 };
+    juce::int64 blockStartTicks = 0;
+    std::atomic<bool> resetRequested { false };
+
+    std::array<std::atomic<juce::uint32>, numBuckets> histogram {};
+    std::atomic<juce::uint64> numBlocks { 0 }, numOverruns { 0 };
+    std::atomic<juce::uint64> busyTicks { 0 }, budgetTicks { 0 };
+    std::atomic<juce::int64> worstTicks { 0 };
+    std::atomic<float> lastLoad { 0.0f }, peakLoad { 0.0f };
+
+    // Slot i % traceCapacity holds block i once blocksTraced has passed i
+    struct TraceEvent
+    {
+        std::atomic<juce::int64> startTicks { 0 }, durationTicks { 0 };
+        std::atomic<int> numSamples { 0 };
+    };
+
+    std::array<TraceEvent, traceCapacity> trace;
+    std::atomic<juce::uint64> blocksTraced { 0 };
+};
+
+} // namespace ghostline
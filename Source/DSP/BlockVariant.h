@@ -0,0 +1,74 @@
+/*
+  ==============================================================================
+
+    BlockVariant.h
+    Compile-time specialisations of the per-channel echo loop, one picked
+    per block from the state the parameters are in.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "MixStage.h"
+
+namespace ghostline
+{
+
+//==============================================================================
+/** What one channel's loop has to do this block. */
+struct BlockVariant
+{
+    bool modulated = true;          // The LFO moves the read distance
+    bool ramping = true;            // The delay time is still gliding to its target
+    MixShape mix = MixShape::mixed;
+};
+
+/** A BlockVariant as constants, so the loop written against it compiles
+    without the work its block doesn't need: no LFO rendering when it isn't
+    modulated, no per-sample smoothing when the delay time has settled, no
+    copy of the dry input for wet-only blocks and no echo at all when
+    nothing would hear it.
+*/
+template <bool isModulated, bool isRamping, MixShape mixShape>
+struct BlockTraits
+{
+    static constexpr bool modulated = isModulated;
+    static constexpr bool ramping = isRamping;
+    static constexpr MixShape mix = mixShape;
+};
+
+/** Calls visitor with the BlockTraits matching variant, once per block, in
+    the same way visitInterpolator() resolves the interpolation mode.
+*/
+template <typename Visitor>
+void visitBlockVariant (const BlockVariant& variant, Visitor&& visitor)
+{
+    auto withMix = [&] (auto modulated, auto ramping)
+    {
+        constexpr bool isModulated = decltype (modulated)::value;
+        constexpr bool isRamping = decltype (ramping)::value;
+
+        switch (variant.mix)
+        {
+            case MixShape::wetOnly:    visitor (BlockTraits<isModulated, isRamping, MixShape::wetOnly>{});  break;
+            case MixShape::dryOnly:    visitor (BlockTraits<isModulated, isRamping, MixShape::dryOnly>{});  break;
+            case MixShape::mixed:
+            default:                   visitor (BlockTraits<isModulated, isRamping, MixShape::mixed>{});    break;
+        }
+    };
+
+    if (variant.modulated)
+    {
+        if (variant.ramping)    withMix (std::true_type{}, std::true_type{});
+        else                    withMix (std::true_type{}, std::false_type{});
+    }
+    else
+    {
+        if (variant.ramping)    withMix (std::false_type{}, std::true_type{});
+        else                    withMix (std::false_type{}, std::false_type{});
+    }
+}
+
+} // namespace ghostline
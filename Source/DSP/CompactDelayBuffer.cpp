@@ -0,0 +1,202 @@
+/*
+  ==============================================================================
+
+    CompactDelayBuffer.cpp
+
+  ==============================================================================
+*/
+
+#include "CompactDelayBuffer.h"
+
+namespace ghostline
+{
+
+//==============================================================================
+void CompactDelayBuffer::BlockFloatCodec::write (int index, float value) const noexcept
+{
+    const int block = index >> blockShift;
+
+    if ((index & blockMask) == 0)
+        renormalise (block);
+
+    // Only a sample too loud for the block's current range needs frexp
+    if (std::abs (value) >= scales[block] * 32768.0f)
+    {
+        int exponent = 0;
+        std::frexp (value, &exponent);
+        exponent = juce::jmin (maxExponent, exponent);
+
+        if (exponent > exponents[block])
+            rescale (block, exponent);
+    }
+
+    data[index] = quantise (value / scales[block]);
+}
+
+// Entering a block: the old samples still in it may be read by a long
+// delay, so pick the smallest exponent that holds them and shift them up.
+// Slot 0 is about to be overwritten and doesn't count.
+void CompactDelayBuffer::BlockFloatCodec::renormalise (int block) const noexcept
+{
+    const int start = block << blockShift;
+    const int end = juce::jmin (start + samplesPerBlock, size);
+
+    data[start] = 0;
+
+    int peak = 0;
+    for (int i = start + 1; i < end; ++i)
+        peak = juce::jmax (peak, std::abs (static_cast<int> (data[i])));
+
+    int shift = 0;
+    if (peak == 0)
+        shift = exponents[block] - minExponent;
+    else
+        while (exponents[block] - shift > minExponent && (peak << (shift + 1)) <= 32767)
+            ++shift;
+
+    if (shift > 0)
+    {
+        for (int i = start + 1; i < end; ++i)
+            data[i] = static_cast<juce::int16> (data[i] * (1 << juce::jmin (shift, 16)));
+
+        setExponent (block, exponents[block] - shift);
+    }
+}
+
+void CompactDelayBuffer::BlockFloatCodec::rescale (int block, int newExponent) const noexcept
+{
+    const int start = block << blockShift;
+    const int end = juce::jmin (start + samplesPerBlock, size);
+    const float factor = std::ldexp (1.0f, exponents[block] - newExponent);
+
+    for (int i = start; i < end; ++i)
+        data[i] = quantise (static_cast<float> (data[i]) * factor);
+
+    setExponent (block, newExponent);
+}
+
+void CompactDelayBuffer::BlockFloatCodec::setExponent (int block, int exponent) const noexcept
+{
+    exponents[block] = static_cast<juce::int8> (exponent);
+    scales[block] = std::ldexp (1.0f, exponent - 15);
+}
+
+//==============================================================================
+void CompactDelayBuffer::setSize (int newNumChannels, int newSize, DelayStorageFormat newFormat)
+{
+    jassert (newNumChannels > 0 && newSize > 1);
+    jassert (newFormat == DelayStorageFormat::int16 || newFormat == DelayStorageFormat::blockFloat16);
+
+    numChannels = newNumChannels;
+    size = newSize;
+    format = newFormat;
+    numBlocks = (size + samplesPerBlock - 1) / samplesPerBlock;
+
+    mantissas.malloc (static_cast<size_t> (numChannels * size));
+
+    if (format == DelayStorageFormat::blockFloat16)
+    {
+        blockScales.malloc (static_cast<size_t> (numChannels * numBlocks));
+        blockExponents.malloc (static_cast<size_t> (numChannels * numBlocks));
+    }
+    else
+    {
+        blockScales.free();
+        blockExponents.free();
+    }
+
+    clear();
+}
+
+void CompactDelayBuffer::release()
+{
+    mantissas.free();
+    blockScales.free();
+    blockExponents.free();
+    numChannels = 0;
+    size = 0;
+    numBlocks = 0;
+}
+
+void CompactDelayBuffer::clear() noexcept
+{
+    if (mantissas != nullptr)
+        std::fill (mantissas.get(), mantissas.get() + numChannels * size, static_cast<juce::int16> (0));
+
+    if (blockScales != nullptr)
+    {
+        std::fill (blockScales.get(), blockScales.get() + numChannels * numBlocks,
+                   std::ldexp (1.0f, BlockFloatCodec::minExponent - 15));
+        std::fill (blockExponents.get(), blockExponents.get() + numChannels * numBlocks,
+                   static_cast<juce::int8> (BlockFloatCodec::minExponent));
+    }
+}
+
+size_t CompactDelayBuffer::getMemoryUsageBytes() const noexcept
+{
+    return static_cast<size_t> (numChannels) * getBytesPerChannel (size, format);
+}
+
+size_t CompactDelayBuffer::getBytesPerChannel (int numSamples, DelayStorageFormat storageFormat) noexcept
+{
+    const auto samples = static_cast<size_t> (numSamples);
+    const auto blocks = static_cast<size_t> ((numSamples + samplesPerBlock - 1) / samplesPerBlock);
+
+    switch (storageFormat)
+    {
+        case DelayStorageFormat::float32:       return samples * sizeof (float);
+        case DelayStorageFormat::float64:       return samples * sizeof (double);
+        case DelayStorageFormat::int16:         return samples * sizeof (juce::int16);
+        case DelayStorageFormat::blockFloat16:  return samples * sizeof (juce::int16) + blocks * (sizeof (float) + sizeof (juce::int8));
+        default:                                break;
+    }
+
+    jassertfalse;
+    return 0;
+}
+
+//==============================================================================
+template <typename SampleType>
+void CompactDelayBuffer::process (int channel, const BasicDelayKernelContext<SampleType>& context) noexcept
+{
+    jassert (juce::isPositiveAndBelow (channel, numChannels));
+    jassert (context.delayBufferSize == size);
+
+    visitChannel (channel, [&context] (auto codec)
+    {
+        visitInterpolator (context.interpolation, [&] (auto interpolator)
+        {
+            processWith<decltype (interpolator)> (codec, context);
+        });
+    });
+}
+
+template <typename Interpolator, typename Codec, typename SampleType>
+void CompactDelayBuffer::processWith (const Codec& codec, const BasicDelayKernelContext<SampleType>& c) noexcept
+{
+    const int size = codec.size;
+    SampleType state = c.interpolatorState != nullptr ? *c.interpolatorState : SampleType (0);
+    int writePos = *c.writePosition;
+
+    for (int sample = 0; sample < c.numSamples; ++sample)
+    {
+        const SampleType delayedSample = readInterpolated<Interpolator> (codec, static_cast<SampleType> (writePos) - c.delaySamples[sample], state);
+
+        const SampleType input = c.channelData[sample];
+        c.channelData[sample] = delayedSample;
+
+        codec.write (writePos, static_cast<float> (input + (delayedSample * c.feedback)));
+        if (++writePos == size)
+            writePos = 0;
+    }
+
+    *c.writePosition = writePos;
+
+    if (c.interpolatorState != nullptr)
+        *c.interpolatorState = state;
+}
+
+template void CompactDelayBuffer::process (int, const BasicDelayKernelContext<float>&) noexcept;
+template void CompactDelayBuffer::process (int, const BasicDelayKernelContext<double>&) noexcept;
+
+} // namespace ghostline
@@ -0,0 +1,156 @@
+/*
+  ==============================================================================
+
+    CompactDelayBuffer.h
+    Reduced-precision echo history for the long-delay mode. 60 s at 192 kHz
+    is 46 MB of float per channel; these formats halve that.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DelayKernels.h"
+
+namespace ghostline
+{
+
+//==============================================================================
+enum class DelayStorageFormat
+{
+    float32 = 0,    // 4 bytes/sample, lossless. Uses MirroredDelayBuffer and the SIMD kernels.
+    int16,          // 2 bytes/sample, fixed point with 6 dB headroom above full scale
+    blockFloat16,   // 2.125 bytes/sample, 16-bit mantissas sharing one exponent per 32 samples
+    float64         // 8 bytes/sample, in place of float32 while the host processes in double precision
+};
+
+/**
+    Echo history stored as 16-bit integers or 16-bit block floating point.
+
+    Int16 has a fixed noise floor around -90 dBFS, so quiet tails lose
+    resolution as they decay. Block float rescales every 32 samples, so a
+    tail 60 dB down still keeps roughly 15 bits of its own. Decoding costs one
+    extra multiply per tap, and a rescale when a loud sample lands in a block
+    of quiet ones.
+
+    Storage is allocated in setSize() only; process() never allocates.
+*/
+class CompactDelayBuffer
+{
+public:
+    static constexpr int samplesPerBlock = 32;
+
+    CompactDelayBuffer() = default;
+
+    /** Reallocates and clears. Not realtime-safe. */
+    void setSize (int newNumChannels, int newSize, DelayStorageFormat newFormat);
+
+    /** Frees the storage while the float buffer is in use. */
+    void release();
+
+    void clear() noexcept;
+
+    DelayStorageFormat getFormat() const noexcept   { return format; }
+    int getNumChannels() const noexcept             { return numChannels; }
+    int getSize() const noexcept                    { return size; }
+
+    /** Bytes held by the sample storage, for all channels. */
+    size_t getMemoryUsageBytes() const noexcept;
+
+    /** Bytes one channel of size samples would need in the given format. */
+    static size_t getBytesPerChannel (int numSamples, DelayStorageFormat format) noexcept;
+
+    /** Runs the echo loop for one channel, decoding and encoding on the fly.
+        context.delayBuffer is ignored; the history is this object's channel.
+        Instantiated for float and double: the storage is 16-bit either way,
+        but the interpolation and feedback run in the context's precision.
+    */
+    template <typename SampleType>
+    void process (int channel, const BasicDelayKernelContext<SampleType>& context) noexcept;
+
+    //==============================================================================
+    /** A channel of 16-bit fixed point. Same read/write interface as
+        MirroredDelayBuffer::History, so multi-tap loops can run on any format.
+    */
+    struct Int16Codec
+    {
+        static constexpr float headroom = 2.0f;
+
+        juce::int16* data;
+        int size;
+
+        float read (int index) const noexcept
+        {
+            return static_cast<float> (data[index]) * (headroom / 32768.0f);
+        }
+
+        void write (int index, float value) const noexcept
+        {
+            data[index] = quantise (value * (32768.0f / headroom));
+        }
+    };
+
+    /** A channel of 16-bit block floating point. */
+    struct BlockFloatCodec
+    {
+        static constexpr int blockShift = 5;
+        static constexpr int blockMask = samplesPerBlock - 1;
+        static constexpr int minExponent = -24;    // Anything quieter than -144 dBFS rounds to silence
+        static constexpr int maxExponent = 24;
+
+        juce::int16* data;
+        int size;
+        float* scales;
+        juce::int8* exponents;
+
+        float read (int index) const noexcept
+        {
+            return static_cast<float> (data[index]) * scales[index >> blockShift];
+        }
+
+        void write (int index, float value) const noexcept;
+
+    private:
+        void renormalise (int block) const noexcept;
+        void rescale (int block, int newExponent) const noexcept;
+        void setExponent (int block, int exponent) const noexcept;
+    };
+
+    /** Calls callback with the codec for one channel, resolving the format once. */
+    template <typename Callback>
+    void visitChannel (int channel, Callback&& callback) noexcept
+    {
+        jassert (juce::isPositiveAndBelow (channel, numChannels));
+        juce::int16* channelMantissas = mantissas.get() + channel * size;
+
+        if (format == DelayStorageFormat::blockFloat16)
+            callback (BlockFloatCodec { channelMantissas, size,
+                                        blockScales.get() + channel * numBlocks,
+                                        blockExponents.get() + channel * numBlocks });
+        else
+            callback (Int16Codec { channelMantissas, size });
+    }
+
+private:
+    static juce::int16 quantise (float scaled) noexcept
+    {
+        return static_cast<juce::int16> (juce::jlimit (-32768, 32767, juce::roundToInt (scaled)));
+    }
+
+    template <typename Interpolator, typename Codec, typename SampleType>
+    static void processWith (const Codec& codec, const BasicDelayKernelContext<SampleType>& context) noexcept;
+
+    DelayStorageFormat format = DelayStorageFormat::int16;
+    int numChannels = 0;
+    int size = 0;
+    int numBlocks = 0;
+
+    juce::HeapBlock<juce::int16> mantissas;   // numChannels * size
+    juce::HeapBlock<float> blockScales;       // numChannels * numBlocks, block float only
+    juce::HeapBlock<juce::int8> blockExponents;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CompactDelayBuffer)
+};
+
+} // namespace ghostline
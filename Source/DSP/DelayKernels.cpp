@@ -0,0 +1,831 @@
+/*
+  ==============================================================================
+
+    DelayKernels.cpp
+
+  ==============================================================================
+*/
+
+#include "DelayKernels.h"
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+ #if JUCE_MSVC && ! JUCE_CLANG
+  #define GHOSTLINE_TARGET_SSE2
+  #define GHOSTLINE_TARGET_AVX2
+ #else
+  #define GHOSTLINE_TARGET_SSE2 __attribute__ ((target ("sse2")))
+  #define GHOSTLINE_TARGET_AVX2 __attribute__ ((target ("avx2")))
+ #endif
+#elif JUCE_ARM && (defined (__ARM_NEON) || defined (__ARM_NEON__) || defined (_M_ARM64))
+ #include <arm_neon.h>
+ #define GHOSTLINE_HAS_NEON 1
+#endif
+
+namespace ghostline
+{
+
+namespace
+{
+    //==============================================================================
+    // One sample of the echo loop. This is the reference every vector kernel is
+    // checked against, and the path they fall back to whenever a chunk can't be
+    // vectorised (write position about to wrap, or a read closer than one vector
+    // behind the write head). The history must be a BasicMirroredDelayBuffer
+    // channel of the same precision.
+    template <typename Interpolator, typename SampleType>
+    inline void processSample (const BasicDelayKernelContext<SampleType>& c, int sample, int& writePos, SampleType& state) noexcept
+    {
+        const int size = c.delayBufferSize;
+
+        // One conditional add is the only wrap: the guard zone covers the taps
+        // ahead, and a position that rounds up to exactly size reads the mirror of 0
+        SampleType readPos = static_cast<SampleType> (writePos) - c.delaySamples[sample];
+        if constexpr (Interpolator::readOffset != 0.0f)
+            readPos -= static_cast<SampleType> (Interpolator::readOffset);
+        readPos += readPos < 0 ? static_cast<SampleType> (size) : SampleType (0);
+
+        const int readPosInt = static_cast<int> (readPos);
+        const SampleType fraction = readPos - static_cast<SampleType> (readPosInt);
+
+        const SampleType delayedSample = Interpolator::interpolate (c.delayBuffer + readPosInt, fraction, state);
+
+        const SampleType input = c.channelData[sample];
+        c.channelData[sample] = delayedSample;
+
+        BasicMirroredDelayBuffer<SampleType>::write (c.delayBuffer, size, writePos, input + (delayedSample * c.feedback));
+        if (++writePos == size)
+            writePos = 0;
+    }
+
+    // Resolves the interpolation mode once, then runs kernel (interpolator, state)
+    // with the allpass state held in a local for the length of the block
+    template <typename SampleType, typename Kernel>
+    void dispatch (const BasicDelayKernelContext<SampleType>& c, Kernel&& kernel)
+    {
+        SampleType state = c.interpolatorState != nullptr ? *c.interpolatorState : SampleType (0);
+
+        visitInterpolator (c.interpolation, [&] (auto interpolator) { kernel (interpolator, state); });
+
+        if (c.interpolatorState != nullptr)
+            *c.interpolatorState = state;
+    }
+
+    // A vector chunk reads everything before it writes anything, so the newest
+    // tap of its last lane must be older than the chunk's first write
+    template <typename Interpolator>
+    constexpr float getMinimumVectorDistance (int width) noexcept
+    {
+        return static_cast<float> (width + Interpolator::numTaps - 1) - Interpolator::readOffset;
+    }
+
+    template <typename Interpolator, typename SampleType>
+    void processScalarWith (const BasicDelayKernelContext<SampleType>& c, SampleType& state)
+    {
+        int writePos = *c.writePosition;
+
+        for (int sample = 0; sample < c.numSamples; ++sample)
+            processSample<Interpolator> (c, sample, writePos, state);
+
+        *c.writePosition = writePos;
+    }
+
+    void processScalar (const DelayKernelContext& c)
+    {
+        processDelayLoop (c);
+    }
+
+   #if JUCE_INTEL
+    //==============================================================================
+    // SSE2 has no gather, so each tap is assembled from four scalar loads
+    GHOSTLINE_TARGET_SSE2 inline __m128 gatherSSE2 (const float* history, const int* index, int tap) noexcept
+    {
+        return _mm_setr_ps (history[index[0] + tap], history[index[1] + tap], history[index[2] + tap], history[index[3] + tap]);
+    }
+
+    GHOSTLINE_TARGET_SSE2 inline float sumSSE2 (__m128 v) noexcept
+    {
+        const __m128 pairs = _mm_add_ps (v, _mm_movehl_ps (v, v));
+        return _mm_cvtss_f32 (_mm_add_ss (pairs, _mm_shuffle_ps (pairs, pairs, 1)));
+    }
+
+    // Interpolation for four lanes at once. index is already offset by readOffset.
+    template <typename Interpolator> struct SSE2Reader;
+
+    template <>
+    struct SSE2Reader<LinearInterpolator>
+    {
+        GHOSTLINE_TARGET_SSE2 static __m128 read (const float* history, const int* index, __m128 t, float&) noexcept
+        {
+            const __m128 x0 = gatherSSE2 (history, index, 0);
+            const __m128 x1 = gatherSSE2 (history, index, 1);
+            return _mm_add_ps (_mm_mul_ps (x0, _mm_sub_ps (_mm_set1_ps (1.0f), t)), _mm_mul_ps (x1, t));
+        }
+    };
+
+    template <>
+    struct SSE2Reader<HermiteInterpolator>
+    {
+        GHOSTLINE_TARGET_SSE2 static __m128 read (const float* history, const int* index, __m128 t, float&) noexcept
+        {
+            const __m128 x0 = gatherSSE2 (history, index, 0);
+            const __m128 x1 = gatherSSE2 (history, index, 1);
+            const __m128 x2 = gatherSSE2 (history, index, 2);
+            const __m128 x3 = gatherSSE2 (history, index, 3);
+            const __m128 half = _mm_set1_ps (0.5f);
+
+            const __m128 c1 = _mm_mul_ps (half, _mm_sub_ps (x2, x0));
+            const __m128 c2 = _mm_sub_ps (_mm_add_ps (_mm_sub_ps (x0, _mm_mul_ps (_mm_set1_ps (2.5f), x1)), _mm_mul_ps (_mm_set1_ps (2.0f), x2)),
+                                          _mm_mul_ps (half, x3));
+            const __m128 c3 = _mm_add_ps (_mm_mul_ps (half, _mm_sub_ps (x3, x0)), _mm_mul_ps (_mm_set1_ps (1.5f), _mm_sub_ps (x1, x2)));
+
+            __m128 y = _mm_add_ps (_mm_mul_ps (c3, t), c2);
+            y = _mm_add_ps (_mm_mul_ps (y, t), c1);
+            return _mm_add_ps (_mm_mul_ps (y, t), x1);
+        }
+    };
+
+    template <>
+    struct SSE2Reader<LagrangeInterpolator>
+    {
+        GHOSTLINE_TARGET_SSE2 static __m128 read (const float* history, const int* index, __m128 t, float&) noexcept
+        {
+            const __m128 x0 = gatherSSE2 (history, index, 0);
+            const __m128 x1 = gatherSSE2 (history, index, 1);
+            const __m128 x2 = gatherSSE2 (history, index, 2);
+            const __m128 x3 = gatherSSE2 (history, index, 3);
+            const __m128 sign = _mm_set1_ps (-0.0f);
+            const __m128 sixth = _mm_set1_ps (1.0f / 6.0f);
+            const __m128 half = _mm_set1_ps (0.5f);
+
+            const __m128 tp1 = _mm_add_ps (t, _mm_set1_ps (1.0f));
+            const __m128 tm1 = _mm_sub_ps (t, _mm_set1_ps (1.0f));
+            const __m128 tm2 = _mm_sub_ps (t, _mm_set1_ps (2.0f));
+
+            const __m128 h0 = _mm_mul_ps (_mm_mul_ps (_mm_mul_ps (_mm_xor_ps (t, sign), tm1), tm2), sixth);
+            const __m128 h1 = _mm_mul_ps (_mm_mul_ps (_mm_mul_ps (tp1, tm1), tm2), half);
+            const __m128 h2 = _mm_mul_ps (_mm_mul_ps (_mm_mul_ps (_mm_xor_ps (tp1, sign), t), tm2), half);
+            const __m128 h3 = _mm_mul_ps (_mm_mul_ps (_mm_mul_ps (tp1, t), tm1), sixth);
+
+            return _mm_add_ps (_mm_add_ps (_mm_add_ps (_mm_mul_ps (h0, x0), _mm_mul_ps (h1, x1)), _mm_mul_ps (h2, x2)), _mm_mul_ps (h3, x3));
+        }
+    };
+
+    template <>
+    struct SSE2Reader<AllpassInterpolator>
+    {
+        GHOSTLINE_TARGET_SSE2 static __m128 read (const float* history, const int* index, __m128 t, float& state) noexcept
+        {
+            // Coefficients and taps in parallel; the recursion itself is inherently serial
+            const __m128 a = _mm_div_ps (_mm_sub_ps (t, _mm_set1_ps (0.5f)), _mm_sub_ps (_mm_set1_ps (2.5f), t));
+
+            alignas (16) float coefficients[4];
+            _mm_store_ps (coefficients, a);
+
+            alignas (16) float output[4];
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                state = coefficients[lane] * (history[index[lane] + 1] - state) + history[index[lane]];
+                output[lane] = state;
+            }
+
+            return _mm_load_ps (output);
+        }
+    };
+
+    template <>
+    struct SSE2Reader<SincInterpolator>
+    {
+        GHOSTLINE_TARGET_SSE2 static __m128 read (const float* history, const int* index, __m128 t, float&) noexcept
+        {
+            // Vectorised across the eight taps: each lane's taps are contiguous in the history
+            const __m128 position = _mm_mul_ps (t, _mm_set1_ps (static_cast<float> (SincTable::numPhases)));
+            const __m128i phase = _mm_cvttps_epi32 (position);
+            const __m128 blend = _mm_sub_ps (position, _mm_cvtepi32_ps (phase));
+
+            alignas (16) int phases[4];
+            alignas (16) float blends[4];
+            _mm_store_si128 (reinterpret_cast<__m128i*> (phases), phase);
+            _mm_store_ps (blends, blend);
+
+            alignas (16) float output[4];
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                const float* x = history + index[lane];
+                const float* row = SincInterpolator::table.getRow (phases[lane]);
+                const __m128 b = _mm_set1_ps (blends[lane]);
+
+                const __m128 r0 = _mm_load_ps (row);
+                const __m128 r1 = _mm_load_ps (row + 4);
+                const __m128 c0 = _mm_add_ps (r0, _mm_mul_ps (b, _mm_sub_ps (_mm_load_ps (row + 8), r0)));
+                const __m128 c1 = _mm_add_ps (r1, _mm_mul_ps (b, _mm_sub_ps (_mm_load_ps (row + 12), r1)));
+
+                output[lane] = sumSSE2 (_mm_add_ps (_mm_mul_ps (_mm_loadu_ps (x), c0), _mm_mul_ps (_mm_loadu_ps (x + 4), c1)));
+            }
+
+            return _mm_load_ps (output);
+        }
+    };
+
+    template <typename Interpolator>
+    GHOSTLINE_TARGET_SSE2 void processSSE2With (const DelayKernelContext& c, float& state)
+    {
+        constexpr int width = 4;
+
+        const int size = c.delayBufferSize;
+
+        const __m128 sizeF = _mm_set1_ps (static_cast<float> (size));
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 readOffset = _mm_set1_ps (Interpolator::readOffset);
+        const __m128 minDistance = _mm_set1_ps (getMinimumVectorDistance<Interpolator> (width));
+        const __m128i laneOffsets = _mm_setr_epi32 (0, 1, 2, 3);
+        const __m128 feedback = _mm_set1_ps (c.feedback);
+
+        int writePos = *c.writePosition;
+        int sample = 0;
+
+        while (sample < c.numSamples)
+        {
+            if (sample + width <= c.numSamples && writePos + width <= size)
+            {
+                const __m128 distance = _mm_loadu_ps (c.delaySamples + sample);
+
+                if (_mm_movemask_ps (_mm_cmplt_ps (distance, minDistance)) == 0)
+                {
+                    const __m128 position = _mm_cvtepi32_ps (_mm_add_epi32 (_mm_set1_epi32 (writePos), laneOffsets));
+
+                    __m128 readPos = _mm_sub_ps (position, distance);
+                    if constexpr (Interpolator::readOffset != 0.0f)
+                        readPos = _mm_sub_ps (readPos, readOffset);
+                    readPos = _mm_add_ps (readPos, _mm_and_ps (_mm_cmplt_ps (readPos, zero), sizeF));
+
+                    const __m128i index = _mm_cvttps_epi32 (readPos);
+                    const __m128 fraction = _mm_sub_ps (readPos, _mm_cvtepi32_ps (index));
+
+                    alignas (16) int i0[width];
+                    _mm_store_si128 (reinterpret_cast<__m128i*> (i0), index);
+
+                    const __m128 delayed = SSE2Reader<Interpolator>::read (c.delayBuffer, i0, fraction, state);
+
+                    const __m128 input = _mm_loadu_ps (c.channelData + sample);
+                    _mm_storeu_ps (c.channelData + sample, delayed);
+                    const __m128 written = _mm_add_ps (input, _mm_mul_ps (delayed, feedback));
+                    _mm_storeu_ps (c.delayBuffer + writePos, written);
+                    if (writePos < MirroredDelayBuffer::guardSamples)
+                        _mm_storeu_ps (c.delayBuffer + writePos + size, written);
+
+                    sample += width;
+                    writePos += width;
+                    if (writePos == size)
+                        writePos = 0;
+
+                    continue;
+                }
+            }
+
+            processSample<Interpolator> (c, sample++, writePos, state);
+        }
+
+        *c.writePosition = writePos;
+    }
+
+    void processSSE2 (const DelayKernelContext& c)
+    {
+        dispatch (c, [&c] (auto interpolator, float& state) { processSSE2With<decltype (interpolator)> (c, state); });
+    }
+
+    //==============================================================================
+    GHOSTLINE_TARGET_AVX2 inline __m256 gatherAVX2 (const float* history, __m256i index, int tap) noexcept
+    {
+        return _mm256_i32gather_ps (history + tap, index, 4);
+    }
+
+    template <typename Interpolator> struct AVX2Reader;
+
+    template <>
+    struct AVX2Reader<LinearInterpolator>
+    {
+        GHOSTLINE_TARGET_AVX2 static __m256 read (const float* history, __m256i index, __m256 t, float&) noexcept
+        {
+            const __m256 x0 = gatherAVX2 (history, index, 0);
+            const __m256 x1 = gatherAVX2 (history, index, 1);
+            return _mm256_add_ps (_mm256_mul_ps (x0, _mm256_sub_ps (_mm256_set1_ps (1.0f), t)), _mm256_mul_ps (x1, t));
+        }
+    };
+
+    template <>
+    struct AVX2Reader<HermiteInterpolator>
+    {
+        GHOSTLINE_TARGET_AVX2 static __m256 read (const float* history, __m256i index, __m256 t, float&) noexcept
+        {
+            const __m256 x0 = gatherAVX2 (history, index, 0);
+            const __m256 x1 = gatherAVX2 (history, index, 1);
+            const __m256 x2 = gatherAVX2 (history, index, 2);
+            const __m256 x3 = gatherAVX2 (history, index, 3);
+            const __m256 half = _mm256_set1_ps (0.5f);
+
+            const __m256 c1 = _mm256_mul_ps (half, _mm256_sub_ps (x2, x0));
+            const __m256 c2 = _mm256_sub_ps (_mm256_add_ps (_mm256_sub_ps (x0, _mm256_mul_ps (_mm256_set1_ps (2.5f), x1)), _mm256_mul_ps (_mm256_set1_ps (2.0f), x2)),
+                                             _mm256_mul_ps (half, x3));
+            const __m256 c3 = _mm256_add_ps (_mm256_mul_ps (half, _mm256_sub_ps (x3, x0)), _mm256_mul_ps (_mm256_set1_ps (1.5f), _mm256_sub_ps (x1, x2)));
+
+            __m256 y = _mm256_add_ps (_mm256_mul_ps (c3, t), c2);
+            y = _mm256_add_ps (_mm256_mul_ps (y, t), c1);
+            return _mm256_add_ps (_mm256_mul_ps (y, t), x1);
+        }
+    };
+
+    template <>
+    struct AVX2Reader<LagrangeInterpolator>
+    {
+        GHOSTLINE_TARGET_AVX2 static __m256 read (const float* history, __m256i index, __m256 t, float&) noexcept
+        {
+            const __m256 x0 = gatherAVX2 (history, index, 0);
+            const __m256 x1 = gatherAVX2 (history, index, 1);
+            const __m256 x2 = gatherAVX2 (history, index, 2);
+            const __m256 x3 = gatherAVX2 (history, index, 3);
+            const __m256 sign = _mm256_set1_ps (-0.0f);
+            const __m256 sixth = _mm256_set1_ps (1.0f / 6.0f);
+            const __m256 half = _mm256_set1_ps (0.5f);
+
+            const __m256 tp1 = _mm256_add_ps (t, _mm256_set1_ps (1.0f));
+            const __m256 tm1 = _mm256_sub_ps (t, _mm256_set1_ps (1.0f));
+            const __m256 tm2 = _mm256_sub_ps (t, _mm256_set1_ps (2.0f));
+
+            const __m256 h0 = _mm256_mul_ps (_mm256_mul_ps (_mm256_mul_ps (_mm256_xor_ps (t, sign), tm1), tm2), sixth);
+            const __m256 h1 = _mm256_mul_ps (_mm256_mul_ps (_mm256_mul_ps (tp1, tm1), tm2), half);
+            const __m256 h2 = _mm256_mul_ps (_mm256_mul_ps (_mm256_mul_ps (_mm256_xor_ps (tp1, sign), t), tm2), half);
+            const __m256 h3 = _mm256_mul_ps (_mm256_mul_ps (_mm256_mul_ps (tp1, t), tm1), sixth);
+
+            return _mm256_add_ps (_mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (h0, x0), _mm256_mul_ps (h1, x1)), _mm256_mul_ps (h2, x2)), _mm256_mul_ps (h3, x3));
+        }
+    };
+
+    template <>
+    struct AVX2Reader<AllpassInterpolator>
+    {
+        GHOSTLINE_TARGET_AVX2 static __m256 read (const float* history, __m256i index, __m256 t, float& state) noexcept
+        {
+            const __m256 a = _mm256_div_ps (_mm256_sub_ps (t, _mm256_set1_ps (0.5f)), _mm256_sub_ps (_mm256_set1_ps (2.5f), t));
+
+            alignas (32) float coefficients[8];
+            alignas (32) float x0[8];
+            alignas (32) float x1[8];
+            _mm256_store_ps (coefficients, a);
+            _mm256_store_ps (x0, gatherAVX2 (history, index, 0));
+            _mm256_store_ps (x1, gatherAVX2 (history, index, 1));
+
+            alignas (32) float output[8];
+            for (int lane = 0; lane < 8; ++lane)
+            {
+                state = coefficients[lane] * (x1[lane] - state) + x0[lane];
+                output[lane] = state;
+            }
+
+            return _mm256_load_ps (output);
+        }
+    };
+
+    template <>
+    struct AVX2Reader<SincInterpolator>
+    {
+        GHOSTLINE_TARGET_AVX2 static __m256 read (const float* history, __m256i index, __m256 t, float&) noexcept
+        {
+            // One lane per tap: a single unaligned load fetches all eight
+            const __m256 position = _mm256_mul_ps (t, _mm256_set1_ps (static_cast<float> (SincTable::numPhases)));
+            const __m256i phase = _mm256_cvttps_epi32 (position);
+            const __m256 blend = _mm256_sub_ps (position, _mm256_cvtepi32_ps (phase));
+
+            alignas (32) int indices[8];
+            alignas (32) int phases[8];
+            alignas (32) float blends[8];
+            _mm256_store_si256 (reinterpret_cast<__m256i*> (indices), index);
+            _mm256_store_si256 (reinterpret_cast<__m256i*> (phases), phase);
+            _mm256_store_ps (blends, blend);
+
+            alignas (32) float output[8];
+            for (int lane = 0; lane < 8; ++lane)
+            {
+                const float* row = SincInterpolator::table.getRow (phases[lane]);
+                const __m256 r0 = _mm256_load_ps (row);
+                const __m256 coefficients = _mm256_add_ps (r0, _mm256_mul_ps (_mm256_set1_ps (blends[lane]), _mm256_sub_ps (_mm256_load_ps (row + 8), r0)));
+                const __m256 products = _mm256_mul_ps (_mm256_loadu_ps (history + indices[lane]), coefficients);
+
+                output[lane] = sumSSE2 (_mm_add_ps (_mm256_castps256_ps128 (products), _mm256_extractf128_ps (products, 1)));
+            }
+
+            return _mm256_load_ps (output);
+        }
+    };
+
+    template <typename Interpolator>
+    GHOSTLINE_TARGET_AVX2 void processAVX2With (const DelayKernelContext& c, float& state)
+    {
+        constexpr int width = 8;
+
+        const int size = c.delayBufferSize;
+
+        const __m256 sizeF = _mm256_set1_ps (static_cast<float> (size));
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 readOffset = _mm256_set1_ps (Interpolator::readOffset);
+        const __m256 minDistance = _mm256_set1_ps (getMinimumVectorDistance<Interpolator> (width));
+        const __m256i laneOffsets = _mm256_setr_epi32 (0, 1, 2, 3, 4, 5, 6, 7);
+        const __m256 feedback = _mm256_set1_ps (c.feedback);
+
+        int writePos = *c.writePosition;
+        int sample = 0;
+
+        while (sample < c.numSamples)
+        {
+            if (sample + width <= c.numSamples && writePos + width <= size)
+            {
+                const __m256 distance = _mm256_loadu_ps (c.delaySamples + sample);
+
+                if (_mm256_movemask_ps (_mm256_cmp_ps (distance, minDistance, _CMP_LT_OQ)) == 0)
+                {
+                    const __m256 position = _mm256_cvtepi32_ps (_mm256_add_epi32 (_mm256_set1_epi32 (writePos), laneOffsets));
+
+                    __m256 readPos = _mm256_sub_ps (position, distance);
+                    if constexpr (Interpolator::readOffset != 0.0f)
+                        readPos = _mm256_sub_ps (readPos, readOffset);
+                    readPos = _mm256_add_ps (readPos, _mm256_and_ps (_mm256_cmp_ps (readPos, zero, _CMP_LT_OQ), sizeF));
+
+                    const __m256i index = _mm256_cvttps_epi32 (readPos);
+                    const __m256 fraction = _mm256_sub_ps (readPos, _mm256_cvtepi32_ps (index));
+
+                    const __m256 delayed = AVX2Reader<Interpolator>::read (c.delayBuffer, index, fraction, state);
+
+                    const __m256 input = _mm256_loadu_ps (c.channelData + sample);
+                    _mm256_storeu_ps (c.channelData + sample, delayed);
+                    const __m256 written = _mm256_add_ps (input, _mm256_mul_ps (delayed, feedback));
+                    _mm256_storeu_ps (c.delayBuffer + writePos, written);
+                    if (writePos < MirroredDelayBuffer::guardSamples)
+                        _mm256_storeu_ps (c.delayBuffer + writePos + size, written);
+
+                    sample += width;
+                    writePos += width;
+                    if (writePos == size)
+                        writePos = 0;
+
+                    continue;
+                }
+            }
+
+            processSample<Interpolator> (c, sample++, writePos, state);
+        }
+
+        *c.writePosition = writePos;
+    }
+
+    void processAVX2 (const DelayKernelContext& c)
+    {
+        dispatch (c, [&c] (auto interpolator, float& state) { processAVX2With<decltype (interpolator)> (c, state); });
+    }
+   #endif
+
+   #if GHOSTLINE_HAS_NEON
+    //==============================================================================
+    inline float32x4_t gatherNEON (const float* history, const int32_t* index, int tap) noexcept
+    {
+        const float values[4] = { history[index[0] + tap], history[index[1] + tap], history[index[2] + tap], history[index[3] + tap] };
+        return vld1q_f32 (values);
+    }
+
+    inline float sumNEON (float32x4_t v) noexcept
+    {
+        const float32x2_t pairs = vadd_f32 (vget_low_f32 (v), vget_high_f32 (v));
+        return vget_lane_f32 (vpadd_f32 (pairs, pairs), 0);
+    }
+
+    template <typename Interpolator> struct NEONReader;
+
+    template <>
+    struct NEONReader<LinearInterpolator>
+    {
+        static float32x4_t read (const float* history, const int32_t* index, float32x4_t t, float&) noexcept
+        {
+            const float32x4_t x0 = gatherNEON (history, index, 0);
+            const float32x4_t x1 = gatherNEON (history, index, 1);
+            return vaddq_f32 (vmulq_f32 (x0, vsubq_f32 (vdupq_n_f32 (1.0f), t)), vmulq_f32 (x1, t));
+        }
+    };
+
+    template <>
+    struct NEONReader<HermiteInterpolator>
+    {
+        static float32x4_t read (const float* history, const int32_t* index, float32x4_t t, float&) noexcept
+        {
+            const float32x4_t x0 = gatherNEON (history, index, 0);
+            const float32x4_t x1 = gatherNEON (history, index, 1);
+            const float32x4_t x2 = gatherNEON (history, index, 2);
+            const float32x4_t x3 = gatherNEON (history, index, 3);
+            const float32x4_t half = vdupq_n_f32 (0.5f);
+
+            const float32x4_t c1 = vmulq_f32 (half, vsubq_f32 (x2, x0));
+            const float32x4_t c2 = vsubq_f32 (vaddq_f32 (vsubq_f32 (x0, vmulq_f32 (vdupq_n_f32 (2.5f), x1)), vmulq_f32 (vdupq_n_f32 (2.0f), x2)),
+                                              vmulq_f32 (half, x3));
+            const float32x4_t c3 = vaddq_f32 (vmulq_f32 (half, vsubq_f32 (x3, x0)), vmulq_f32 (vdupq_n_f32 (1.5f), vsubq_f32 (x1, x2)));
+
+            float32x4_t y = vaddq_f32 (vmulq_f32 (c3, t), c2);
+            y = vaddq_f32 (vmulq_f32 (y, t), c1);
+            return vaddq_f32 (vmulq_f32 (y, t), x1);
+        }
+    };
+
+    template <>
+    struct NEONReader<LagrangeInterpolator>
+    {
+        static float32x4_t read (const float* history, const int32_t* index, float32x4_t t, float&) noexcept
+        {
+            const float32x4_t x0 = gatherNEON (history, index, 0);
+            const float32x4_t x1 = gatherNEON (history, index, 1);
+            const float32x4_t x2 = gatherNEON (history, index, 2);
+            const float32x4_t x3 = gatherNEON (history, index, 3);
+            const float32x4_t sixth = vdupq_n_f32 (1.0f / 6.0f);
+            const float32x4_t half = vdupq_n_f32 (0.5f);
+
+            const float32x4_t tp1 = vaddq_f32 (t, vdupq_n_f32 (1.0f));
+            const float32x4_t tm1 = vsubq_f32 (t, vdupq_n_f32 (1.0f));
+            const float32x4_t tm2 = vsubq_f32 (t, vdupq_n_f32 (2.0f));
+
+            const float32x4_t h0 = vmulq_f32 (vmulq_f32 (vmulq_f32 (vnegq_f32 (t), tm1), tm2), sixth);
+            const float32x4_t h1 = vmulq_f32 (vmulq_f32 (vmulq_f32 (tp1, tm1), tm2), half);
+            const float32x4_t h2 = vmulq_f32 (vmulq_f32 (vmulq_f32 (vnegq_f32 (tp1), t), tm2), half);
+            const float32x4_t h3 = vmulq_f32 (vmulq_f32 (vmulq_f32 (tp1, t), tm1), sixth);
+
+            return vaddq_f32 (vaddq_f32 (vaddq_f32 (vmulq_f32 (h0, x0), vmulq_f32 (h1, x1)), vmulq_f32 (h2, x2)), vmulq_f32 (h3, x3));
+        }
+    };
+
+    template <>
+    struct NEONReader<AllpassInterpolator>
+    {
+        static float32x4_t read (const float* history, const int32_t* index, float32x4_t t, float& state) noexcept
+        {
+            float fractions[4];
+            vst1q_f32 (fractions, t);
+
+            float output[4];
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                state = AllpassInterpolator::getCoefficient (fractions[lane]) * (history[index[lane] + 1] - state) + history[index[lane]];
+                output[lane] = state;
+            }
+
+            return vld1q_f32 (output);
+        }
+    };
+
+    template <>
+    struct NEONReader<SincInterpolator>
+    {
+        static float32x4_t read (const float* history, const int32_t* index, float32x4_t t, float&) noexcept
+        {
+            const float32x4_t position = vmulq_f32 (t, vdupq_n_f32 (static_cast<float> (SincTable::numPhases)));
+            const int32x4_t phase = vcvtq_s32_f32 (position);
+            const float32x4_t blend = vsubq_f32 (position, vcvtq_f32_s32 (phase));
+
+            int32_t phases[4];
+            float blends[4];
+            vst1q_s32 (phases, phase);
+            vst1q_f32 (blends, blend);
+
+            float output[4];
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                const float* x = history + index[lane];
+                const float* row = SincInterpolator::table.getRow (phases[lane]);
+                const float32x4_t b = vdupq_n_f32 (blends[lane]);
+
+                const float32x4_t r0 = vld1q_f32 (row);
+                const float32x4_t r1 = vld1q_f32 (row + 4);
+                const float32x4_t c0 = vaddq_f32 (r0, vmulq_f32 (b, vsubq_f32 (vld1q_f32 (row + 8), r0)));
+                const float32x4_t c1 = vaddq_f32 (r1, vmulq_f32 (b, vsubq_f32 (vld1q_f32 (row + 12), r1)));
+
+                output[lane] = sumNEON (vaddq_f32 (vmulq_f32 (vld1q_f32 (x), c0), vmulq_f32 (vld1q_f32 (x + 4), c1)));
+            }
+
+            return vld1q_f32 (output);
+        }
+    };
+
+    template <typename Interpolator>
+    void processNEONWith (const DelayKernelContext& c, float& state)
+    {
+        constexpr int width = 4;
+
+        const int size = c.delayBufferSize;
+
+        const float32x4_t sizeF = vdupq_n_f32 (static_cast<float> (size));
+        const uint32x4_t sizeBits = vreinterpretq_u32_f32 (sizeF);
+        const float32x4_t zero = vdupq_n_f32 (0.0f);
+        const float32x4_t readOffset = vdupq_n_f32 (Interpolator::readOffset);
+        const float32x4_t minDistance = vdupq_n_f32 (getMinimumVectorDistance<Interpolator> (width));
+        const int32_t offsets[width] = { 0, 1, 2, 3 };
+        const int32x4_t laneOffsets = vld1q_s32 (offsets);
+        const float32x4_t feedback = vdupq_n_f32 (c.feedback);
+
+        int writePos = *c.writePosition;
+        int sample = 0;
+
+        while (sample < c.numSamples)
+        {
+            if (sample + width <= c.numSamples && writePos + width <= size)
+            {
+                const float32x4_t distance = vld1q_f32 (c.delaySamples + sample);
+                const uint32x4_t tooClose = vcltq_f32 (distance, minDistance);
+                const uint32x2_t folded = vorr_u32 (vget_low_u32 (tooClose), vget_high_u32 (tooClose));
+
+                if ((vget_lane_u32 (folded, 0) | vget_lane_u32 (folded, 1)) == 0)
+                {
+                    const float32x4_t position = vcvtq_f32_s32 (vaddq_s32 (vdupq_n_s32 (writePos), laneOffsets));
+
+                    float32x4_t readPos = vsubq_f32 (position, distance);
+                    if constexpr (Interpolator::readOffset != 0.0f)
+                        readPos = vsubq_f32 (readPos, readOffset);
+                    readPos = vaddq_f32 (readPos, vreinterpretq_f32_u32 (vandq_u32 (vcltq_f32 (readPos, zero), sizeBits)));
+
+                    const int32x4_t index = vcvtq_s32_f32 (readPos);
+                    const float32x4_t fraction = vsubq_f32 (readPos, vcvtq_f32_s32 (index));
+
+                    int32_t i0[width];
+                    vst1q_s32 (i0, index);
+
+                    const float32x4_t delayed = NEONReader<Interpolator>::read (c.delayBuffer, i0, fraction, state);
+
+                    const float32x4_t input = vld1q_f32 (c.channelData + sample);
+                    vst1q_f32 (c.channelData + sample, delayed);
+                    const float32x4_t written = vaddq_f32 (input, vmulq_f32 (delayed, feedback));
+                    vst1q_f32 (c.delayBuffer + writePos, written);
+                    if (writePos < MirroredDelayBuffer::guardSamples)
+                        vst1q_f32 (c.delayBuffer + writePos + size, written);
+
+                    sample += width;
+                    writePos += width;
+                    if (writePos == size)
+                        writePos = 0;
+
+                    continue;
+                }
+            }
+
+            processSample<Interpolator> (c, sample++, writePos, state);
+        }
+
+        *c.writePosition = writePos;
+    }
+
+    void processNEON (const DelayKernelContext& c)
+    {
+        dispatch (c, [&c] (auto interpolator, float& state) { processNEONWith<decltype (interpolator)> (c, state); });
+    }
+   #endif
+
+    DelayKernel selectDelayKernel()
+    {
+       #if JUCE_INTEL
+        if (juce::SystemStats::hasAVX2())
+            return { "AVX2", processAVX2 };
+
+        if (juce::SystemStats::hasSSE2())
+            return { "SSE2", processSSE2 };
+       #elif GHOSTLINE_HAS_NEON
+        return { "NEON", processNEON };
+       #endif
+
+        return getScalarDelayKernel();
+    }
+}
+
+//==============================================================================
+template <typename SampleType>
+void processDelayLoop (const BasicDelayKernelContext<SampleType>& c) noexcept
+{
+    dispatch (c, [&c] (auto interpolator, SampleType& state) { processScalarWith<decltype (interpolator)> (c, state); });
+}
+
+template void processDelayLoop (const BasicDelayKernelContext<float>&) noexcept;
+template void processDelayLoop (const BasicDelayKernelContext<double>&) noexcept;
+
+template <typename SampleType>
+void processSettledDelayLoop (const BasicDelayKernelContext<SampleType>& c, SampleType delaySamples) noexcept
+{
+    using Buffer = BasicMirroredDelayBuffer<SampleType>;
+    using FVO = juce::FloatVectorOperations;
+
+    dispatch (c, [&c, delaySamples] (auto interpolator, SampleType& state)
+    {
+        using Interpolator = decltype (interpolator);
+        constexpr int numTaps = Interpolator::numTaps;
+
+        const int size = c.delayBufferSize;
+        SampleType* history = c.delayBuffer;
+
+        // Read index distance whole samples behind the write head, at fraction t
+        const SampleType offsetDistance = delaySamples + static_cast<SampleType> (Interpolator::readOffset);
+        const int distance = static_cast<int> (std::ceil (offsetDistance));
+        const SampleType t = static_cast<SampleType> (distance) - offsetDistance;
+
+        // Every kernel but the allpass is linear in its taps: feeding it unit
+        // impulses gives the weight of each
+        SampleType weights[numTaps];
+        for (int k = 0; k < numTaps; ++k)
+        {
+            SampleType impulse[numTaps] = {};
+            SampleType unused = 0;
+            impulse[k] = SampleType (1);
+            weights[k] = Interpolator::interpolate (impulse, t, unused);
+        }
+
+        // A span may only read taps older than its first write, and, with the
+        // history being a ring, none its own later writes have come round to
+        constexpr bool stateful = std::is_same_v<Interpolator, AllpassInterpolator>;
+        const int maxSpan = stateful ? 0 : juce::jmin (distance - numTaps + 1, size - distance);
+
+        int writePos = *c.writePosition;
+        int readPos = writePos - distance;
+        readPos += readPos < 0 ? size : 0;
+
+        for (int sample = 0; sample < c.numSamples;)
+        {
+            // Stop at either wrap; past the end the reads run into the mirror, which is only guardSamples long
+            const int span = juce::jmin (c.numSamples - sample, size - writePos, size - readPos, maxSpan);
+            SampleType* io = c.channelData + sample;
+
+            if (span > 0)
+            {
+                SampleType* written = history + writePos;
+                const SampleType* taps = history + readPos;
+
+                // Nothing in the span reads the slots it writes, so the input can go in first
+                FVO::copy (written, io, span);
+                FVO::copyWithMultiply (io, taps, weights[0], span);
+                for (int k = 1; k < numTaps; ++k)
+                    FVO::addWithMultiply (io, taps + k, weights[k], span);
+
+                FVO::addWithMultiply (written, io, c.feedback, span);
+
+                if (writePos < Buffer::guardSamples)
+                    FVO::copy (written + size, written, juce::jmin (span, Buffer::guardSamples - writePos));
+            }
+            else
+            {
+                // Too close to the head for a span, or the allpass: one sample as the reference loop does it
+                const SampleType delayed = Interpolator::interpolate (history + readPos, t, state);
+                const SampleType input = io[0];
+                io[0] = delayed;
+                Buffer::write (history, size, writePos, input + (delayed * c.feedback));
+            }
+
+            const int advance = juce::jmax (1, span);
+            sample += advance;
+
+            if ((writePos += advance) == size)
+                writePos = 0;
+
+            if ((readPos += advance) == size)
+                readPos = 0;
+        }
+
+        *c.writePosition = writePos;
+    });
+}
+
+template void processSettledDelayLoop (const BasicDelayKernelContext<float>&, float) noexcept;
+template void processSettledDelayLoop (const BasicDelayKernelContext<double>&, double) noexcept;
+
+const DelayKernel& getScalarDelayKernel()
+{
+    static const DelayKernel kernel { "Scalar", processScalar };
+    return kernel;
+}
+
+const DelayKernel& getDelayKernel()
+{
+    static const DelayKernel kernel = selectDelayKernel();
+    return kernel;
+}
+
+const std::vector<DelayKernel>& getAvailableDelayKernels()
+{
+    static const std::vector<DelayKernel> kernels = []
+    {
+        std::vector<DelayKernel> available { getScalarDelayKernel() };
+
+       #if JUCE_INTEL
+        if (juce::SystemStats::hasSSE2())
+            available.push_back ({ "SSE2", processSSE2 });
+
+        if (juce::SystemStats::hasAVX2())
+            available.push_back ({ "AVX2", processAVX2 });
+       #elif GHOSTLINE_HAS_NEON
+        available.push_back ({ "NEON", processNEON });
+       #endif
+
+        return available;
+    }();
+
+    return kernels;
+}
+
+} // namespace ghostline
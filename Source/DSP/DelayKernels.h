@@ -0,0 +1,125 @@
+/*
+  ==============================================================================
+
+    DelayKernels.h
+    Vectorised read/mix/write kernels for the echo loop. The instruction set
+    is picked once at startup; the scalar loop remains the fallback.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "MirroredDelayBuffer.h"
+#include "Interpolators.h"
+
+namespace ghostline
+{
+
+//==============================================================================
+/** Everything one channel of the echo loop needs to process a block, in
+    the precision the host is running at. Audio, read distances and the
+    feedback arithmetic all use SampleType.
+*/
+template <typename SampleType>
+struct BasicDelayKernelContext
+{
+    SampleType* channelData = nullptr;         // In: dry input. Out: the echo, before the mix stage.
+    SampleType* delayBuffer = nullptr;         // One BasicMirroredDelayBuffer<SampleType> channel
+    int delayBufferSize = 0;
+    int* writePosition = nullptr;              // Advanced by numSamples on return
+    const SampleType* delaySamples = nullptr;  // Per-sample read distance, already clamped to
+                                               // [interpolationMargin, delayBufferSize - interpolationMargin]
+    int numSamples = 0;
+
+    InterpolationMode interpolation = InterpolationMode::linear;
+    SampleType* interpolatorState = nullptr;   // One value per read head, carried between blocks by the allpass
+
+    SampleType feedback = 0;
+};
+
+using DelayKernelContext = BasicDelayKernelContext<float>;
+
+using DelayKernelFunction = void (*) (const DelayKernelContext&);
+
+struct DelayKernel
+{
+    const char* name;
+    DelayKernelFunction process;
+};
+
+/** How far a vector kernel may drift from the scalar loop, per sample, for
+    signals within [-1, 1].
+
+    The x86 kernels perform the same IEEE operations in the same order as the
+    scalar loop, so they match it bit for bit, except for the sinc kernel,
+    which sums its eight products as a tree rather than left to right. On ARM
+    the compiler is free to fuse multiply-adds differently in the two paths.
+    Either costs at most a few ulp per sample; this bound covers that even
+    with feedback recirculating.
+*/
+constexpr float delayKernelTolerance = 1.0e-6f;
+
+/** The reference loop, one sample at a time. */
+const DelayKernel& getScalarDelayKernel();
+
+/** The reference loop in either precision, instantiated for float and
+    double. getScalarDelayKernel() runs the float one; double-precision
+    processing runs the double one, which has no vector counterpart.
+*/
+template <typename SampleType>
+void processDelayLoop (const BasicDelayKernelContext<SampleType>& context) noexcept;
+
+/** The loop for a block whose read distance doesn't move: every sample
+    reads delaySamples behind the write head, and context.delaySamples is
+    not used. With the fraction fixed, the interpolator becomes numTaps
+    weights applied to contiguous spans of the history, so the block is a
+    few vector multiply-adds with no per-sample positions or gathers. The
+    allpass, which carries state from sample to sample, runs one sample at
+    a time. Instantiated for float and double.
+
+    The per-sample loops subtract the distance from the write position in
+    SampleType, which rounds the fraction more coarsely the further the
+    head is from 0; this takes the fraction from the distance alone, so the
+    two only agree to within delayKernelTolerance for whole-sample distances.
+
+    Spans can be no longer than the distance, so below minimumSettledDelay
+    they are too short to beat the per-sample kernels.
+*/
+template <typename SampleType>
+void processSettledDelayLoop (const BasicDelayKernelContext<SampleType>& context, SampleType delaySamples) noexcept;
+
+constexpr float minimumSettledDelay = 32.0f;
+
+/** Writes the input into the history without reading anything back, for
+    blocks whose echo would go nowhere: no wet signal and no feedback. Works
+    on any history with write (index, value) and size.
+*/
+template <typename History, typename SampleType>
+void recordDelayInput (const History& history, const SampleType* input, int numSamples, int& writePosition) noexcept
+{
+    using StoredType = decltype (history.read (0));
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        history.write (writePosition, static_cast<StoredType> (input[i]));
+
+        if (++writePosition == history.size)
+            writePosition = 0;
+    }
+}
+
+/** The fastest kernel the running CPU supports (AVX2, SSE2, NEON or scalar).
+    Selected on the first call and cached for the lifetime of the process.
+    Every kernel handles every InterpolationMode; the mode is resolved once
+    per call, outside the sample loop.
+*/
+const DelayKernel& getDelayKernel();
+
+/** Every kernel the running CPU supports, the scalar one first and
+    getDelayKernel()'s last, for checking them against each other.
+*/
+const std::vector<DelayKernel>& getAvailableDelayKernels();
+
+} // namespace ghostline
@@ -0,0 +1,325 @@
+/*
+  ==============================================================================
+
+    DelayMemory.cpp
+
+  ==============================================================================
+*/
+
+#include "DelayMemory.h"
+
+namespace ghostline
+{
+
+namespace
+{
+    // The newest and oldest samples in the live memory are still moving: a
+    // block-float write rescales the whole 32-sample block around the head.
+    // Two blocks either side are never read from another thread.
+    constexpr int settleSamples = 2 * CompactDelayBuffer::samplesPerBlock;
+
+    // Room left ahead of the oldest sample copied, for the blocks the audio
+    // thread writes while a chunk is being copied
+    constexpr int headroomSamples = 8192;
+    constexpr int chunkSamples = 4096;
+
+    // The worker hands over once the audio thread is at most this far ahead
+    // of its copy; the audio thread copies the rest when it swaps
+    constexpr int handOverSamples = 2048;
+
+    template <typename Source, typename Destination>
+    void copySamples (const Source& from, const Destination& to, int sourcePosition, int destinationPosition, int numSamples) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            to.write (destinationPosition, static_cast<decltype (to.read (0))> (from.read (sourcePosition)));
+
+            if (++sourcePosition == from.size)
+                sourcePosition = 0;
+
+            if (++destinationPosition == to.size)
+                destinationPosition = 0;
+        }
+    }
+
+    template <typename Codec>
+    float findMagnitude (const Codec& history, int position, int numSamples) noexcept
+    {
+        float magnitude = 0.0f;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            magnitude = juce::jmax (magnitude, static_cast<float> (std::abs (history.read (position))));
+
+            if (++position == history.size)
+                position = 0;
+        }
+
+        return magnitude;
+    }
+
+    float findMagnitude (const MirroredDelayBuffer::History& history, int position, int numSamples) noexcept
+    {
+        float magnitude = 0.0f;
+
+        // Float storage is contiguous: at most two vectorised runs either side of the wrap
+        for (int done = 0; done < numSamples;)
+        {
+            const int length = juce::jmin (numSamples - done, history.size - position);
+            const auto range = juce::FloatVectorOperations::findMinAndMax (history.data + position, length);
+            magnitude = juce::jmax (magnitude, -range.getStart(), range.getEnd());
+
+            done += length;
+            position = 0;
+        }
+
+        return magnitude;
+    }
+}
+
+//==============================================================================
+DelayMemory::DelayMemory (const DelayMemoryLayout& newLayout)
+    : layout (newLayout)
+{
+    jassert (layout.numChannels > 0 && layout.size > MirroredDelayBuffer::guardSamples);
+
+    if (usesCompactStorage())
+        compactBuffer.setSize (layout.numChannels, layout.size, layout.format);
+    else if (layout.format == DelayStorageFormat::float64)
+        doubleBuffer.setSize (layout.numChannels, layout.size);
+    else
+        floatBuffer.setSize (layout.numChannels, layout.size);
+}
+
+void DelayMemory::clear() noexcept
+{
+    floatBuffer.clear();
+    doubleBuffer.clear();
+    compactBuffer.clear();
+    samplesWritten.store (0, std::memory_order_relaxed);
+}
+
+float DelayMemory::getMagnitude (int channel, int position, int numSamples) noexcept
+{
+    jassert (juce::isPositiveAndBelow (channel, layout.numChannels));
+
+    float magnitude = 0.0f;
+    visitChannel (channel, [&] (const auto& history) { magnitude = findMagnitude (history, position, numSamples); });
+    return magnitude;
+}
+
+void DelayMemory::copyFrom (DelayMemory& source, juce::int64 first, juce::int64 last) noexcept
+{
+    first = juce::jmax (first, last - juce::jmin (layout.size, source.layout.size));
+
+    if (first >= last)
+        return;
+
+    const auto numSamples = static_cast<int> (last - first);
+    const int sourcePosition = source.getPosition (first);
+    const int destinationPosition = getPosition (first);
+    const int numChannels = juce::jmin (layout.numChannels, source.layout.numChannels);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        visitChannel (channel, [&] (const auto& to)
+        {
+            source.visitChannel (channel, [&] (const auto& from)
+            {
+                copySamples (from, to, sourcePosition, destinationPosition, numSamples);
+            });
+        });
+}
+
+//==============================================================================
+DelayMemoryManager::DelayMemoryManager()
+    : juce::Thread ("Ghostline delay memory")
+{
+    startThread();
+}
+
+DelayMemoryManager::~DelayMemoryManager()
+{
+    stopThread (2000);
+
+    const juce::ScopedLock sl (workerLock);
+    settle();
+}
+
+void DelayMemoryManager::prepare (const DelayMemoryLayout& layout)
+{
+    const juce::ScopedLock sl (workerLock);
+    settle();
+
+    {
+        const juce::ScopedLock rl (requestLock);
+        requestedLayout = layout;
+        hasRequest = false;
+    }
+
+    // Same layout: keep the allocation, lose the echoes
+    if (current != nullptr && current->getLayout() == layout)
+        current->clear();
+    else
+        current = std::make_unique<DelayMemory> (layout);
+
+    active.store (current.get(), std::memory_order_release);
+}
+
+void DelayMemoryManager::requestLayout (const DelayMemoryLayout& layout)
+{
+    {
+        const juce::ScopedLock rl (requestLock);
+        requestedLayout = layout;
+        hasRequest = true;
+    }
+
+    notify();
+}
+
+bool DelayMemoryManager::adoptPending() noexcept
+{
+    auto* next = pending.exchange (nullptr, std::memory_order_acq_rel);
+
+    if (next == nullptr)
+        return false;
+
+    // Whatever was written since the worker's last pass, at most a few blocks
+    auto* previous = active.load (std::memory_order_relaxed);
+    const auto written = previous->samplesWritten.load (std::memory_order_relaxed);
+    next->copyFrom (*previous, next->samplesWritten.load (std::memory_order_relaxed), written);
+    next->samplesWritten.store (written, std::memory_order_relaxed);
+
+    retired.store (previous, std::memory_order_release);
+    active.store (next, std::memory_order_release);
+    return true;
+}
+
+//==============================================================================
+void DelayMemoryManager::run()
+{
+    while (! threadShouldExit())
+    {
+        {
+            const juce::ScopedLock sl (workerLock);
+            reclaimRetired();
+
+            DelayMemoryLayout layout;
+            bool wanted = false;
+
+            {
+                const juce::ScopedLock rl (requestLock);
+                layout = requestedLayout;
+                wanted = hasRequest;
+            }
+
+            // A newer request overtook the one still waiting for the audio thread
+            if (wanted && published != nullptr && published->getLayout() != layout)
+            {
+                if (auto* unadopted = pending.exchange (nullptr, std::memory_order_acq_rel))
+                {
+                    jassert (unadopted == published);
+                    delete unadopted;
+                    published = nullptr;
+                }
+            }
+
+            // Only build once the audio thread is on current, so that is the one to copy
+            if (wanted && published == nullptr && current != nullptr)
+            {
+                {
+                    const juce::ScopedLock rl (requestLock);
+                    if (requestedLayout == layout)
+                        hasRequest = false;
+                }
+
+                if (layout != current->getLayout())
+                {
+                    if (auto next = build (layout, *current))
+                    {
+                        published = next.release();
+                        pending.store (published, std::memory_order_release);
+                    }
+                }
+            }
+        }
+
+        wait (10);
+    }
+}
+
+std::unique_ptr<DelayMemory> DelayMemoryManager::build (const DelayMemoryLayout& layout, DelayMemory& source)
+{
+    auto next = std::make_unique<DelayMemory> (layout);
+    const int sourceSize = source.getLayout().size;
+
+    // Copies what has settled, oldest first, skipping anything the audio
+    // thread might be about to overwrite
+    auto copySettled = [&] (juce::int64 first, juce::int64 last)
+    {
+        for (auto start = first; start < last; start += chunkSamples)
+        {
+            const auto oldestSafe = source.getSamplesWritten() - sourceSize + headroomSamples;
+            const auto chunkStart = juce::jmax (start, oldestSafe);
+            const auto chunkEnd = juce::jmin (last, start + chunkSamples);
+
+            if (chunkStart < chunkEnd)
+                next->copyFrom (source, chunkStart, chunkEnd);
+
+            if (threadShouldExit())
+                return false;
+        }
+
+        return true;
+    };
+
+    auto copied = juce::jmax (juce::int64 (0), source.getSamplesWritten() - settleSamples);
+    const auto oldest = juce::jmax (juce::int64 (0), copied - juce::jmax (0, juce::jmin (layout.size, sourceSize - headroomSamples)));
+
+    if (! copySettled (oldest, copied))
+        return nullptr;
+
+    // The audio thread kept writing meanwhile; each pass is shorter than the last
+    for (;;)
+    {
+        const auto settled = source.getSamplesWritten() - settleSamples;
+
+        if (settled - copied <= handOverSamples)
+            break;
+
+        if (! copySettled (juce::jmax (copied, settled - layout.size), settled))
+            return nullptr;
+
+        copied = settled;
+    }
+
+    next->samplesWritten.store (copied, std::memory_order_relaxed);
+    return next;
+}
+
+// Only when the audio thread can't be mid-swap: stopped, or never started
+void DelayMemoryManager::settle()
+{
+    if (auto* unadopted = pending.exchange (nullptr, std::memory_order_acq_rel))
+    {
+        jassert (unadopted == published);
+        delete unadopted;
+        published = nullptr;
+    }
+
+    reclaimRetired();
+    jassert (published == nullptr);
+}
+
+void DelayMemoryManager::reclaimRetired()
+{
+    if (auto* old = retired.exchange (nullptr, std::memory_order_acquire))
+    {
+        jassert (old == current.get());
+        juce::ignoreUnused (old);
+
+        current.reset (published);
+        published = nullptr;
+    }
+}
+
+} // namespace ghostline
@@ -0,0 +1,212 @@
+/*
+  ==============================================================================
+
+    DelayMemory.h
+    One generation of echo storage, and the manager that builds the next one
+    on a background thread, carries the history across and hands it to the
+    audio thread with a single atomic pointer swap.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "MirroredDelayBuffer.h"
+#include "CompactDelayBuffer.h"
+
+namespace ghostline
+{
+
+//==============================================================================
+struct DelayMemoryLayout
+{
+    int numChannels = 0;
+    int size = 0;
+    DelayStorageFormat format = DelayStorageFormat::float32;
+
+    bool operator== (const DelayMemoryLayout& other) const noexcept
+    {
+        return numChannels == other.numChannels && size == other.size && format == other.format;
+    }
+
+    bool operator!= (const DelayMemoryLayout& other) const noexcept   { return ! operator== (other); }
+};
+
+//==============================================================================
+/**
+    The delay buffers for every channel in one layout, float, double or
+    compact, plus a running count of samples written. Every channel shares the write
+    position derived from that count, so another thread can tell from the
+    count alone which samples are settled and safe to copy while the audio
+    thread keeps writing.
+*/
+class DelayMemory
+{
+public:
+    /** Allocates and clears. Not realtime-safe. */
+    explicit DelayMemory (const DelayMemoryLayout& newLayout);
+
+    const DelayMemoryLayout& getLayout() const noexcept    { return layout; }
+
+    bool usesCompactStorage() const noexcept
+    {
+        return layout.format == DelayStorageFormat::int16 || layout.format == DelayStorageFormat::blockFloat16;
+    }
+
+    /** Whether a loop running in SampleType can use this memory: the compact
+        formats serve either precision, a mirrored buffer only its own.
+    */
+    template <typename SampleType>
+    bool suitsPrecision() const noexcept
+    {
+        return usesCompactStorage() || layout.format == (std::is_same_v<SampleType, double> ? DelayStorageFormat::float64
+                                                                                             : DelayStorageFormat::float32);
+    }
+
+    /** The mirrored buffer of one precision; empty unless the layout uses it. */
+    template <typename SampleType>
+    BasicMirroredDelayBuffer<SampleType>& getMirroredBuffer() noexcept
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doubleBuffer;
+        else
+            return floatBuffer;
+    }
+
+    CompactDelayBuffer& getCompactBuffer() noexcept        { return compactBuffer; }
+
+    void clear() noexcept;
+
+    /** Samples written per channel so far. Any thread. */
+    juce::int64 getSamplesWritten() const noexcept         { return samplesWritten.load (std::memory_order_acquire); }
+
+    /** Where sample number n is stored in each channel. */
+    int getPosition (juce::int64 n) const noexcept         { return static_cast<int> (n % layout.size); }
+
+    int getWritePosition() const noexcept                  { return getPosition (samplesWritten.load (std::memory_order_relaxed)); }
+
+    /** Audio thread, once per block after every channel has written numSamples. */
+    void advance (int numSamples) noexcept
+    {
+        samplesWritten.store (samplesWritten.load (std::memory_order_relaxed) + numSamples, std::memory_order_release);
+    }
+
+    /** Calls callback with a mirrored buffer's History or a compact codec for one channel. */
+    template <typename Callback>
+    void visitChannel (int channel, Callback&& callback) noexcept
+    {
+        if (usesCompactStorage())
+            compactBuffer.visitChannel (channel, callback);
+        else if (layout.format == DelayStorageFormat::float64)
+            callback (doubleBuffer.getHistory (channel));
+        else
+            callback (floatBuffer.getHistory (channel));
+    }
+
+    /** As visitChannel(), for a loop running in SampleType: only the
+        histories suitsPrecision() allows are instantiated.
+    */
+    template <typename SampleType, typename Callback>
+    void visitChannelFor (int channel, Callback&& callback) noexcept
+    {
+        jassert (suitsPrecision<SampleType>());
+
+        if (usesCompactStorage())
+            compactBuffer.visitChannel (channel, callback);
+        else
+            callback (getMirroredBuffer<SampleType>().getHistory (channel));
+    }
+
+    /** Largest absolute value in numSamples of one channel, starting at
+        position and wrapping round the end.
+    */
+    float getMagnitude (int channel, int position, int numSamples) noexcept;
+
+    /** Copies the samples numbered [first, last) from source to the same
+        sample numbers here, converting the format on the way. Only the
+        newest that fit are copied; channels beyond either layout are skipped.
+    */
+    void copyFrom (DelayMemory& source, juce::int64 first, juce::int64 last) noexcept;
+
+private:
+    const DelayMemoryLayout layout;
+
+    MirroredDelayBuffer floatBuffer;
+    BasicMirroredDelayBuffer<double> doubleBuffer;
+    CompactDelayBuffer compactBuffer;
+
+    std::atomic<juce::int64> samplesWritten { 0 };
+
+    // Only the manager moves the count other than by advance(), on a
+    // memory the audio thread isn't writing
+    friend class DelayMemoryManager;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DelayMemory)
+};
+
+//==============================================================================
+/**
+    Owns the live DelayMemory and replaces it without stopping the audio.
+
+    requestLayout() (message thread) wakes a worker, which allocates the new
+    memory and copies the newest history into it oldest-first, keeping a
+    reserve away from the write head so the audio thread never writes what it
+    reads. It then catches up in passes until it trails the writer by no more
+    than a block, and publishes the result through an atomic pointer. At the
+    top of its next block the audio thread copies the last few samples across,
+    swaps, and hands the old memory back through a second atomic pointer for
+    the worker to free. The audio thread never allocates, frees or locks.
+
+    prepare() is for prepareToPlay, while the audio thread is stopped: it
+    cancels anything in flight and builds or clears the memory directly.
+*/
+class DelayMemoryManager  : private juce::Thread
+{
+public:
+    DelayMemoryManager();
+    ~DelayMemoryManager() override;
+
+    /** Builds (or, for an unchanged layout, clears) the live memory. Not realtime-safe. */
+    void prepare (const DelayMemoryLayout& layout);
+
+    /** Asks the worker to move the history to a new layout. Message thread. */
+    void requestLayout (const DelayMemoryLayout& layout);
+
+    /** Audio thread, at the top of each block: takes over a published memory
+        if there is one. Returns true when the memory changed.
+    */
+    bool adoptPending() noexcept;
+
+    /** The memory the audio thread is using. nullptr before prepare(). Any
+        thread may test it against nullptr; only the audio thread may use
+        what it points to, which the worker frees once it is swapped out.
+    */
+    DelayMemory* getActive() const noexcept                { return active.load (std::memory_order_acquire); }
+
+private:
+    void run() override;
+    void settle();
+    void reclaimRetired();
+    std::unique_ptr<DelayMemory> build (const DelayMemoryLayout& layout, DelayMemory& source);
+
+    // Worker/prepare side
+    juce::CriticalSection workerLock;
+    std::unique_ptr<DelayMemory> current;
+    DelayMemory* published = nullptr;
+
+    juce::CriticalSection requestLock;
+    DelayMemoryLayout requestedLayout;
+    bool hasRequest = false;
+
+    // Handed between the threads
+    std::atomic<DelayMemory*> pending { nullptr };
+    std::atomic<DelayMemory*> retired { nullptr };
+
+    // Written by prepare() and the audio thread, read by the message thread too
+    std::atomic<DelayMemory*> active { nullptr };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DelayMemoryManager)
+};
+
+} // namespace ghostline
@@ -0,0 +1,366 @@
+/*
+  ==============================================================================
+
+    Diffuser.cpp
+
+  ==============================================================================
+*/
+
+#include "Diffuser.h"
+
+namespace ghostline
+{
+
+namespace
+{
+    // Line lengths at full size, in ms; no two share a factor worth hearing
+    constexpr std::array<double, Diffuser::numLines> lineMilliseconds { 39.1, 45.7, 53.3, 59.9, 66.1, 73.9, 81.3, 89.7 };
+    constexpr std::array<double, Diffuser::numAllpasses> allpassMilliseconds { 1.9, 2.9, 4.3, 6.1 };
+
+    // Where the input goes in and the wash comes out; orthogonal to the
+    // Hadamard rows that would otherwise pass straight through
+    constexpr std::array<float, Diffuser::numLines> inputSigns  { 1.0f,  1.0f, -1.0f, -1.0f,  1.0f, -1.0f, -1.0f,  1.0f };
+    constexpr std::array<float, Diffuser::numLines> outputSigns { 1.0f, -1.0f,  1.0f, -1.0f, -1.0f,  1.0f, -1.0f,  1.0f };
+
+    constexpr float maxAllpassCoefficient = 0.62f;
+    constexpr float maxStepPerBlock = 0.005f;
+
+    // Each channel's lengths are stretched a little, so a stereo wash is wide
+    constexpr double channelStretch = 0.011;
+
+    const float inverseSqrtLines = 1.0f / std::sqrt (static_cast<float> (Diffuser::numLines));
+
+    // Each allpass's share of the smear's latency, whatever the size
+    const std::array<float, Diffuser::numAllpasses> allpassShares = []
+    {
+        double total = 0.0;
+
+        for (const double milliseconds : allpassMilliseconds)
+            total += milliseconds;
+
+        std::array<float, Diffuser::numAllpasses> shares {};
+
+        for (size_t i = 0; i < shares.size(); ++i)
+            shares[i] = static_cast<float> (allpassMilliseconds[i] / total);
+
+        return shares;
+    }();
+
+    int maskFor (double seconds, double sampleRate) noexcept
+    {
+        int size = 1;
+
+        while (size < static_cast<int> (std::ceil (seconds * sampleRate)) + 1)
+            size <<= 1;
+
+        return size - 1;
+    }
+
+    // Linear read distance samples back from position, which may be under one
+    inline float readBetween (const float* history, int mask, int position, float distance) noexcept
+    {
+        const int whole = static_cast<int> (distance);
+        const float a = history[(position - whole) & mask];
+        const float b = history[(position - whole - 1) & mask];
+        return a + (distance - static_cast<float> (whole)) * (b - a);
+    }
+
+    // Unnormalised fast Walsh-Hadamard transform: three butterfly passes
+    inline void hadamard (float* v) noexcept
+    {
+        for (int h = 1; h < Diffuser::numLines; h <<= 1)
+            for (int i = 0; i < Diffuser::numLines; i += h << 1)
+                for (int j = i; j < i + h; ++j)
+                {
+                    const float a = v[j], b = v[j + h];
+                    v[j] = a + b;
+                    v[j + h] = a - b;
+                }
+    }
+}
+
+static_assert (Diffuser::numLines == 8, "The Hadamard mix and the sign patterns are for eight lines");
+
+//==============================================================================
+void Diffuser::prepare (double sampleRate, int numChannels)
+{
+    currentSampleRate = sampleRate;
+    frameMask = maskFor (maxLineSeconds, sampleRate);
+    smearMask = maskFor (maxSmearSeconds, sampleRate);
+
+    channels.resize (static_cast<size_t> (juce::jmax (1, numChannels)));
+
+    for (auto& state : channels)
+    {
+        state.frames.assign (static_cast<size_t> ((frameMask + 1) * numLines), 0.0f);
+        state.direct.assign (static_cast<size_t> (smearMask + 1), 0.0f);
+
+        for (auto& history : state.allpasses)
+            history.assign (static_cast<size_t> (smearMask + 1), 0.0f);
+    }
+
+    amount = targetAmount;
+    size = targetSize;
+    enabled = amount > 0.0f;
+    updateLengths();
+    reset();
+}
+
+void Diffuser::reset() noexcept
+{
+    clear();
+    skip();
+}
+
+void Diffuser::skip() noexcept
+{
+    // Nothing is playing through it: land on the lengths instead of gliding there
+    const bool smearing = targetAmount > 0.0f || amount > 0.0f;
+
+    for (auto& state : channels)
+    {
+        state.lineLengths = state.targetLineLengths;
+        state.latency = state.sliceEndLatency = smearing ? state.targetLatency : 0.0f;
+        state.washAmount = state.smearAmount = amount;
+        state.lineSteps = {};
+        state.latencyStep = state.amountStep = 0.0f;
+        state.sliceRemaining = 0;
+    }
+
+    enabled = smearing;
+}
+
+void Diffuser::clear() noexcept
+{
+    for (auto& state : channels)
+    {
+        std::fill (state.frames.begin(), state.frames.end(), 0.0f);
+        std::fill (state.direct.begin(), state.direct.end(), 0.0f);
+
+        for (auto& history : state.allpasses)
+            std::fill (history.begin(), history.end(), 0.0f);
+
+        state.framePosition = state.smearPosition = 0;
+    }
+}
+
+void Diffuser::setParameters (float newAmount, float newSize) noexcept
+{
+    targetAmount = juce::jlimit (0.0f, 1.0f, newAmount);
+    targetSize = juce::jlimit (0.0f, 1.0f, newSize);
+
+    const float previousSize = size;
+    amount += juce::jlimit (-maxStepPerBlock, maxStepPerBlock, targetAmount - amount);
+    size += juce::jlimit (-maxStepPerBlock, maxStepPerBlock, targetSize - size);
+
+    if (size != previousSize)
+        updateLengths();
+
+    if (! enabled && amount > 0.0f)
+    {
+        // Whatever the histories held is long stale; start empty, with the
+        // lines where SIZE puts them and the smear gliding in from no latency
+        clear();
+
+        for (auto& state : channels)
+        {
+            state.lineLengths = state.targetLineLengths;
+            state.latency = state.sliceEndLatency = 0.0f;
+            state.washAmount = state.smearAmount = 0.0f;
+        }
+    }
+
+    // Off once the crossfade is all plain delay and that has glided out too
+    enabled = amount > 0.0f;
+
+    for (const auto& state : channels)
+        enabled = enabled || state.latency > 0.0f;
+}
+
+void Diffuser::updateLengths() noexcept
+{
+    const double lineScale = 0.15 + 0.85 * size;
+    const double allpassScale = 0.3 + 1.4 * size;
+    decaySeconds = 0.2 + 2.8 * size;
+
+    double allpassSeconds = 0.0;
+
+    for (const double milliseconds : allpassMilliseconds)
+        allpassSeconds += milliseconds * 0.001 * allpassScale;
+
+    for (size_t c = 0; c < channels.size(); ++c)
+    {
+        auto& state = channels[c];
+        const double stretch = 1.0 + channelStretch * static_cast<double> (c % numLines);
+        double meanSquaredGain = 0.0;
+
+        for (size_t i = 0; i < numLines; ++i)
+        {
+            // Whole samples, so a settled line reads without smoothing; one short
+            // of the history, for the read between samples while it glides
+            const double length = juce::jlimit (1.0, static_cast<double> (frameMask - 1),
+                                                std::round (lineMilliseconds[i] * 0.001 * lineScale * stretch * currentSampleRate));
+            state.targetLineLengths[i] = static_cast<float> (length);
+
+            // Every line loses 60 dB over decaySeconds, however long it is
+            const double gain = std::pow (10.0, -3.0 * length / (decaySeconds * currentSampleRate));
+            state.lineGains[i] = static_cast<float> (gain) * inverseSqrtLines;
+            meanSquaredGain += gain * gain / numLines;
+        }
+
+        // A long decay piles up energy; hold the wash near the input's level
+        state.washGain = static_cast<float> (std::sqrt (1.0 - meanSquaredGain));
+
+        state.targetLatency = static_cast<float> (juce::jmin (std::round (allpassSeconds * stretch * currentSampleRate),
+                                                              static_cast<double> (smearMask - 1)));
+    }
+}
+
+void Diffuser::beginSlice (int channel, int numSamples, float maxLatency) noexcept
+{
+    if (! juce::isPositiveAndBelow (channel, static_cast<int> (channels.size())) || numSamples <= 0)
+        return;
+
+    auto& state = channels[static_cast<size_t> (channel)];
+    const float limit = juce::jmax (0.0f, std::floor (maxLatency));
+    const float reach = maxGlidePerSample * static_cast<float> (numSamples);
+    const float perSample = 1.0f / static_cast<float> (numSamples);
+
+    // A delay that has come in closer than the smear pulls it in at once; a
+    // glide would leave the reads on top of the write until it got there
+    state.latency = juce::jmin (state.latency, limit);
+
+    const float wantedLatency = targetAmount > 0.0f || amount > 0.0f ? juce::jmin (state.targetLatency, limit) : 0.0f;
+    state.sliceEndLatency = state.latency + juce::jlimit (-reach, reach, wantedLatency - state.latency);
+    state.latencyStep = (state.sliceEndLatency - state.latency) * perSample;
+    state.amountStep = (amount - state.washAmount) * perSample;
+    state.sliceRemaining = numSamples;
+
+    for (size_t i = 0; i < numLines; ++i)
+        state.lineSteps[i] = juce::jlimit (-reach, reach, state.targetLineLengths[i] - state.lineLengths[i]) * perSample;
+}
+
+float Diffuser::getLatencyInSamples (int channel) const noexcept
+{
+    if (! juce::isPositiveAndBelow (channel, static_cast<int> (channels.size())))
+        return 0.0f;
+
+    return channels[static_cast<size_t> (channel)].latency;
+}
+
+float Diffuser::getLatencyStep (int channel) const noexcept
+{
+    if (! juce::isPositiveAndBelow (channel, static_cast<int> (channels.size())))
+        return 0.0f;
+
+    return channels[static_cast<size_t> (channel)].latencyStep;
+}
+
+float Diffuser::getPeakLatencyInSamples (int channel) const noexcept
+{
+    if (! juce::isPositiveAndBelow (channel, static_cast<int> (channels.size())))
+        return 0.0f;
+
+    const auto& state = channels[static_cast<size_t> (channel)];
+    return juce::jmax (state.latency, state.sliceEndLatency);
+}
+
+//==============================================================================
+template <typename SampleType>
+void Diffuser::wash (int channel, SampleType* samples, int numSamples) noexcept
+{
+    jassert (juce::isPositiveAndBelow (channel, static_cast<int> (channels.size())));
+
+    auto& state = channels[static_cast<size_t> (channel)];
+    float* frames = state.frames.data();
+    auto lengths = state.lineLengths;
+    int position = state.framePosition;
+    float mix = state.washAmount;
+
+    for (int n = 0; n < numSamples; ++n)
+    {
+        const float input = static_cast<float> (samples[n]);
+        float lines[numLines];
+
+        for (int i = 0; i < numLines; ++i)
+        {
+            // Line i of frame f is at f * numLines + i; read between two frames
+            const auto line = static_cast<size_t> (i);
+            const int whole = static_cast<int> (lengths[line]);
+            const float a = frames[((position - whole) & frameMask) * numLines + i];
+            const float b = frames[((position - whole - 1) & frameMask) * numLines + i];
+            lines[i] = a + (lengths[line] - static_cast<float> (whole)) * (b - a);
+            lengths[line] += state.lineSteps[line];
+        }
+
+        float washed = 0.0f;
+
+        for (int i = 0; i < numLines; ++i)
+            washed += outputSigns[static_cast<size_t> (i)] * lines[i];
+
+        hadamard (lines);
+
+        float* frame = frames + position * numLines;
+        const float injected = input * inverseSqrtLines;
+
+        for (int i = 0; i < numLines; ++i)
+            frame[i] = lines[i] * state.lineGains[static_cast<size_t> (i)] + injected * inputSigns[static_cast<size_t> (i)];
+
+        position = (position + 1) & frameMask;
+        samples[n] = static_cast<SampleType> (input + mix * (washed * state.washGain - input));
+        mix += state.amountStep;
+    }
+
+    state.washAmount = amount;
+    state.lineLengths = lengths;
+    state.framePosition = position;
+}
+
+template <typename SampleType>
+void Diffuser::smear (int channel, SampleType* samples, int numSamples) noexcept
+{
+    jassert (juce::isPositiveAndBelow (channel, static_cast<int> (channels.size())));
+
+    auto& state = channels[static_cast<size_t> (channel)];
+    const float g = maxAllpassCoefficient;
+    float* direct = state.direct.data();
+    int position = state.smearPosition;
+
+    for (int n = 0; n < numSamples; ++n)
+    {
+        // The same line through the slice the reads were given
+        const float latency = state.latency + state.latencyStep * static_cast<float> (n);
+        const float mix = state.smearAmount + state.amountStep * static_cast<float> (n);
+        float x = static_cast<float> (samples[n]);
+
+        direct[position] = x;
+        const float plain = readBetween (direct, smearMask, position, latency);
+
+        for (size_t i = 0; i < numAllpasses; ++i)
+        {
+            // Schroeder allpass: v = x + g v[n-M], y = v[n-M] - g v
+            float* history = state.allpasses[i].data();
+            const float delayed = readBetween (history, smearMask, position, juce::jmax (1.0f, latency * allpassShares[i]));
+            const float v = x + g * delayed;
+            history[position] = v;
+            x = delayed - g * v;
+        }
+
+        position = (position + 1) & smearMask;
+        samples[n] = static_cast<SampleType> (plain + mix * (x - plain));
+    }
+
+    // Land on the slice's end exactly, so a glide out reaches 0
+    state.sliceRemaining -= numSamples;
+    const bool sliceDone = state.sliceRemaining <= 0;
+    state.latency = sliceDone ? state.sliceEndLatency : state.latency + state.latencyStep * static_cast<float> (numSamples);
+    state.smearAmount = sliceDone ? amount : state.smearAmount + state.amountStep * static_cast<float> (numSamples);
+    state.smearPosition = position;
+}
+
+template void Diffuser::wash (int, float*, int) noexcept;
+template void Diffuser::wash (int, double*, int) noexcept;
+template void Diffuser::smear (int, float*, int) noexcept;
+template void Diffuser::smear (int, double*, int) noexcept;
+
+} // namespace ghostline
@@ -0,0 +1,140 @@
+/*
+  ==============================================================================
+
+    Diffuser.h
+    Smears the echoes: a feedback delay network washes the input on its way
+    into the loop, and an allpass cascade inside the loop blurs each repeat
+    a little more than the last.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace ghostline
+{
+
+//==============================================================================
+/**
+    Two stages, both per channel:
+
+        wash    An eight-line feedback delay network on the input before it
+                is recorded, crossfaded in by DIFFUSION. The lines share one
+                history of eight-sample frames, so each sample writes one
+                frame and the lines move together as one vector. They are
+                mixed through a Hadamard matrix, which needs only adds and
+                subtracts; its 1/sqrt (8) is folded into the decay gains.
+        smear   Four Schroeder allpasses on the record signal, inside the
+                loop, crossfaded in by DIFFUSION against a plain delay of
+                the same length. Either side has unity gain at every
+                frequency, so the loop gain stays at FEEDBACK. They hold
+                the record back by their combined length, so the reads move
+                that much closer, as for the oversampling filters.
+
+    SIZE sets the line and allpass lengths, and with them the decay time.
+    Amount glides a little each block and ramps there across it; every
+    length glides a little each sample and is read between samples, so
+    nothing steps. The combined allpass length is the smear's latency:
+    beginSlice() keeps it short enough for the closest read, and it glides
+    in from 0 when the diffuser comes on, into empty histories, and back
+    out before it goes off. Both stages run in float in either precision,
+    as the saturation curves do.
+*/
+class Diffuser
+{
+public:
+    static constexpr int numLines = 8;
+    static constexpr int numAllpasses = 4;
+
+    static constexpr double maxLineSeconds = 0.1;
+    static constexpr double maxSmearSeconds = 0.03;
+
+    /** The most any length moves per sample: a 2% bend while it glides. */
+    static constexpr float maxGlidePerSample = 0.02f;
+
+    /** Allocates the line and allpass histories. Not realtime-safe. */
+    void prepare (double sampleRate, int numChannels);
+    void reset() noexcept;
+
+    /** For stretches where nothing plays through it: the lengths land where
+        they are heading at once. The next beginSlice() still applies its limit.
+    */
+    void skip() noexcept;
+
+    /** Both in [0, 1]; call once per block. */
+    void setParameters (float amount, float size) noexcept;
+
+    /** True from the moment DIFFUSION leaves 0 until the smear has glided back out. */
+    bool isEnabled() const noexcept            { return enabled; }
+
+    /** Sets where this channel's lengths glide to over the next numSamples,
+        before wash() and smear() run on them. The latency never goes above
+        maxLatency, so the closest read stays that far from the write.
+    */
+    void beginSlice (int channel, int numSamples, float maxLatency) noexcept;
+
+    /** The smear's latency on this channel at its next sample, and how much
+        it moves per sample until the end of the slice.
+    */
+    float getLatencyInSamples (int channel) const noexcept;
+    float getLatencyStep (int channel) const noexcept;
+
+    /** The most latency this channel reaches during the slice. */
+    float getPeakLatencyInSamples (int channel) const noexcept;
+
+    /** How long the wash takes to fall 120 dB. */
+    double getTailSeconds() const noexcept     { return isEnabled() ? 2.0 * decaySeconds : 0.0; }
+
+    /** Washes the input in place, before it reaches the loop. Instantiated
+        for float and double, as is smear().
+    */
+    template <typename SampleType>
+    void wash (int channel, SampleType* samples, int numSamples) noexcept;
+
+    /** Runs the record signal through the allpasses, in place. */
+    template <typename SampleType>
+    void smear (int channel, SampleType* samples, int numSamples) noexcept;
+
+private:
+    struct ChannelState
+    {
+        // Frame n holds sample n of every line, so a write is one aligned store
+        std::vector<float> frames;
+        int framePosition = 0;
+
+        // Where each length is, where SIZE puts it, and its step per sample this slice
+        std::array<float, numLines> lineLengths {}, targetLineLengths {}, lineSteps {};
+        std::array<float, numLines> lineGains {};
+        float washGain = 1.0f;
+
+        // The allpasses split the latency between them in fixed proportions;
+        // direct is the plain delay the smear is crossfaded against
+        std::array<std::vector<float>, numAllpasses> allpasses;
+        std::vector<float> direct;
+        float latency = 0.0f, targetLatency = 0.0f, latencyStep = 0.0f, sliceEndLatency = 0.0f;
+
+        // Each stage's crossfade ramps to the block's amount across the slice
+        float washAmount = 0.0f, smearAmount = 0.0f, amountStep = 0.0f;
+        int sliceRemaining = 0;
+        int smearPosition = 0;
+    };
+
+    // Empties the histories, leaving the lengths where they are
+    void clear() noexcept;
+    void updateLengths() noexcept;
+
+    double currentSampleRate = 44100.0;
+    int frameMask = 0, smearMask = 0;
+
+    float targetAmount = 0.0f, amount = 0.0f;
+    float targetSize = 0.5f, size = 0.5f;
+    bool enabled = false;
+
+    double decaySeconds = 0.0;
+
+    std::vector<ChannelState> channels;
+};
+
+} // namespace ghostline
@@ -0,0 +1,159 @@
+/*
+  ==============================================================================
+
+    FeedbackFilter.cpp
+
+  ==============================================================================
+*/
+
+#include "FeedbackFilter.h"
+
+namespace ghostline
+{
+
+namespace
+{
+    constexpr double dcBlockFrequency = 5.0;
+}
+
+//==============================================================================
+void FeedbackFilter::prepare (double sampleRate, int numChannels)
+{
+    currentSampleRate = sampleRate;
+    channels.resize (static_cast<size_t> (juce::jmax (1, numChannels)));
+
+    updateCoefficients();
+    reset();
+}
+
+void FeedbackFilter::reset() noexcept
+{
+    std::fill (channels.begin(), channels.end(), ChannelState {});
+}
+
+void FeedbackFilter::setParameters (float newHighPassHz, float newLowPassHz, float newTiltDecibels, bool dcBlock) noexcept
+{
+    dcBlockActive = dcBlock;
+
+    if (newHighPassHz == highPassHz && newLowPassHz == lowPassHz && newTiltDecibels == tiltDecibels)
+        return;
+
+    highPassHz = newHighPassHz;
+    lowPassHz = newLowPassHz;
+    tiltDecibels = juce::jlimit (-maxTiltDecibels, maxTiltDecibels, newTiltDecibels);
+    updateCoefficients();
+}
+
+FeedbackFilter::SvfCoefficients FeedbackFilter::makeSvf (double cutoff, double sampleRate) noexcept
+{
+    SvfCoefficients c;
+    const double g = std::tan (juce::MathConstants<double>::pi * cutoff / sampleRate);
+
+    c.k = juce::MathConstants<double>::sqrt2;   // Q = 1 / sqrt (2)
+    c.a1 = 1.0 / (1.0 + g * (g + c.k));
+    c.a2 = g * c.a1;
+    c.a3 = g * c.a2;
+    return c;
+}
+
+void FeedbackFilter::updateCoefficients() noexcept
+{
+    const double nyquistLimit = currentSampleRate * 0.45;
+
+    highPassActive = highPassHz > minHighPass;
+    lowPassActive = lowPassHz < maxLowPass && lowPassHz < nyquistLimit;
+    tiltActive = tiltDecibels != 0.0f;
+
+    highPass = makeSvf (juce::jmin (static_cast<double> (highPassHz), nyquistLimit), currentSampleRate);
+    lowPass = makeSvf (juce::jmin (static_cast<double> (lowPassHz), nyquistLimit), currentSampleRate);
+
+    // Only the side being cut moves; the other stays at unity
+    const double g = std::tan (juce::MathConstants<double>::pi * tiltPivot / currentSampleRate);
+    const double cut = juce::Decibels::decibelsToGain (-std::abs (static_cast<double> (tiltDecibels)));
+    tiltG = g / (1.0 + g);
+    tiltLowGain = tiltDecibels > 0.0f ? cut : 1.0;
+    tiltHighGain = tiltDecibels < 0.0f ? cut : 1.0;
+
+    dcPole = 1.0 - juce::MathConstants<double>::twoPi * dcBlockFrequency / currentSampleRate;
+}
+
+//==============================================================================
+template <typename SampleType>
+void FeedbackFilter::process (int channel, SampleType* samples, int numSamples) noexcept
+{
+    jassert (juce::isPositiveAndBelow (channel, static_cast<int> (channels.size())));
+
+    auto& state = channels[static_cast<size_t> (channel)];
+
+    // One tight pass per stage in use, each on the chunk while it is still in cache
+    auto runSvf = [samples, numSamples] (const SvfCoefficients& c, double (&s)[2], bool high)
+    {
+        const auto k = static_cast<SampleType> (c.k), a1 = static_cast<SampleType> (c.a1);
+        const auto a2 = static_cast<SampleType> (c.a2), a3 = static_cast<SampleType> (c.a3);
+        auto ic1 = static_cast<SampleType> (s[0]);
+        auto ic2 = static_cast<SampleType> (s[1]);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const SampleType v0 = samples[i];
+            const SampleType v3 = v0 - ic2;
+            const SampleType v1 = a1 * ic1 + a2 * v3;
+            const SampleType v2 = ic2 + a2 * ic1 + a3 * v3;
+            ic1 = SampleType (2) * v1 - ic1;
+            ic2 = SampleType (2) * v2 - ic2;
+
+            samples[i] = high ? v0 - k * v1 - v2 : v2;
+        }
+
+        s[0] = ic1;
+        s[1] = ic2;
+    };
+
+    if (highPassActive)
+        runSvf (highPass, state.highPass, true);
+
+    if (lowPassActive)
+        runSvf (lowPass, state.lowPass, false);
+
+    if (tiltActive)
+    {
+        const auto g = static_cast<SampleType> (tiltG);
+        const auto low = static_cast<SampleType> (tiltLowGain), high = static_cast<SampleType> (tiltHighGain);
+        auto s = static_cast<SampleType> (state.tilt);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            // One-pole TPT low-pass; the high band is what it leaves
+            const SampleType v = (samples[i] - s) * g;
+            const SampleType lowBand = v + s;
+            s = lowBand + v;
+
+            samples[i] = low * lowBand + high * (samples[i] - lowBand);
+        }
+
+        state.tilt = s;
+    }
+
+    if (dcBlockActive)
+    {
+        const auto pole = static_cast<SampleType> (dcPole);
+        auto x1 = static_cast<SampleType> (state.dcInput);
+        auto y1 = static_cast<SampleType> (state.dcOutput);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const SampleType x = samples[i];
+            y1 = x - x1 + pole * y1;
+            x1 = x;
+            samples[i] = y1;
+        }
+
+        state.dcInput = x1;
+        state.dcOutput = y1;
+    }
+}
+
+template void FeedbackFilter::process (int, float*, int) noexcept;
+template void FeedbackFilter::process (int, double*, int) noexcept;
+
+} // namespace ghostline
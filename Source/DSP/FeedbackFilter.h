@@ -0,0 +1,89 @@
+/*
+  ==============================================================================
+
+    FeedbackFilter.h
+    High-pass, low-pass, tilt and DC blocking on the record signal, so every
+    repeat comes back thinner and darker than the one before.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace ghostline
+{
+
+//==============================================================================
+/**
+    Runs inside the echo loop on input + FEEDBACK * echo before it is
+    written, so the nth repeat has been through the filters n times.
+
+        High-pass   12 dB/oct TPT state-variable filter, Butterworth Q;
+                    out of the loop at minHighPass
+        Low-pass    The same filter's low-pass output; out of the loop at
+                    maxLowPass or above 0.45 of the sample rate
+        Tilt        A first-order split at tiltPivot, one side turned down:
+                    positive tilt cuts below the pivot, negative above, so
+                    the loop gain never rises above FEEDBACK
+        DC blocker  First-order high-pass at 5 Hz, for saturated loops that
+                    pick up an offset
+
+    The TPT structures stay stable while their coefficients move, so a sweep
+    needs no smoothing. Coefficients are only worked out again when a
+    setting changes. Stages that are out of the loop cost nothing, and a
+    loop with all of them out runs without the filter at all.
+*/
+class FeedbackFilter
+{
+public:
+    static constexpr float minHighPass = 20.0f;
+    static constexpr float maxLowPass = 20000.0f;
+    static constexpr float maxTiltDecibels = 6.0f;
+    static constexpr double tiltPivot = 1000.0;
+
+    /** Sizes the per-channel state. Not realtime-safe. */
+    void prepare (double sampleRate, int numChannels);
+    void reset() noexcept;
+
+    /** Cutoffs in Hz; tilt in dB, from -maxTiltDecibels to maxTiltDecibels. */
+    void setParameters (float highPassHz, float lowPassHz, float tiltDecibels, bool dcBlock) noexcept;
+
+    bool isEnabled() const noexcept    { return highPassActive || lowPassActive || tiltActive || dcBlockActive; }
+
+    /** Filters one channel's record signal in place. Instantiated for float and double. */
+    template <typename SampleType>
+    void process (int channel, SampleType* samples, int numSamples) noexcept;
+
+private:
+    // Coefficients for one state-variable filter, as in Zavalishin's TPT form
+    struct SvfCoefficients
+    {
+        double k = 0.0, a1 = 1.0, a2 = 0.0, a3 = 0.0;
+    };
+
+    // State is held in double and run in the caller's precision, as in TapeModel
+    struct ChannelState
+    {
+        double highPass[2] = {}, lowPass[2] = {};
+        double tilt = 0.0;
+        double dcInput = 0.0, dcOutput = 0.0;
+    };
+
+    static SvfCoefficients makeSvf (double cutoff, double sampleRate) noexcept;
+    void updateCoefficients() noexcept;
+
+    double currentSampleRate = 44100.0;
+
+    float highPassHz = minHighPass, lowPassHz = maxLowPass, tiltDecibels = 0.0f;
+    bool highPassActive = false, lowPassActive = false, tiltActive = false, dcBlockActive = false;
+
+    SvfCoefficients highPass, lowPass;
+    double tiltG = 0.0, tiltLowGain = 1.0, tiltHighGain = 1.0;
+    double dcPole = 0.0;
+
+    std::vector<ChannelState> channels;
+};
+
+} // namespace ghostline
@@ -0,0 +1,150 @@
+/*
+  ==============================================================================
+
+    FeedbackSaturator.cpp
+
+  ==============================================================================
+*/
+
+#include "FeedbackSaturator.h"
+
+namespace ghostline
+{
+
+//==============================================================================
+SaturationTable::SaturationTable()
+{
+    for (int i = 0; i < size + 2; ++i)
+    {
+        const double x = (static_cast<double> (i) / size * 2.0 - 1.0) * range;
+
+        values[0][static_cast<size_t> (i)] = static_cast<float> (std::tanh (x));
+        values[1][static_cast<size_t> (i)] = static_cast<float> (x / std::sqrt (1.0 + x * x));
+        values[2][static_cast<size_t> (i)] = static_cast<float> (x / std::pow (1.0 + x * x * x * x, 0.25));
+    }
+}
+
+const SaturationTable& SaturationTable::getInstance()
+{
+    static const SaturationTable table;
+    return table;
+}
+
+void SaturationTable::process (SaturationCurve curve, float* samples, int numSamples) const noexcept
+{
+    jassert (curve != SaturationCurve::off);
+
+    const float* curveValues = values[static_cast<size_t> (static_cast<int> (curve) - 1)].data();
+    constexpr float scale = static_cast<float> (size) / (2.0f * range);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float position = (juce::jlimit (-range, range, samples[i]) + range) * scale;
+        const int index = static_cast<int> (position);
+        const float fraction = position - static_cast<float> (index);
+
+        samples[i] = curveValues[index] + fraction * (curveValues[index + 1] - curveValues[index]);
+    }
+}
+
+//==============================================================================
+void FeedbackSaturator::prepare (int maximumBlockSize, int numChannels)
+{
+    maxBlockSize = juce::jmax (1, maximumBlockSize);
+
+    for (int factor = 0; factor < maxOversamplingIndex; ++factor)
+    {
+        oversamplers[factor].resize (static_cast<size_t> (juce::jmax (1, numChannels)));
+
+        for (auto& oversampler : oversamplers[factor])
+        {
+            // Polyphase IIR: the cheapest half-band filters JUCE offers, and the
+            // lowest latency, which matters in a loop the signal goes round many times
+            oversampler = std::make_unique<juce::dsp::Oversampling<float>> (1, static_cast<size_t> (factor + 1),
+                                                                            juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR,
+                                                                            false);
+            oversampler->initProcessing (static_cast<size_t> (maxBlockSize));
+        }
+    }
+
+    floatScratch.wet.allocate (static_cast<size_t> (maxBlockSize), true);
+    floatScratch.feedback.allocate (static_cast<size_t> (maxBlockSize), true);
+    floatScratch.rightWet.allocate (static_cast<size_t> (maxBlockSize), true);
+    floatScratch.rightFeedback.allocate (static_cast<size_t> (maxBlockSize), true);
+    doubleScratch.wet.allocate (static_cast<size_t> (maxBlockSize), true);
+    doubleScratch.feedback.allocate (static_cast<size_t> (maxBlockSize), true);
+    doubleScratch.rightWet.allocate (static_cast<size_t> (maxBlockSize), true);
+    doubleScratch.rightFeedback.allocate (static_cast<size_t> (maxBlockSize), true);
+}
+
+void FeedbackSaturator::reset() noexcept
+{
+    for (auto& factor : oversamplers)
+        for (auto& oversampler : factor)
+            if (oversampler != nullptr)
+                oversampler->reset();
+}
+
+void FeedbackSaturator::setOversampling (int factorIndex) noexcept
+{
+    factorIndex = juce::jlimit (0, maxOversamplingIndex, factorIndex);
+
+    if (factorIndex == oversamplingIndex)
+        return;
+
+    // Don't let the new filters start from whatever they held when last used
+    if (factorIndex > 0)
+        for (auto& oversampler : oversamplers[factorIndex - 1])
+            if (oversampler != nullptr)
+                oversampler->reset();
+
+    oversamplingIndex = factorIndex;
+}
+
+float FeedbackSaturator::getLatencyInSamples (int factorIndex) const noexcept
+{
+    if (factorIndex <= 0 || oversamplers[factorIndex - 1].empty())
+        return 0.0f;
+
+    return oversamplers[factorIndex - 1][0]->getLatencyInSamples();
+}
+
+void FeedbackSaturator::saturate (int channel, float* samples, int numSamples) noexcept
+{
+    if (curve == SaturationCurve::off)
+        return;
+
+    auto* oversampler = oversamplingIndex > 0 ? oversamplers[oversamplingIndex - 1][static_cast<size_t> (channel)].get() : nullptr;
+
+    if (oversampler == nullptr)
+    {
+        table.process (curve, samples, numSamples);
+        return;
+    }
+
+    float* channels[] = { samples };
+    juce::dsp::AudioBlock<float> block (channels, 1, static_cast<size_t> (numSamples));
+
+    auto oversampled = oversampler->processSamplesUp (block);
+    table.process (curve, oversampled.getChannelPointer (0), static_cast<int> (oversampled.getNumSamples()));
+    oversampler->processSamplesDown (block);
+}
+
+void FeedbackSaturator::saturate (int channel, double* samples, int numSamples) noexcept
+{
+    if (curve == SaturationCurve::off)
+        return;
+
+    // The float scratch is idle while the loop runs in double
+    float* converted = floatScratch.feedback.get();
+
+    for (int i = 0; i < numSamples; ++i)
+        converted[i] = static_cast<float> (samples[i]);
+
+    saturate (channel, converted, numSamples);
+
+    for (int i = 0; i < numSamples; ++i)
+        samples[i] = static_cast<double> (converted[i]);
+}
+
+} // namespace ghostline
@@ -0,0 +1,270 @@
+/*
+  ==============================================================================
+
+    FeedbackSaturator.h
+    Oversampled record-head saturation for the echo loop. Curves come from
+    process-wide lookup tables; the oversampling filters are built up front
+    so the factor can change while playing.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DelayKernels.h"
+#include "StereoMatrix.h"
+
+namespace ghostline
+{
+
+//==============================================================================
+enum class SaturationCurve
+{
+    off = 0,
+    tanh,       // Smooth, symmetric
+    tape,       // x / sqrt (1 + x^2): starts compressing early and never quite flattens
+    diode       // x / (1 + x^4)^(1/4): clean until close to full scale, then a firm knee
+};
+
+/**
+    Every curve sampled across [-range, range], built once for the process.
+    All of them have unity slope at 0 and approach +-1, and all are odd, so a
+    loop running them with OVERDRIVE taking feedback above 1 settles at a
+    bounded level with no DC creeping in.
+*/
+class SaturationTable
+{
+public:
+    static constexpr int size = 4096;
+    static constexpr float range = 8.0f;
+    static constexpr int numCurves = 3;
+
+    static const SaturationTable& getInstance();
+
+    /** Shapes numSamples values in place. Inputs beyond +-range are clamped. */
+    void process (SaturationCurve curve, float* samples, int numSamples) const noexcept;
+
+private:
+    SaturationTable();
+
+    // One guard point for the interpolation partner at +range
+    std::array<std::array<float, size + 2>, numCurves> values;
+};
+
+//==============================================================================
+/**
+    Runs the echo loop with the record signal, input + FEEDBACK * echo,
+    passed through an oversampled saturation curve before it is written.
+
+    The oversampler needs whole blocks, so the loop works in chunks no longer
+    than the shortest read distance: every read in a chunk then comes from
+    samples written before it. The filters' latency is taken off the read
+    distance, so echoes stay on time and the plugin itself reports no latency.
+
+    With the curve off the same chunked loop runs unsaturated, for stages
+    such as the tape colour and the loop filters that have to sit inside it.
+    processStereo() runs the two sides of a stereo pair through it together,
+    so the echo fed back can cross from one side to the other.
+*/
+class FeedbackSaturator
+{
+public:
+    /** Factor index: 0 = 1x, 1 = 2x, 2 = 4x, 3 = 8x. */
+    static constexpr int maxOversamplingIndex = 3;
+
+    FeedbackSaturator() = default;
+
+    /** Builds the filters for every factor and channel, and the scratch buffers. Not realtime-safe. */
+    void prepare (int maximumBlockSize, int numChannels);
+    void reset() noexcept;
+
+    void setCurve (SaturationCurve newCurve) noexcept     { curve = newCurve; }
+    void setOversampling (int factorIndex) noexcept;
+
+    bool isEnabled() const noexcept                       { return curve != SaturationCurve::off; }
+
+    /** Filter delay at the base rate, for the active factor or any other.
+        Nothing is oversampled while the curve is off, so there is none then. */
+    float getLatencyInSamples() const noexcept            { return isEnabled() ? getLatencyInSamples (oversamplingIndex) : 0.0f; }
+    float getLatencyInSamples (int factorIndex) const noexcept;
+
+    /** Runs one channel of the loop. read (chunk, wet, feedback) fills the
+        echo heard at the output and the echo fed back, for chunk.numSamples
+        samples starting at *chunk.writePosition, without writing anything.
+        shape (record, numSamples) then gets the record signal in place,
+        ahead of the curve, for linear stages such as the loop filters.
+        shortestDistance is the closest any read in the block gets to the
+        write head, after latency compensation. The loop runs in the
+        context's precision.
+    */
+    template <typename History, typename SampleType, typename Reader, typename Shaper>
+    void process (int channel, const History& history, const BasicDelayKernelContext<SampleType>& c,
+                  float shortestDistance, Reader&& read, Shaper&& shape) noexcept
+    {
+        jassert (juce::isPositiveAndBelow (channel, static_cast<int> (oversamplers[0].size())));
+
+        const int chunkLimit = juce::jmin (maxBlockSize, juce::jmax (1, static_cast<int> (shortestDistance) - interpolationMargin));
+
+        auto& scratch = getScratch<SampleType>();
+        SampleType* wet = scratch.wet.get();
+        SampleType* feedback = scratch.feedback.get();
+
+        for (int start = 0; start < c.numSamples; start += chunkLimit)
+        {
+            auto chunk = c;
+            chunk.channelData = c.channelData + start;
+            chunk.delaySamples = c.delaySamples + start;
+            chunk.numSamples = juce::jmin (chunkLimit, c.numSamples - start);
+
+            read (chunk, wet, feedback);
+
+            // Build the record signal in place of the feedback echo, then hand the echo out
+            juce::FloatVectorOperations::multiply (feedback, c.feedback, chunk.numSamples);
+            juce::FloatVectorOperations::add (feedback, chunk.channelData, chunk.numSamples);
+            juce::FloatVectorOperations::copy (chunk.channelData, wet, chunk.numSamples);
+
+            shape (feedback, chunk.numSamples);
+            saturate (channel, feedback, chunk.numSamples);
+
+            int writePos = *c.writePosition;
+            for (int i = 0; i < chunk.numSamples; ++i)
+            {
+                history.write (writePos, static_cast<decltype (history.read (0))> (feedback[i]));
+                if (++writePos == history.size)
+                    writePos = 0;
+            }
+
+            *c.writePosition = writePos;
+        }
+    }
+
+    /** Runs both sides of a stereo pair as one loop, channels 0 and 1, chunk
+        by chunk. Each chunk reads both echoes, sends the fed-back pair
+        through the matrix and only then records either side, so every read
+        still comes from samples written before it. read (channel, history,
+        chunk, wet, feedback) and shape (channel, record, numSamples) are as
+        for process(), with the side they are working on; shortestDistance
+        covers both sides.
+    */
+    template <typename LeftHistory, typename RightHistory, typename SampleType, typename Reader, typename Shaper>
+    void processStereo (const LeftHistory& left, const RightHistory& right, const BasicDelayKernelContext<SampleType> (&c)[2],
+                        const StereoMatrix& matrix, float shortestDistance, Reader&& read, Shaper&& shape) noexcept
+    {
+        jassert (oversamplers[0].size() >= 2 && c[0].numSamples == c[1].numSamples);
+
+        const int chunkLimit = juce::jmin (maxBlockSize, juce::jmax (1, static_cast<int> (shortestDistance) - interpolationMargin));
+
+        auto& scratch = getScratch<SampleType>();
+        SampleType* wet[] = { scratch.wet.get(), scratch.rightWet.get() };
+        SampleType* feedback[] = { scratch.feedback.get(), scratch.rightFeedback.get() };
+
+        matrix.routeInput (c[0].channelData, c[1].channelData, c[0].numSamples);
+
+        for (int start = 0; start < c[0].numSamples; start += chunkLimit)
+        {
+            BasicDelayKernelContext<SampleType> chunk[] = { c[0], c[1] };
+            const int numSamples = juce::jmin (chunkLimit, c[0].numSamples - start);
+
+            for (auto& side : chunk)
+            {
+                side.channelData += start;
+                side.delaySamples += start;
+                side.numSamples = numSamples;
+            }
+
+            read (0, left, chunk[0], wet[0], feedback[0]);
+            read (1, right, chunk[1], wet[1], feedback[1]);
+            matrix.mix (feedback[0], feedback[1], numSamples);
+
+            for (int channel = 0; channel < 2; ++channel)
+            {
+                juce::FloatVectorOperations::multiply (feedback[channel], c[channel].feedback, numSamples);
+                juce::FloatVectorOperations::add (feedback[channel], chunk[channel].channelData, numSamples);
+                juce::FloatVectorOperations::copy (chunk[channel].channelData, wet[channel], numSamples);
+
+                shape (channel, feedback[channel], numSamples);
+                saturate (channel, feedback[channel], numSamples);
+            }
+
+            recordDelayInput (left, feedback[0], numSamples, *c[0].writePosition);
+            recordDelayInput (right, feedback[1], numSamples, *c[1].writePosition);
+        }
+    }
+
+private:
+    void saturate (int channel, float* samples, int numSamples) noexcept;
+
+    // The curves and oversampling filters run in float; double-precision
+    // loops convert the chunk there and back
+    void saturate (int channel, double* samples, int numSamples) noexcept;
+
+    // Wet and feedback for one chunk, in each precision the loop can run at;
+    // the right-hand pair is only used by processStereo()
+    template <typename SampleType>
+    struct Scratch
+    {
+        juce::HeapBlock<SampleType> wet, feedback, rightWet, rightFeedback;
+    };
+
+    template <typename SampleType>
+    Scratch<SampleType>& getScratch() noexcept
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doubleScratch;
+        else
+            return floatScratch;
+    }
+
+    SaturationCurve curve = SaturationCurve::off;
+    int oversamplingIndex = 1;
+    int maxBlockSize = 0;
+
+    const SaturationTable& table = SaturationTable::getInstance();
+
+    // [factor index - 1][channel]; mono instances so each channel keeps its own filter state
+    std::vector<std::unique_ptr<juce::dsp::Oversampling<float>>> oversamplers[maxOversamplingIndex];
+
+    Scratch<float> floatScratch;
+    Scratch<double> doubleScratch;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FeedbackSaturator)
+};
+
+//==============================================================================
+/** The single-head reader for FeedbackSaturator::process: one interpolated
+    tap per sample, read distanceOffset samples closer than delaySamples, plus
+    distanceOffsetStep more for every sample into the chunk.
+*/
+template <typename History, typename SampleType>
+void readEcho (const History& history, const BasicDelayKernelContext<SampleType>& c, float distanceOffset,
+               SampleType* wet, SampleType* feedback, float distanceOffsetStep = 0.0f) noexcept
+{
+    const auto minDistance = static_cast<SampleType> (interpolationMargin);
+    const auto maxDistance = static_cast<SampleType> (history.size - interpolationMargin);
+
+    visitInterpolator (c.interpolation, [&] (auto interpolator)
+    {
+        using Interpolator = decltype (interpolator);
+
+        SampleType state = c.interpolatorState != nullptr ? *c.interpolatorState : SampleType (0);
+        int position = *c.writePosition;
+
+        for (int i = 0; i < c.numSamples; ++i)
+        {
+            const auto offset = static_cast<SampleType> (distanceOffset + distanceOffsetStep * static_cast<float> (i));
+            const SampleType distance = juce::jlimit (minDistance, maxDistance, c.delaySamples[i] - offset);
+            wet[i] = readInterpolated<Interpolator> (history, static_cast<SampleType> (position) - distance, state);
+
+            if (++position == history.size)
+                position = 0;
+        }
+
+        if (c.interpolatorState != nullptr)
+            *c.interpolatorState = state;
+    });
+
+    juce::FloatVectorOperations::copy (feedback, wet, c.numSamples);
+}
+
+} // namespace ghostline
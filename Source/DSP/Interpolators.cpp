@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    Interpolators.cpp
+
+  ==============================================================================
+*/
+
+#include "Interpolators.h"
+
+namespace ghostline
+{
+
+namespace
+{
+    // Zeroth-order modified Bessel function, by its power series
+    double besselI0 (double x)
+    {
+        double sum = 1.0;
+        double term = 1.0;
+
+        for (int k = 1; k < 32; ++k)
+        {
+            term *= (x * 0.5 / k) * (x * 0.5 / k);
+            sum += term;
+        }
+
+        return sum;
+    }
+}
+
+//==============================================================================
+SincTable::SincTable()
+{
+    constexpr double beta = 6.0;    // About -60 dB sidelobes: a fair trade at only eight taps
+    constexpr double halfLength = numTaps / 2;
+    const double windowNormalisation = 1.0 / besselI0 (beta);
+
+    for (int phase = 0; phase < numPhases + 2; ++phase)
+    {
+        const double t = juce::jmin (1.0, static_cast<double> (phase) / numPhases);
+        float* row = coefficients.data() + phase * numTaps;
+        double sum = 0.0;
+
+        // Tap k sits at k - 3 relative to the integer read position
+        for (int k = 0; k < numTaps; ++k)
+        {
+            const double x = static_cast<double> (k - (numTaps / 2 - 1)) - t;
+            const double sinc = std::abs (x) < 1.0e-9 ? 1.0 : std::sin (juce::MathConstants<double>::pi * x) / (juce::MathConstants<double>::pi * x);
+            const double ratio = x / halfLength;
+            const double window = std::abs (ratio) < 1.0 ? besselI0 (beta * std::sqrt (1.0 - ratio * ratio)) * windowNormalisation : 0.0;
+
+            row[k] = static_cast<float> (sinc * window);
+            sum += sinc * window;
+        }
+
+        for (int k = 0; k < numTaps; ++k)
+            row[k] = static_cast<float> (row[k] / sum);
+    }
+}
+
+const SincTable& SincTable::getInstance()
+{
+    static const SincTable table;
+    return table;
+}
+
+} // namespace ghostline
@@ -0,0 +1,213 @@
+/*
+  ==============================================================================
+
+    Interpolators.h
+    Fractional-delay read kernels, from cheap linear up to windowed sinc.
+    Each one turns a handful of consecutive history taps into one sample.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace ghostline
+{
+
+//==============================================================================
+enum class InterpolationMode
+{
+    linear = 0,     // 2 taps. Cheapest; rolls off the top octave as the fraction nears 0.5
+    hermite,        // 4 taps, Catmull-Rom cubic
+    lagrange,       // 4 taps, third-order Lagrange: maximally flat at DC
+    allpass,        // 2 taps plus one sample of state, first-order Thiran. Flat magnitude, phase-only error
+    sinc            // 8 taps from a Kaiser-windowed sinc table, interpolated between 256 phases
+};
+
+/** Read distances must stay this far inside [0, size]: the widest kernel
+    reads 3 taps behind and 4 ahead of the integer position.
+*/
+constexpr int interpolationMargin = 4;
+
+//==============================================================================
+/*
+    Every interpolator has the same shape. The caller subtracts readOffset
+    from the read position, wraps it once, splits it into an integer index
+    and a fraction, and hands over numTaps consecutive samples starting at
+    that index. Only the allpass keeps state between calls; the rest ignore it.
+
+    interpolate() works in float or double. The float instantiations perform
+    exactly the operations the vector kernels mirror, so they stay bit-exact.
+*/
+struct LinearInterpolator
+{
+    static constexpr int numTaps = 2;
+    static constexpr float readOffset = 0.0f;
+
+    template <typename SampleType>
+    static SampleType interpolate (const SampleType* x, SampleType t, SampleType&) noexcept
+    {
+        return x[0] * (SampleType (1) - t) + x[1] * t;
+    }
+};
+
+struct HermiteInterpolator
+{
+    static constexpr int numTaps = 4;
+    static constexpr float readOffset = 1.0f;
+
+    template <typename SampleType>
+    static SampleType interpolate (const SampleType* x, SampleType t, SampleType&) noexcept
+    {
+        const SampleType c1 = SampleType (0.5) * (x[2] - x[0]);
+        const SampleType c2 = x[0] - SampleType (2.5) * x[1] + SampleType (2) * x[2] - SampleType (0.5) * x[3];
+        const SampleType c3 = SampleType (0.5) * (x[3] - x[0]) + SampleType (1.5) * (x[1] - x[2]);
+
+        return ((c3 * t + c2) * t + c1) * t + x[1];
+    }
+};
+
+struct LagrangeInterpolator
+{
+    static constexpr int numTaps = 4;
+    static constexpr float readOffset = 1.0f;
+
+    template <typename SampleType>
+    static SampleType interpolate (const SampleType* x, SampleType t, SampleType&) noexcept
+    {
+        // Taps sit at -1, 0, 1 and 2 relative to the integer position
+        const SampleType tp1 = t + SampleType (1);
+        const SampleType tm1 = t - SampleType (1);
+        const SampleType tm2 = t - SampleType (2);
+        const SampleType sixth = SampleType (1) / SampleType (6);
+
+        const SampleType h0 = -t * tm1 * tm2 * sixth;
+        const SampleType h1 = tp1 * tm1 * tm2 * SampleType (0.5);
+        const SampleType h2 = -tp1 * t * tm2 * SampleType (0.5);
+        const SampleType h3 = tp1 * t * tm1 * sixth;
+
+        return h0 * x[0] + h1 * x[1] + h2 * x[2] + h3 * x[3];
+    }
+};
+
+struct AllpassInterpolator
+{
+    static constexpr int numTaps = 2;
+
+    // Reading half a sample later keeps the filter's delay in (0.5, 1.5],
+    // where the first-order Thiran coefficient stays well inside the unit circle
+    static constexpr float readOffset = -0.5f;
+
+    template <typename SampleType>
+    static SampleType getCoefficient (SampleType t) noexcept
+    {
+        // delay = 1.5 - t, coefficient = (1 - delay) / (1 + delay)
+        return (t - SampleType (0.5)) / (SampleType (2.5) - t);
+    }
+
+    template <typename SampleType>
+    static SampleType interpolate (const SampleType* x, SampleType t, SampleType& previousOutput) noexcept
+    {
+        previousOutput = getCoefficient (t) * (x[1] - previousOutput) + x[0];
+        return previousOutput;
+    }
+};
+
+//==============================================================================
+/**
+    Eight-tap Kaiser-windowed sinc, tabulated at 256 fractional positions and
+    shared by every instance in the process. Rows are normalised to unity gain at DC, so a feedback
+    loop can't creep upwards through the interpolator.
+*/
+class SincTable
+{
+public:
+    static constexpr int numTaps = 8;
+    static constexpr int numPhases = 256;
+
+    static const SincTable& getInstance();
+
+    /** The coefficients for fractional position phase / numPhases. */
+    const float* getRow (int phase) const noexcept    { return coefficients.data() + phase * numTaps; }
+
+private:
+    SincTable();
+
+    // One guard row for the phase interpolation partner, one in case a
+    // fraction just below 1 rounds up to exactly numPhases
+    alignas (32) std::array<float, (numPhases + 2) * numTaps> coefficients;
+};
+
+struct SincInterpolator
+{
+    static constexpr int numTaps = SincTable::numTaps;
+    static constexpr float readOffset = 3.0f;
+
+    // Resolved at static-init time, so the sample loop doesn't pay for a guard check
+    inline static const SincTable& table = SincTable::getInstance();
+
+    template <typename SampleType>
+    static SampleType interpolate (const SampleType* x, SampleType t, SampleType&) noexcept
+    {
+        const SampleType position = t * static_cast<SampleType> (SincTable::numPhases);
+        const int phase = static_cast<int> (position);
+        const SampleType blend = position - static_cast<SampleType> (phase);
+
+        const float* row = table.getRow (phase);
+        const float* next = table.getRow (phase + 1);
+
+        SampleType sum = 0;
+        for (int k = 0; k < numTaps; ++k)
+            sum += x[k] * (row[k] + blend * (next[k] - row[k]));
+
+        return sum;
+    }
+};
+
+//==============================================================================
+/** Calls visitor with a default-constructed interpolator for mode, so the
+    choice is made once per block and the sample loop is specialised for it.
+*/
+template <typename Visitor>
+void visitInterpolator (InterpolationMode mode, Visitor&& visitor)
+{
+    switch (mode)
+    {
+        case InterpolationMode::hermite:    visitor (HermiteInterpolator{});   break;
+        case InterpolationMode::lagrange:   visitor (LagrangeInterpolator{});  break;
+        case InterpolationMode::allpass:    visitor (AllpassInterpolator{});   break;
+        case InterpolationMode::sinc:       visitor (SincInterpolator{});      break;
+        case InterpolationMode::linear:
+        default:                            visitor (LinearInterpolator{});    break;
+    }
+}
+
+/** One interpolated read from any history with read (index) and size, e.g.
+    MirroredDelayBuffer::History or a CompactDelayBuffer codec, in the
+    precision of readPos. Wraps every tap, so it doesn't rely on a guard zone.
+*/
+template <typename Interpolator, typename History, typename SampleType>
+SampleType readInterpolated (const History& history, SampleType readPos, SampleType& state) noexcept
+{
+    const int size = history.size;
+
+    readPos -= static_cast<SampleType> (Interpolator::readOffset);
+    readPos += readPos < 0 ? static_cast<SampleType> (size) : SampleType (0);
+
+    int index = static_cast<int> (readPos);
+    const SampleType fraction = readPos - static_cast<SampleType> (index);
+    if (index >= size)
+        index -= size;
+
+    SampleType taps[Interpolator::numTaps];
+    for (int k = 0; k < Interpolator::numTaps; ++k)
+    {
+        const int tap = index + k;
+        taps[k] = history.read (tap < size ? tap : tap - size);
+    }
+
+    return Interpolator::interpolate (taps, fraction, state);
+}
+
+} // namespace ghostline
@@ -0,0 +1,126 @@
+/*
+  ==============================================================================
+
+    MirroredDelayBuffer.h
+    Circular echo history for every channel in one aligned allocation, with
+    the start of each channel mirrored past its end so reads never wrap.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace ghostline
+{
+
+//==============================================================================
+/**
+    Channel c occupies [c * stride, c * stride + size + guardSamples). The
+    first guardSamples of each channel are written twice, once in place and
+    once just past the end, so an interpolator can read guardSamples taps
+    forward from any index in [0, size] without wrapping.
+
+    Each channel starts on a 64-byte boundary. The allocation happens in
+    setSize(); reads and writes never allocate. MirroredDelayBuffer holds
+    float, which the vector kernels run on; hosts processing in double
+    precision get a double history.
+*/
+template <typename SampleType>
+class BasicMirroredDelayBuffer
+{
+public:
+    /** Samples readable past any index in [0, size) without a wrap. */
+    static constexpr int guardSamples = 64;
+
+    /** Widest vector store a kernel may issue at a mirrored write position. */
+    static constexpr int maxVectorWidth = 16;
+
+    static constexpr int alignmentBytes = 64;
+
+    BasicMirroredDelayBuffer() = default;
+
+    /** Reallocates and clears. Not realtime-safe. */
+    void setSize (int newNumChannels, int newSize)
+    {
+        jassert (newNumChannels > 0 && newSize > guardSamples);
+
+        constexpr int samplesPerLine = alignmentBytes / static_cast<int> (sizeof (SampleType));
+
+        numChannels = newNumChannels;
+        size = newSize;
+        stride = ((size + guardSamples + maxVectorWidth + samplesPerLine - 1) / samplesPerLine) * samplesPerLine;
+
+        storage.calloc (static_cast<size_t> (numChannels * stride + samplesPerLine));
+        data = juce::snapPointerToAlignment (storage.get(), alignmentBytes);
+    }
+
+    /** Frees the storage, e.g. while a compact long-delay buffer is in use. */
+    void release()
+    {
+        storage.free();
+        data = nullptr;
+        numChannels = 0;
+        size = 0;
+        stride = 0;
+    }
+
+    void clear() noexcept
+    {
+        if (data != nullptr)
+            std::fill (data, data + numChannels * stride, SampleType (0));
+    }
+
+    int getNumChannels() const noexcept     { return numChannels; }
+    int getSize() const noexcept            { return size; }
+    int getChannelStride() const noexcept   { return stride; }
+
+    SampleType* getWritePointer (int channel) noexcept
+    {
+        jassert (juce::isPositiveAndBelow (channel, numChannels));
+        return data + channel * stride;
+    }
+
+    const SampleType* getReadPointer (int channel) const noexcept
+    {
+        jassert (juce::isPositiveAndBelow (channel, numChannels));
+        return data + channel * stride;
+    }
+
+    /** One channel behind the read/write interface shared with the compact
+        storage codecs, for loops that are templated on the sample format.
+    */
+    struct History
+    {
+        SampleType* data;
+        int size;
+
+        SampleType read (int index) const noexcept                { return data[index]; }
+        void write (int index, SampleType value) const noexcept   { BasicMirroredDelayBuffer::write (data, size, index, value); }
+    };
+
+    History getHistory (int channel) noexcept   { return { getWritePointer (channel), size }; }
+
+    /** Stores one sample, keeping the mirror in step. Branch-free: positions
+        outside the guard zone simply store to the same address twice.
+    */
+    static void write (SampleType* channelData, int bufferSize, int position, SampleType value) noexcept
+    {
+        channelData[position] = value;
+        channelData[position < guardSamples ? position + bufferSize : position] = value;
+    }
+
+private:
+    juce::HeapBlock<SampleType> storage;
+    SampleType* data = nullptr;
+    int numChannels = 0;
+    int size = 0;
+    int stride = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BasicMirroredDelayBuffer)
+};
+
+using MirroredDelayBuffer = BasicMirroredDelayBuffer<float>;
+
+} // namespace ghostline
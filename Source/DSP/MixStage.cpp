@@ -0,0 +1,152 @@
+/*
+  ==============================================================================
+
+    MixStage.cpp
+
+  ==============================================================================
+*/
+
+#include "MixStage.h"
+
+namespace ghostline
+{
+
+void MixStage::prepare (double sampleRate, int maxBlockSize)
+{
+    capacity = juce::jmax (1, maxBlockSize);
+    wetRamp.calloc (static_cast<size_t> (capacity));
+    dryRamp.calloc (static_cast<size_t> (capacity));
+
+    wetGain.reset (sampleRate, rampSeconds);
+    dryGain.reset (sampleRate, rampSeconds);
+    reset();
+}
+
+void MixStage::reset() noexcept
+{
+    wetGain.setCurrentAndTargetValue (wetGain.getTargetValue());
+    dryGain.setCurrentAndTargetValue (dryGain.getTargetValue());
+
+    wetStart = wetGain.getTargetValue();
+    dryStart = dryGain.getTargetValue();
+    wetStep = dryStep = 0.0f;
+    ramping = false;
+    filledStart = -1;
+}
+
+void MixStage::setLevels (float wet, float dry) noexcept
+{
+    wetGain.setTargetValue (wet);
+    dryGain.setTargetValue (dry);
+}
+
+void MixStage::setMix (float mix, MixLaw law) noexcept
+{
+    jassert (law != MixLaw::separate);
+
+    const float clamped = juce::jlimit (0.0f, 1.0f, mix);
+
+    if (law == MixLaw::equalPower)
+    {
+        const float angle = clamped * juce::MathConstants<float>::halfPi;
+        setLevels (std::sin (angle), std::cos (angle));
+    }
+    else
+    {
+        setLevels (clamped, 1.0f - clamped);
+    }
+}
+
+void MixStage::beginBlock (int numSamples) noexcept
+{
+    wetStart = wetGain.getCurrentValue();
+    dryStart = dryGain.getCurrentValue();
+    ramping = wetGain.isSmoothing() || dryGain.isSmoothing();
+
+    if (ramping)
+    {
+        const float scale = 1.0f / static_cast<float> (juce::jmax (1, numSamples));
+        wetStep = (wetGain.skip (numSamples) - wetStart) * scale;
+        dryStep = (dryGain.skip (numSamples) - dryStart) * scale;
+    }
+
+    filledStart = -1;
+}
+
+MixShape MixStage::getShape() const noexcept
+{
+    if (ramping)
+        return MixShape::mixed;
+
+    if (wetStart == 0.0f)
+        return MixShape::dryOnly;
+
+    return dryStart == 0.0f ? MixShape::wetOnly : MixShape::mixed;
+}
+
+template <typename SampleType>
+void MixStage::process (SampleType* echo, const SampleType* dry, int start, int numSamples) noexcept
+{
+    jassert (numSamples <= capacity);
+
+    if (ramping)
+    {
+        if (start != filledStart || numSamples != filledLength)
+            fillRamps (start, numSamples);
+
+        if constexpr (std::is_same_v<SampleType, float>)
+        {
+            juce::FloatVectorOperations::multiply (echo, wetRamp.get(), numSamples);
+            juce::FloatVectorOperations::addWithMultiply (echo, dry, dryRamp.get(), numSamples);
+        }
+        else
+        {
+            // The ramps are float; there is no mixed-precision vector op
+            for (int i = 0; i < numSamples; ++i)
+                echo[i] = echo[i] * wetRamp[i] + dry[i] * dryRamp[i];
+        }
+
+        return;
+    }
+
+    if (wetStart != 1.0f)
+        juce::FloatVectorOperations::multiply (echo, static_cast<SampleType> (wetStart), numSamples);
+
+    if (dryStart != 0.0f)
+        juce::FloatVectorOperations::addWithMultiply (echo, dry, static_cast<SampleType> (dryStart), numSamples);
+}
+
+template void MixStage::process (float*, const float*, int, int) noexcept;
+template void MixStage::process (double*, const double*, int, int) noexcept;
+
+template <typename SampleType>
+void MixStage::processDryOnly (SampleType* out, const SampleType* dry, int numSamples) noexcept
+{
+    jassert (getShape() == MixShape::dryOnly);
+
+    if (out != dry)
+        juce::FloatVectorOperations::copyWithMultiply (out, dry, static_cast<SampleType> (dryStart), numSamples);
+    else if (dryStart != 1.0f)
+        juce::FloatVectorOperations::multiply (out, static_cast<SampleType> (dryStart), numSamples);
+}
+
+template void MixStage::processDryOnly (float*, const float*, int) noexcept;
+template void MixStage::processDryOnly (double*, const double*, int) noexcept;
+
+void MixStage::fillRamps (int start, int numSamples) noexcept
+{
+    float* wet = wetRamp.get();
+    float* dry = dryRamp.get();
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto position = static_cast<float> (start + i);
+        wet[i] = wetStart + wetStep * position;
+        dry[i] = dryStart + dryStep * position;
+    }
+
+    filledStart = start;
+    filledLength = numSamples;
+}
+
+} // namespace ghostline
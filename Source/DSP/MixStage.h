@@ -0,0 +1,98 @@
+/*
+  ==============================================================================
+
+    MixStage.h
+    Wet/dry mix applied to whole blocks after the echo loop, with the gains
+    ramped across each block instead of stepped.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace ghostline
+{
+
+//==============================================================================
+enum class MixLaw
+{
+    separate = 0,   // WET and DRY set independently
+    linear,         // MIX crossfades, wet + dry = 1: dips about 3 dB in the middle on uncorrelated material
+    equalPower      // MIX crossfades, wet^2 + dry^2 = 1: constant power
+};
+
+/** Which halves of the mix reach the output this block, so the loop can
+    leave out work whose result would be multiplied by zero.
+*/
+enum class MixShape
+{
+    mixed,          // Both gains non-zero, or either still gliding
+    wetOnly,        // Dry gain settled at 0: the dry input needn't be kept
+    dryOnly         // Wet gain settled at 0: the echo never reaches the output
+};
+
+/**
+    The kernels leave the echo alone in the channel; this mixes the dry input
+    back in with
+
+        out = echo * wetGain + dry * dryGain
+
+    Both gains glide to their targets over rampSeconds. The glide is turned
+    into one straight ramp per block, shared by every channel, so the mix is
+    two vector operations per channel whether or not anything is moving.
+*/
+class MixStage
+{
+public:
+    static constexpr double rampSeconds = 0.05;
+
+    /** Sizes the ramp scratch. Not realtime-safe. */
+    void prepare (double sampleRate, int maxBlockSize);
+
+    /** Jumps straight to the target gains. */
+    void reset() noexcept;
+
+    void setLevels (float wet, float dry) noexcept;
+
+    /** 0 is all dry, 1 all wet. law must not be MixLaw::separate. */
+    void setMix (float mix, MixLaw law) noexcept;
+
+    /** Moves the gains on by one block. Call before mixing any channel of it. */
+    void beginBlock (int numSamples) noexcept;
+
+    /** The shape of the current block, fixed by beginBlock(). */
+    MixShape getShape() const noexcept;
+
+    /** Mixes samples [start, start + numSamples) of the current block in place:
+        echo holds the echo on the way in and the mix on the way out.
+        numSamples must not exceed the size given to prepare(). Instantiated
+        for float and double.
+    */
+    template <typename SampleType>
+    void process (SampleType* echo, const SampleType* dry, int start, int numSamples) noexcept;
+
+    /** For MixShape::dryOnly blocks: out = dry * dryGain, with no echo at
+        all. out may be dry itself. Instantiated for float and double.
+    */
+    template <typename SampleType>
+    void processDryOnly (SampleType* out, const SampleType* dry, int numSamples) noexcept;
+
+private:
+    void fillRamps (int start, int numSamples) noexcept;
+
+    juce::SmoothedValue<float> wetGain, dryGain;
+
+    // This block's ramp, from the gain at its first sample to the gain after its last
+    float wetStart = 0.0f, wetStep = 0.0f;
+    float dryStart = 0.0f, dryStep = 0.0f;
+    bool ramping = false;
+
+    // Gains per sample for the span last filled, reused by the next channel
+    juce::HeapBlock<float> wetRamp, dryRamp;
+    int capacity = 0;
+    int filledStart = -1, filledLength = 0;
+};
+
+} // namespace ghostline
@@ -0,0 +1,209 @@
+/*
+  ==============================================================================
+
+    ModulationOscillator.cpp
+
+  ==============================================================================
+*/
+
+#include "ModulationOscillator.h"
+
+namespace ghostline
+{
+
+//==============================================================================
+SineTable::SineTable()
+{
+    for (int i = 0; i < static_cast<int> (values.size()); ++i)
+        values[static_cast<size_t> (i)] = static_cast<float> (std::sin (juce::MathConstants<double>::twoPi * i / size));
+}
+
+const SineTable& SineTable::getInstance()
+{
+    // Function-local static: built once, thread-safe, shared by every instance
+    static const SineTable table;
+    return table;
+}
+
+//==============================================================================
+void ModulationOscillator::prepare (double sampleRate) noexcept
+{
+    currentSampleRate = sampleRate;
+    reset();
+}
+
+void ModulationOscillator::reset (float startPhase) noexcept
+{
+    startPhase += phaseOffset;
+    phase = startPhase - std::floor (startPhase);
+    startCycle (0);
+}
+
+void ModulationOscillator::setFrequency (float hz) noexcept
+{
+    phaseIncrement = static_cast<float> (hz / currentSampleRate);
+}
+
+void ModulationOscillator::setRandomSeed (juce::uint32 seed) noexcept
+{
+    randomSeed = seed;
+    startCycle (cycle);
+}
+
+void ModulationOscillator::setPhaseOffset (float cycles) noexcept
+{
+    cycles -= std::floor (cycles);
+
+    if (cycles == phaseOffset)
+        return;
+
+    const float shifted = phase + (cycles - phaseOffset);
+    const float wraps = std::floor (shifted);
+
+    if (wraps != 0.0f)
+        startCycle (cycle + static_cast<juce::int64> (wraps));
+
+    phase = shifted - wraps;
+    phaseOffset = cycles;
+}
+
+void ModulationOscillator::syncToCycle (double cyclePosition) noexcept
+{
+    const double position = cyclePosition + static_cast<double> (phaseOffset) - static_cast<double> (phaseIncrement);
+    const double wholeCycles = std::floor (position);
+    const auto cycleIndex = static_cast<juce::int64> (wholeCycles);
+
+    phase = static_cast<float> (position - wholeCycles);
+    if (phase >= 1.0f)
+        phase = 0.0f;
+
+    if (cycleIndex != cycle)
+        startCycle (cycleIndex);
+}
+
+float ModulationOscillator::getRandomTarget (juce::int64 cycleIndex) const noexcept
+{
+    // splitmix64 finaliser: stateless, so any cycle's target can be recomputed
+    auto x = static_cast<juce::uint64> (cycleIndex) * 0x9e3779b97f4a7c15ull + randomSeed;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    x ^= x >> 31;
+
+    return static_cast<float> (x >> 40) * (2.0f / 16777216.0f) - 1.0f;
+}
+
+void ModulationOscillator::startCycle (juce::int64 cycleIndex) noexcept
+{
+    cycle = cycleIndex;
+    randomFrom = getRandomTarget (cycle);
+    randomTo = getRandomTarget (cycle + 1);
+}
+
+void ModulationOscillator::process (float* output, int numSamples) noexcept
+{
+    const float increment = phaseIncrement;
+    float p = phase;
+
+    switch (shape)
+    {
+        case LfoShape::sine:
+            for (int i = 0; i < numSamples; ++i)
+            {
+                p += increment;
+                if (p >= 1.0f)
+                    p -= 1.0f;
+
+                output[i] = sineTable (p);
+            }
+            break;
+
+        case LfoShape::triangle:
+            for (int i = 0; i < numSamples; ++i)
+            {
+                p += increment;
+                if (p >= 1.0f)
+                    p -= 1.0f;
+
+                // Quarter-cycle offset so it starts at 0 and rises, like the sine
+                const float t = p < 0.75f ? p + 0.25f : p - 0.75f;
+                output[i] = 1.0f - 4.0f * std::abs (t - 0.5f);
+            }
+            break;
+
+        case LfoShape::smoothRandom:
+            for (int i = 0; i < numSamples; ++i)
+            {
+                p += increment;
+                if (p >= 1.0f)
+                {
+                    p -= 1.0f;
+                    startCycle (cycle + 1);
+                }
+
+                // 0.5 - 0.5 cos (pi p), read from the sine table a quarter-turn on
+                const float glide = 0.5f - 0.5f * sineTable (0.5f * p + 0.25f);
+                output[i] = randomFrom + glide * (randomTo - randomFrom);
+            }
+            break;
+
+        default:
+            jassertfalse;
+            break;
+    }
+
+    phase = p;
+}
+
+void ModulationOscillator::processAtControlRate (float* output, int numSamples, int interval) noexcept
+{
+    float previous = getValue();
+
+    for (int start = 0; start < numSamples; start += interval)
+    {
+        const int length = juce::jmin (interval, numSamples - start);
+
+        advance (length);
+        const float next = getValue();
+        const float step = (next - previous) / static_cast<float> (length);
+
+        for (int i = 0; i < length; ++i)
+            output[start + i] = previous + step * static_cast<float> (i + 1);
+
+        previous = next;
+    }
+}
+
+float ModulationOscillator::getValue() const noexcept
+{
+    switch (shape)
+    {
+        case LfoShape::sine:
+            return sineTable (phase);
+
+        case LfoShape::triangle:
+        {
+            const float t = phase < 0.75f ? phase + 0.25f : phase - 0.75f;
+            return 1.0f - 4.0f * std::abs (t - 0.5f);
+        }
+
+        case LfoShape::smoothRandom:
+            return randomFrom + (0.5f - 0.5f * sineTable (0.5f * phase + 0.25f)) * (randomTo - randomFrom);
+
+        default:
+            jassertfalse;
+            return 0.0f;
+    }
+}
+
+void ModulationOscillator::advance (int numSamples) noexcept
+{
+    const float cycles = phase + phaseIncrement * static_cast<float> (numSamples);
+    const float wraps = std::floor (cycles);
+
+    if (wraps > 0.0f)
+        startCycle (cycle + static_cast<juce::int64> (wraps));
+
+    phase = cycles - wraps;
+}
+
+} // namespace ghostline
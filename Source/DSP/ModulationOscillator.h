@@ -0,0 +1,123 @@
+/*
+  ==============================================================================
+
+    ModulationOscillator.h
+    Block-rate LFO with sine, triangle and smoothed-random shapes. Sine comes
+    from a process-wide wavetable shared by every plugin instance.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace ghostline
+{
+
+//==============================================================================
+/**
+    One cycle of sin (2 pi x), built on first use and read-only afterwards.
+    16 KB for the whole process, no matter how many instances are loaded.
+    Linear interpolation keeps the error below 3e-7.
+*/
+class SineTable
+{
+public:
+    static constexpr int size = 4096;
+
+    static const SineTable& getInstance();
+
+    /** phase is in cycles, in [0, 1). */
+    float operator() (float phase) const noexcept
+    {
+        const float position = phase * static_cast<float> (size);
+        const int index = static_cast<int> (position);
+        const float fraction = position - static_cast<float> (index);
+
+        return values[index] + fraction * (values[index + 1] - values[index]);
+    }
+
+private:
+    SineTable();
+
+    // Two guard points: one for the interpolation partner, one in case a phase
+    // just below 1 rounds up to exactly size
+    std::array<float, size + 2> values;
+};
+
+//==============================================================================
+enum class LfoShape
+{
+    sine = 0,
+    triangle,
+    smoothRandom
+};
+
+/**
+    A free-running LFO that renders a whole block of values in [-1, 1] at a
+    time. The shape loop is chosen once per block, not per sample.
+*/
+class ModulationOscillator
+{
+public:
+    ModulationOscillator() = default;
+
+    void prepare (double sampleRate) noexcept;
+    void reset (float startPhase = 0.0f) noexcept;
+
+    void setShape (LfoShape newShape) noexcept    { shape = newShape; }
+    void setFrequency (float hz) noexcept;
+    void setRandomSeed (juce::uint32 seed) noexcept;
+
+    /** Fixed phase lead in cycles, kept through reset() and syncToCycle(), so
+        several oscillators on the same rate stay spread apart. Changing it
+        moves the running phase by the difference.
+    */
+    void setPhaseOffset (float cycles) noexcept;
+
+    float getPhase() const noexcept               { return phase; }
+
+    /** Locks to an absolute position in cycles, e.g. host PPQ / beats per cycle.
+        The first value rendered afterwards lands exactly on that position, and
+        the random shape picks the targets belonging to that cycle, so two
+        renders of the same transport position produce the same modulation.
+    */
+    void syncToCycle (double cyclePosition) noexcept;
+
+    /** Fills output with the next numSamples values. */
+    void process (float* output, int numSamples) noexcept;
+
+    /** Like process(), but evaluates the shape only every interval samples
+        and draws straight lines in between: the same curve, slightly flattened
+        at its peaks, for a fraction of the cost.
+    */
+    void processAtControlRate (float* output, int numSamples, int interval) noexcept;
+
+    /** Moves the phase on as if process() had run, without rendering. */
+    void advance (int numSamples) noexcept;
+
+private:
+    /** The shape at the current phase: the value process() last rendered. */
+    float getValue() const noexcept;
+
+    float getRandomTarget (juce::int64 cycleIndex) const noexcept;
+    void startCycle (juce::int64 cycleIndex) noexcept;
+
+    LfoShape shape = LfoShape::sine;
+    double currentSampleRate = 44100.0;
+    float phase = 0.0f;
+    float phaseIncrement = 0.0f;
+    float phaseOffset = 0.0f;
+
+    // Smoothed random: a cosine glide from one target to the next every cycle.
+    // Targets are a hash of (seed, cycle), so they can be recomputed for any cycle.
+    juce::uint32 randomSeed = 0x9e3779b9u;
+    juce::int64 cycle = 0;
+    float randomFrom = 0.0f;
+    float randomTo = 0.0f;
+
+    const SineTable& sineTable = SineTable::getInstance();
+};
+
+} // namespace ghostline
@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    MultiHeadEcho.cpp
+
+  ==============================================================================
+*/
+
+#include "MultiHeadEcho.h"
+
+namespace ghostline
+{
+
+void MultiHeadEcho::prepare (int newNumChannels)
+{
+    numChannels = juce::jmax (1, newNumChannels);
+
+    const auto rowLength = static_cast<size_t> (numChannels * maxHeads);
+    channelGain.calloc (rowLength);
+    currentRatio.calloc (rowLength);
+    interpolatorState.calloc (rowLength);
+    channelSide.calloc (static_cast<size_t> (numChannels));
+
+    gainsNeedUpdate = true;
+    reset();
+}
+
+void MultiHeadEcho::setChannelSide (int channel, float side) noexcept
+{
+    jassert (juce::isPositiveAndBelow (channel, numChannels));
+
+    channelSide[channel] = side;
+    gainsNeedUpdate = true;
+}
+
+void MultiHeadEcho::reset() noexcept
+{
+    for (int channel = 0; channel < numChannels; ++channel)
+        std::copy (std::begin (targetRatio), std::end (targetRatio), getRow (currentRatio, channel));
+}
+
+void MultiHeadEcho::resetInterpolators() noexcept
+{
+    std::fill (interpolatorState.get(), interpolatorState.get() + numChannels * maxHeads, 0.0);
+}
+
+void MultiHeadEcho::setNumHeads (int newNumHeads) noexcept
+{
+    const int clamped = juce::jlimit (minHeads, maxHeads, newNumHeads);
+
+    // A head coming back in starts at its target instead of sweeping from wherever it was left
+    for (int h = numHeads; h < clamped; ++h)
+        for (int channel = 0; channel < numChannels; ++channel)
+            getRow (currentRatio, channel)[h] = targetRatio[h];
+
+    numHeads = clamped;
+    gainsNeedUpdate = true;
+}
+
+void MultiHeadEcho::setHead (int index, float newLevel, float newPan, float timeRatio) noexcept
+{
+    jassert (juce::isPositiveAndBelow (index, maxHeads));
+
+    const float clampedPan = juce::jlimit (-1.0f, 1.0f, newPan);
+    targetRatio[index] = juce::jlimit (0.01f, 1.0f, timeRatio);
+
+    // Called every block; only redo the pan law when something moved
+    if (level[index] != newLevel || pan[index] != clampedPan)
+    {
+        level[index] = newLevel;
+        pan[index] = clampedPan;
+        gainsNeedUpdate = true;
+    }
+}
+
+float MultiHeadEcho::getShortestRatio (int channel) const noexcept
+{
+    const float* ratio = getRow (currentRatio, channel);
+    float shortest = 1.0f;
+
+    for (int h = 0; h < numHeads; ++h)
+        shortest = juce::jmin (shortest, ratio[h], targetRatio[h]);
+
+    return shortest;
+}
+
+const float* MultiHeadEcho::beginBlock (int channel, int numSamples) noexcept
+{
+    if (gainsNeedUpdate)
+        updateGains();
+
+    const float stepScale = 1.0f / static_cast<float> (juce::jmax (1, numSamples));
+    const float* ratio = getRow (currentRatio, channel);
+
+    for (int h = 0; h < numHeads; ++h)
+        ratioSteps[h] = (targetRatio[h] - ratio[h]) * stepScale;
+
+    return ratioSteps;
+}
+
+void MultiHeadEcho::endBlock (int channel) noexcept
+{
+    std::copy (targetRatio, targetRatio + numHeads, getRow (currentRatio, channel));
+}
+
+void MultiHeadEcho::updateGains() noexcept
+{
+    float totalLevel = 0.0f;
+
+    for (int h = 0; h < numHeads; ++h)
+    {
+        // Equal-power pan scaled so the centre is unity on both sides
+        const float angle = (pan[h] + 1.0f) * juce::MathConstants<float>::pi * 0.25f;
+        const float leftGain = level[h] * juce::jmin (1.0f, std::cos (angle) * juce::MathConstants<float>::sqrt2);
+        const float rightGain = level[h] * juce::jmin (1.0f, std::sin (angle) * juce::MathConstants<float>::sqrt2);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const float side = channelSide[channel];
+            getRow (channelGain, channel)[h] = side < 0.0f ? leftGain : (side > 0.0f ? rightGain : level[h]);
+        }
+
+        totalLevel += level[h];
+    }
+
+    feedbackNormalisation = 1.0f / juce::jmax (1.0f, totalLevel);
+    gainsNeedUpdate = false;
+}
+
+} // namespace ghostline
@@ -0,0 +1,202 @@
+/*
+  ==============================================================================
+
+    MultiHeadEcho.h
+    RE-201 style tape echo: up to eight read heads, each with its own level,
+    pan and spacing, all reading the one write buffer.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DelayKernels.h"
+
+namespace ghostline
+{
+
+//==============================================================================
+/**
+    Each head reads at a fraction of the main delay time, so DELAYTIME acts
+    like the tape speed and the heads keep their spacing as it moves. Head
+    state is stored as a struct of arrays, and every head is read in the same
+    pass over the block.
+
+    The feedback is the level-weighted sum of all heads, normalised so that
+    turning more heads up can't push the loop past FEEDBACK. Pan is a balance
+    control on stereo material, and a true pan when both channels carry the
+    same signal. On larger layouts every left-side channel takes the left
+    gain and every right-side one the right; centre, LFE and ambisonic
+    channels take the head's level alone, so pan can't skew a sound field.
+*/
+class MultiHeadEcho
+{
+public:
+    static constexpr int minHeads = 4;
+    static constexpr int maxHeads = 8;
+
+    MultiHeadEcho() = default;
+
+    /** Allocates the per-channel head state, every channel centred. Not realtime-safe. */
+    void prepare (int numChannels);
+
+    /** -1 for a left-side channel, 1 for a right-side one, 0 for anything else. */
+    void setChannelSide (int channel, float side) noexcept;
+
+    /** Jumps every head straight to its target spacing. */
+    void reset() noexcept;
+
+    void setNumHeads (int newNumHeads) noexcept;
+
+    /** level in [0, 1], pan in [-1, 1], timeRatio in (0, 1] of the main delay. */
+    void setHead (int index, float level, float pan, float timeRatio) noexcept;
+
+    /** Runs every head over one channel, in the context's precision. History
+        is a mirrored buffer's History or one of the CompactDelayBuffer codecs.
+        Head spacing glides to its new target across the block, so moving a
+        head doesn't click.
+    */
+    template <typename History, typename SampleType>
+    void process (const History& history, int channel, const BasicDelayKernelContext<SampleType>& c) noexcept
+    {
+        visitInterpolator (c.interpolation, [&] (auto interpolator)
+        {
+            processWith<decltype (interpolator)> (history, channel, c);
+        });
+    }
+
+    /** Reads every head for c.numSamples samples without writing, for loops
+        that build the record signal a block at a time. wet gets the panned mix
+        of the heads, feedback their normalised sum, before the WET and FEEDBACK
+        gains. Every head reads distanceOffset samples closer than its spacing,
+        plus distanceOffsetStep more for every sample into the chunk.
+    */
+    template <typename History, typename SampleType>
+    void read (const History& history, int channel, const BasicDelayKernelContext<SampleType>& c,
+               float distanceOffset, SampleType* wet, SampleType* feedback, float distanceOffsetStep = 0.0f) noexcept
+    {
+        visitInterpolator (c.interpolation, [&] (auto interpolator)
+        {
+            using Interpolator = decltype (interpolator);
+
+            const float* ratioStep = beginBlock (channel, c.numSamples);
+            int writePos = *c.writePosition;
+
+            for (int sample = 0; sample < c.numSamples; ++sample)
+            {
+                readHeads<Interpolator> (history, channel, writePos, c.delaySamples[sample],
+                                         distanceOffset + distanceOffsetStep * static_cast<float> (sample),
+                                         ratioStep, wet[sample], feedback[sample]);
+                feedback[sample] *= feedbackNormalisation;
+
+                if (++writePos == history.size)
+                    writePos = 0;
+            }
+
+            endBlock (channel);
+        });
+    }
+
+    /** The smallest fraction of the main delay any active head reads at,
+        this block or the next.
+    */
+    float getShortestRatio (int channel) const noexcept;
+
+    /** Clears the per-head allpass state, e.g. when the interpolation mode changes. */
+    void resetInterpolators() noexcept;
+
+private:
+    template <typename Interpolator, typename History, typename SampleType>
+    void processWith (const History& history, int channel, const BasicDelayKernelContext<SampleType>& c) noexcept
+    {
+        const float* ratioStep = beginBlock (channel, c.numSamples);
+        const SampleType feedback = c.feedback * feedbackNormalisation;
+        int writePos = *c.writePosition;
+
+        for (int sample = 0; sample < c.numSamples; ++sample)
+        {
+            SampleType wetSum, feedbackSum;
+            readHeads<Interpolator> (history, channel, writePos, c.delaySamples[sample], 0.0f,
+                                     ratioStep, wetSum, feedbackSum);
+
+            const SampleType input = c.channelData[sample];
+            c.channelData[sample] = wetSum;
+
+            history.write (writePos, static_cast<decltype (history.read (0))> (input + (feedbackSum * feedback)));
+            if (++writePos == history.size)
+                writePos = 0;
+        }
+
+        endBlock (channel);
+        *c.writePosition = writePos;
+    }
+
+    // One sample of every head: moves each head's spacing one step along its
+    // glide and sums the taps into the output mix and the feedback
+    template <typename Interpolator, typename History, typename SampleType>
+    void readHeads (const History& history, int channel, int writePos, SampleType baseDistance, float distanceOffset,
+                    const float* ratioStep, SampleType& wetSum, SampleType& feedbackSum) noexcept
+    {
+        const auto minDistance = static_cast<SampleType> (interpolationMargin);
+        const auto maxDistance = static_cast<SampleType> (history.size - interpolationMargin);
+        const auto position = static_cast<SampleType> (writePos);
+
+        float* ratio = getRow (currentRatio, channel);
+        double* state = interpolatorState.get() + channel * maxHeads;
+        const float* outputGain = getRow (channelGain, channel);
+
+        wetSum = 0;
+        feedbackSum = 0;
+
+        for (int h = 0; h < numHeads; ++h)
+        {
+            ratio[h] += ratioStep[h];
+
+            const SampleType distance = juce::jlimit (minDistance, maxDistance, baseDistance * ratio[h] - distanceOffset);
+
+            auto headState = static_cast<SampleType> (state[h]);
+            const SampleType tap = readInterpolated<Interpolator> (history, position - distance, headState);
+            state[h] = headState;
+
+            wetSum += outputGain[h] * tap;
+            feedbackSum += level[h] * tap;
+        }
+    }
+
+    // Per-head spacing steps for a glide across numSamples
+    const float* beginBlock (int channel, int numSamples) noexcept;
+
+    // Lands every head exactly on target rather than wherever the float ramp drifted to
+    void endBlock (int channel) noexcept;
+
+    void updateGains() noexcept;
+
+    float* getRow (const juce::HeapBlock<float>& block, int channel) const noexcept
+    {
+        jassert (juce::isPositiveAndBelow (channel, numChannels));
+        return block.get() + channel * maxHeads;
+    }
+
+    int numChannels = 0;
+    int numHeads = minHeads;
+    float feedbackNormalisation = 1.0f;
+    bool gainsNeedUpdate = true;
+
+    // Struct of arrays: one contiguous row per attribute, indexed by head
+    alignas (32) float level[maxHeads] {};
+    alignas (32) float pan[maxHeads] {};
+    alignas (32) float targetRatio[maxHeads] {};
+    alignas (32) float ratioSteps[maxHeads] {};
+
+    // Per-channel rows of maxHeads, one block each, sized in prepare()
+    juce::HeapBlock<float> channelGain;
+    juce::HeapBlock<float> currentRatio;
+    juce::HeapBlock<float> channelSide;
+
+    // Allpass state per head, kept in double so either precision can run
+    // without losing anything; a float loop's values round-trip exactly
+    juce::HeapBlock<double> interpolatorState;
+};
+
+} // namespace ghostline
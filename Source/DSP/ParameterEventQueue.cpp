@@ -0,0 +1,196 @@
+/*
+  ==============================================================================
+
+    ParameterEventQueue.cpp
+
+  ==============================================================================
+*/
+
+#include "ParameterEventQueue.h"
+
+namespace ghostline
+{
+
+static_assert ((ParameterEventQueue::capacity & (ParameterEventQueue::capacity - 1)) == 0,
+               "The queue wraps its positions with a mask");
+
+ParameterEventQueue::ParameterEventQueue() noexcept
+{
+    for (size_t i = 0; i < cells.size(); ++i)
+        cells[i].sequence.store (i, std::memory_order_relaxed);
+}
+
+void ParameterEventQueue::reset() noexcept
+{
+    // Producers may still be adding, so drain rather than rewind
+    int slot;
+    float value;
+    double arrival;
+
+    while (pop (slot, value, arrival)) {}
+
+    overflowed.store (false, std::memory_order_relaxed);
+    numScheduled = nextScheduled = blockLength = 0;
+    ramps = {};
+    blockStart = 0;
+    lastBlockTime = 0.0;
+}
+
+bool ParameterEventQueue::add (int slot, float value, bool stampWithArrivalTime) noexcept
+{
+    const double arrival = stampWithArrivalTime ? juce::Time::getMillisecondCounterHiRes() : 0.0;
+    auto position = enqueuePosition.load (std::memory_order_relaxed);
+
+    for (;;)
+    {
+        auto& cell = cells[position & (capacity - 1)];
+        const auto sequence = cell.sequence.load (std::memory_order_acquire);
+        const auto lead = static_cast<std::ptrdiff_t> (sequence) - static_cast<std::ptrdiff_t> (position);
+
+        if (lead == 0)
+        {
+            // The cell is free: claim it, unless another producer got there first
+            if (enqueuePosition.compare_exchange_weak (position, position + 1, std::memory_order_relaxed))
+            {
+                cell.slot = slot;
+                cell.value = value;
+                cell.arrival = arrival;
+                cell.sequence.store (position + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (lead < 0)
+        {
+            // A whole lap ahead of the reader
+            overflowed.store (true, std::memory_order_relaxed);
+            return false;
+        }
+        else
+        {
+            position = enqueuePosition.load (std::memory_order_relaxed);
+        }
+    }
+}
+
+bool ParameterEventQueue::pop (int& slot, float& value, double& arrival) noexcept
+{
+    auto& cell = cells[dequeuePosition & (capacity - 1)];
+
+    if (cell.sequence.load (std::memory_order_acquire) != dequeuePosition + 1)
+        return false;
+
+    slot = cell.slot;
+    value = cell.value;
+    arrival = cell.arrival;
+    cell.sequence.store (dequeuePosition + capacity, std::memory_order_release);
+    ++dequeuePosition;
+    return true;
+}
+
+//==============================================================================
+void ParameterEventQueue::beginBlock (int numSamples) noexcept
+{
+    const double now = juce::Time::getMillisecondCounterHiRes();
+    const double interval = now - lastBlockTime;
+
+    // Nothing to measure against before the first block
+    const bool canSpread = lastBlockTime > 0.0 && interval > 0.0;
+
+    numScheduled = nextScheduled = 0;
+    blockStart += blockLength;
+    blockLength = numSamples;
+
+    int slot;
+    float value;
+    double arrival;
+
+    while (numScheduled < capacity && pop (slot, value, arrival))
+    {
+        int sample = 0;
+
+        if (canSpread && arrival > lastBlockTime)
+            sample = juce::jlimit (0, juce::jmax (0, numSamples - 1),
+                                   static_cast<int> ((arrival - lastBlockTime) / interval * numSamples));
+
+        // The queue holds changes in the order they happened; never let a
+        // later one land before an earlier one, whichever thread each came from
+        if (numScheduled > 0)
+            sample = juce::jmax (sample, scheduled[static_cast<size_t> (numScheduled - 1)].sample);
+
+        // No arrival time to place it by: ramp there instead of stepping
+        const bool ramped = arrival <= 0.0 && juce::isPositiveAndBelow (slot, maxSlots);
+        scheduled[static_cast<size_t> (numScheduled++)] = { sample, slot, value, ramped };
+    }
+
+    lastBlockTime = now;
+}
+
+int ParameterEventQueue::applyUntil (int sample, float* values) noexcept
+{
+    int applied = 0;
+
+    for (; nextScheduled < numScheduled && scheduled[static_cast<size_t> (nextScheduled)].sample <= sample; ++nextScheduled)
+    {
+        const auto& change = scheduled[static_cast<size_t> (nextScheduled)];
+
+        if (! change.ramped)
+        {
+            values[change.slot] = change.value;
+            ++applied;
+
+            // A placed change overrides any ramp on the same slot
+            if (juce::isPositiveAndBelow (change.slot, maxSlots))
+                ramps[static_cast<size_t> (change.slot)].active = false;
+
+            continue;
+        }
+
+        // A change to a ramping slot starts a fresh ramp from wherever it had got to
+        ramps[static_cast<size_t> (change.slot)] = { true, blockStart + change.sample, blockStart + change.sample,
+                                                     values[change.slot], change.value };
+    }
+
+    const juce::int64 now = blockStart + sample;
+
+    for (size_t slot = 0; slot < ramps.size(); ++slot)
+    {
+        auto& ramp = ramps[slot];
+
+        if (! ramp.active || ramp.nextStep > now)
+            continue;
+
+        // Steps sit on the ramp's own grid, wherever the blocks and sub-blocks fall,
+        // and each holds the value the line reaches at its end
+        const juce::int64 stepsDone = (now - ramp.start) / rampStepSamples + 1;
+        ramp.nextStep = ramp.start + stepsDone * rampStepSamples;
+        const auto progressed = ramp.nextStep - ramp.start;
+
+        if (progressed >= rampLength)
+        {
+            values[slot] = ramp.to;
+            ramp.active = false;
+        }
+        else
+        {
+            const float progress = static_cast<float> (progressed) / static_cast<float> (rampLength);
+            values[slot] = ramp.from + progress * (ramp.to - ramp.from);
+        }
+
+        ++applied;
+    }
+
+    return applied;
+}
+
+int ParameterEventQueue::getNextEventSample() const noexcept
+{
+    int next = nextScheduled < numScheduled ? scheduled[static_cast<size_t> (nextScheduled)].sample : blockLength;
+
+    for (const auto& ramp : ramps)
+        if (ramp.active)
+            next = juce::jmin (next, static_cast<int> (juce::jlimit (juce::int64 (0), juce::int64 (blockLength), ramp.nextStep - blockStart)));
+
+    return next;
+}
+
+} // namespace ghostline
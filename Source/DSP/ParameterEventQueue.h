@@ -0,0 +1,125 @@
+/*
+  ==============================================================================
+
+    ParameterEventQueue.h
+    Parameter changes, timestamped as they arrive and handed to the audio
+    thread as positions within the next block.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace ghostline
+{
+
+//==============================================================================
+/**
+    The plugin wrappers hand over a parameter change without a sample offset,
+    on whichever thread the host or the editor happens to be using. Reading
+    the parameter once per block puts every change on a block boundary, so
+    how finely automation lands depends on the buffer size.
+
+    This keeps each change instead, in a bounded wait-free queue that any
+    number of threads may add to. At the top of a block the audio thread
+    takes everything that arrived since the last one and gives each change a
+    sample position:
+
+        arrival-stamped   Spread across the block in proportion to when it
+                          arrived between the last two blocks, the way
+                          juce::MidiMessageCollector places live MIDI. For
+                          changes from the editor or any other thread that
+                          runs alongside the audio.
+        unstamped         A ramp from the slot's previous value, rampLength
+                          samples long in rampStepSamples steps, that carries
+                          on across block boundaries. For changes made on
+                          the audio thread just before processBlock, and for
+                          offline renders, where wall-clock time means
+                          nothing: host automation arrives this way. The
+                          ramp has the same shape at any buffer size, but
+                          the host hands over one value per block, at the
+                          block's start, so where a ramp begins can still
+                          differ by up to a block between buffer sizes.
+
+    Values are opaque here; a slot is whatever index below maxSlots the
+    caller gives them. If the queue fills, later changes are dropped and
+    takeOverflow() says so, so the caller can fall back to reading the
+    current values.
+*/
+class ParameterEventQueue
+{
+public:
+    static constexpr int capacity = 512;
+    static constexpr int maxSlots = 16;
+    static constexpr int rampStepSamples = 32;
+    static constexpr int rampLength = 8 * rampStepSamples;
+
+    ParameterEventQueue() noexcept;
+
+    /** Forgets everything queued or scheduled. Audio thread stopped; other threads may go on adding. */
+    void reset() noexcept;
+
+    /** Any thread. Returns false if the queue was full and the change was dropped. */
+    bool add (int slot, float value, bool stampWithArrivalTime) noexcept;
+
+    /** Audio thread, once at the top of each block: schedules every change
+        that has arrived since the last call within [0, numSamples).
+    */
+    void beginBlock (int numSamples) noexcept;
+
+    /** Writes every change scheduled at or before sample into values[slot],
+        and every ramping slot's value for the step starting there, and
+        returns how many it wrote.
+    */
+    int applyUntil (int sample, float* values) noexcept;
+
+    /** The position of the next change or ramp step due in this block, or numSamples. */
+    int getNextEventSample() const noexcept;
+
+    /** True once after any change has been dropped. Audio thread. */
+    bool takeOverflow() noexcept        { return overflowed.exchange (false, std::memory_order_relaxed); }
+
+private:
+    bool pop (int& slot, float& value, double& arrival) noexcept;
+
+    struct Cell
+    {
+        std::atomic<size_t> sequence { 0 };
+        int slot = 0;
+        float value = 0.0f;
+        double arrival = 0.0;   // Milliseconds, or 0 for the start of the next block
+    };
+
+    struct Scheduled
+    {
+        int sample, slot;
+        float value;
+        bool ramped;
+    };
+
+    // From the value the slot had when the ramp began, rampLength samples on.
+    // Positions count samples since reset(), so a ramp outlives its block
+    struct Ramp
+    {
+        bool active = false;
+        juce::int64 start = 0, nextStep = 0;
+        float from = 0.0f, to = 0.0f;
+    };
+
+    // Bounded multi-producer queue: each cell's sequence says whose turn it is
+    std::array<Cell, capacity> cells;
+    std::atomic<size_t> enqueuePosition { 0 };
+    size_t dequeuePosition = 0;
+    std::atomic<bool> overflowed { false };
+
+    // Audio thread only: this block's changes in time order
+    std::array<Scheduled, capacity> scheduled;
+    std::array<Ramp, maxSlots> ramps;
+    int numScheduled = 0, nextScheduled = 0, blockLength = 0;
+    juce::int64 blockStart = 0;
+    double lastBlockTime = 0.0;
+};
+
+} // namespace ghostline
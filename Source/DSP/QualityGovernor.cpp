@@ -0,0 +1,153 @@
+/*
+  ==============================================================================
+
+    QualityGovernor.cpp
+
+  ==============================================================================
+*/
+
+#include "QualityGovernor.h"
+
+namespace ghostline
+{
+
+namespace
+{
+    // Load follows a rise within a few blocks and a fall over a third of a second
+    constexpr double riseTimeConstant = 0.02;
+    constexpr double fallTimeConstant = 0.3;
+
+    // Time a step down gets to take effect before the next one
+    constexpr double stepDownHoldOff = 0.25;
+
+    // Time below stepUpLoad before climbing, and its ceiling after repeated bounces
+    constexpr double baseQuietTime = 2.0;
+    constexpr double maxQuietTime = 32.0;
+
+    // A climb undone within this long counts as a bounce
+    constexpr double bounceWindow = 5.0;
+
+    struct TierSettings
+    {
+        const char* name;
+        InterpolationMode maxInterpolation;   // Hermite replaces sinc; linear replaces everything
+        int lfoInterval;
+        int transportInterval;
+    };
+
+    constexpr TierSettings tiers[QualityGovernor::numTiers] =
+    {
+        { "Full",                  InterpolationMode::sinc,    1,   32 },
+        { "Reduced Interpolation", InterpolationMode::hermite, 1,   32 },
+        { "Control-Rate LFO",      InterpolationMode::hermite, 32,  32 },
+        { "Minimal",               InterpolationMode::linear,  128, 128 }
+    };
+}
+
+//==============================================================================
+void QualityGovernor::prepare (double sampleRate) noexcept
+{
+    currentSampleRate = sampleRate;
+    reset();
+}
+
+void QualityGovernor::reset() noexcept
+{
+    smoothedLoad = 0.0;
+    secondsSinceChange = 0.0;
+    secondsBelowStepUp = 0.0;
+    quietTimeNeeded = baseQuietTime;
+    lastChangeWasUp = false;
+
+    tier.store (0, std::memory_order_relaxed);
+    load.store (0.0f, std::memory_order_relaxed);
+}
+
+void QualityGovernor::setEnabled (bool shouldBeEnabled) noexcept
+{
+    if (enabled == shouldBeEnabled)
+        return;
+
+    enabled = shouldBeEnabled;
+    reset();
+}
+
+juce::String QualityGovernor::getTierName (int tierIndex)
+{
+    return tiers[juce::jlimit (0, numTiers - 1, tierIndex)].name;
+}
+
+//==============================================================================
+void QualityGovernor::addBlock (double elapsedSeconds, int numSamples) noexcept
+{
+    if (numSamples <= 0)
+        return;
+
+    const double budget = numSamples / currentSampleRate;
+    const double blockLoad = elapsedSeconds / budget;
+
+    const double timeConstant = blockLoad > smoothedLoad ? riseTimeConstant : fallTimeConstant;
+    smoothedLoad += (blockLoad - smoothedLoad) * (1.0 - std::exp (-budget / timeConstant));
+    load.store (static_cast<float> (smoothedLoad), std::memory_order_relaxed);
+
+    if (! enabled)
+        return;
+
+    secondsSinceChange += budget;
+    secondsBelowStepUp = smoothedLoad < stepUpLoad ? secondsBelowStepUp + budget : 0.0;
+
+    const int current = getTier();
+
+    if (smoothedLoad > stepDownLoad && current < numTiers - 1 && secondsSinceChange >= stepDownHoldOff)
+    {
+        // The last climb cost more than there was room for: wait longer next time
+        if (lastChangeWasUp && secondsSinceChange < bounceWindow)
+            quietTimeNeeded = juce::jmin (maxQuietTime, quietTimeNeeded * 2.0);
+
+        setTier (current + 1);
+        lastChangeWasUp = false;
+    }
+    else if (current > 0 && secondsBelowStepUp >= quietTimeNeeded)
+    {
+        // A climb that held for a whole bounce window earns the short wait back
+        if (lastChangeWasUp && secondsSinceChange >= bounceWindow)
+            quietTimeNeeded = baseQuietTime;
+
+        setTier (current - 1);
+        lastChangeWasUp = true;
+    }
+}
+
+void QualityGovernor::setTier (int newTier) noexcept
+{
+    tier.store (newTier, std::memory_order_relaxed);
+    secondsSinceChange = 0.0;
+    secondsBelowStepUp = 0.0;
+}
+
+//==============================================================================
+InterpolationMode QualityGovernor::limitInterpolation (InterpolationMode requested) const noexcept
+{
+    const auto ceiling = tiers[getTier()].maxInterpolation;
+
+    if (ceiling == InterpolationMode::linear)
+        return InterpolationMode::linear;
+
+    // Sinc is the only read costlier than Hermite
+    if (ceiling == InterpolationMode::hermite && requested == InterpolationMode::sinc)
+        return InterpolationMode::hermite;
+
+    return requested;
+}
+
+int QualityGovernor::getLfoInterval() const noexcept
+{
+    return tiers[getTier()].lfoInterval;
+}
+
+int QualityGovernor::getTransportInterval() const noexcept
+{
+    return tiers[getTier()].transportInterval;
+}
+
+} // namespace ghostline
@@ -0,0 +1,87 @@
+/*
+  ==============================================================================
+
+    QualityGovernor.h
+    Watches how much of each block's real-time budget processBlock uses and
+    trades modulation and interpolation quality for headroom when it runs short.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Interpolators.h"
+
+namespace ghostline
+{
+
+//==============================================================================
+/**
+    Four tiers, each cheaper than the last:
+
+        0  Full                  Everything as set
+        1  Reduced interpolation Sinc reads fall back to Hermite
+        2  Control-rate LFO      The LFO is evaluated every 32 samples and
+                                 drawn as straight lines in between
+        3  Minimal               Linear reads; LFO and tape transport every 128 samples
+
+    The load is time spent / block duration, followed quickly on the way up
+    and slowly on the way down. Above stepDownLoad the governor drops a tier
+    at once (after a short hold-off, so one step has time to show). Below
+    stepUpLoad it climbs back one tier at a time, but only after the load has
+    stayed there for the quiet time; a climb that has to be undone soon after
+    doubles the quiet time, so a session on the edge settles instead of
+    swinging between two tiers.
+
+    Everything runs on the audio thread except getTier() and getLoad(), which
+    any thread may call.
+*/
+class QualityGovernor
+{
+public:
+    static constexpr int numTiers = 4;
+
+    static constexpr float stepDownLoad = 0.7f;
+    static constexpr float stepUpLoad = 0.35f;
+
+    void prepare (double sampleRate) noexcept;
+    void reset() noexcept;
+
+    /** Disabled, the governor stays on full quality, e.g. for offline renders. */
+    void setEnabled (bool shouldBeEnabled) noexcept;
+
+    /** Takes one block's processing time, as measured by BlockProfiler. Audio thread. */
+    void addBlock (double elapsedSeconds, int numSamples) noexcept;
+
+    int getTier() const noexcept                          { return tier.load (std::memory_order_relaxed); }
+    float getLoad() const noexcept                        { return load.load (std::memory_order_relaxed); }
+    static juce::String getTierName (int tierIndex);
+
+    /** The interpolation to use in place of requested at the current tier. */
+    InterpolationMode limitInterpolation (InterpolationMode requested) const noexcept;
+
+    /** Samples between evaluated LFO values; 1 is audio rate. */
+    int getLfoInterval() const noexcept;
+
+    /** Samples between evaluated wow and flutter values. */
+    int getTransportInterval() const noexcept;
+
+private:
+    void setTier (int newTier) noexcept;
+
+    double currentSampleRate = 44100.0;
+    bool enabled = true;
+
+    // Load and timers, all in seconds of audio rather than wall-clock time
+    double smoothedLoad = 0.0;
+    double secondsSinceChange = 0.0;
+    double secondsBelowStepUp = 0.0;
+    double quietTimeNeeded = 0.0;
+    bool lastChangeWasUp = false;
+
+    std::atomic<int> tier { 0 };
+    std::atomic<float> load { 0.0f };
+};
+
+} // namespace ghostline
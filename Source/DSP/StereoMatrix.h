@@ -0,0 +1,108 @@
+/*
+  ==============================================================================
+
+    StereoMatrix.h
+    Routing between the two sides of a stereo loop: cross-feedback and
+    ping-pong, set once per block and applied a chunk at a time.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace ghostline
+{
+
+//==============================================================================
+enum class StereoMode
+{
+    independent = 0,    // Each side is its own loop
+    crossFeedback,      // Each side feeds back a share of the other's echo
+    pingPong            // The input goes in on the left and every echo swaps sides
+};
+
+/**
+    The 2x2 feedback matrix is
+
+        | 1 - cross    cross   |
+        |  cross     1 - cross |
+
+    whose eigenvalues are 1 and 1 - 2 cross, so however much crosses over
+    the loop gain never rises above FEEDBACK. Ping-pong is cross = 1 with
+    the input folded to mono and fed to the left side only, so the first
+    echo comes back on the left, the second on the right, and so on.
+
+    Both coefficients glide a little each block, like the LFO spread, so
+    changing mode bends the echoes across rather than cutting them off.
+    Until both are back at 0 the pair counts as linked.
+*/
+class StereoMatrix
+{
+public:
+    static constexpr float maxStepPerBlock = 0.01f;
+
+    /** Call once per block; crossAmount is in [0, 1] and only used in crossFeedback. */
+    void setParameters (StereoMode newMode, float crossAmount) noexcept
+    {
+        targetCross = newMode == StereoMode::pingPong      ? 1.0f
+                    : newMode == StereoMode::crossFeedback ? juce::jlimit (0.0f, 1.0f, crossAmount)
+                                                           : 0.0f;
+        targetFold = newMode == StereoMode::pingPong ? 1.0f : 0.0f;
+
+        cross += juce::jlimit (-maxStepPerBlock, maxStepPerBlock, targetCross - cross);
+        fold += juce::jlimit (-maxStepPerBlock, maxStepPerBlock, targetFold - fold);
+    }
+
+    /** Jumps to the settings instead of gliding there. */
+    void reset() noexcept
+    {
+        cross = targetCross;
+        fold = targetFold;
+    }
+
+    /** True while either side hears anything of the other. */
+    bool isLinked() const noexcept      { return cross > 0.0f || fold > 0.0f; }
+
+    /** Folds the ping-pong input onto the left side, in place. */
+    template <typename SampleType>
+    void routeInput (SampleType* left, SampleType* right, int numSamples) const noexcept
+    {
+        if (fold == 0.0f)
+            return;
+
+        const auto amount = static_cast<SampleType> (fold);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const SampleType mono = SampleType (0.5) * (left[i] + right[i]);
+            left[i] += amount * (mono - left[i]);
+            right[i] -= amount * right[i];
+        }
+    }
+
+    /** Sends each side's fed-back echo through the matrix, in place. */
+    template <typename SampleType>
+    void mix (SampleType* left, SampleType* right, int numSamples) const noexcept
+    {
+        if (cross == 0.0f)
+            return;
+
+        const auto across = static_cast<SampleType> (cross);
+        const auto along = SampleType (1) - across;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const SampleType l = left[i], r = right[i];
+            left[i] = along * l + across * r;
+            right[i] = along * r + across * l;
+        }
+    }
+
+private:
+    float targetCross = 0.0f, targetFold = 0.0f;
+    float cross = 0.0f, fold = 0.0f;
+};
+
+} // namespace ghostline
@@ -0,0 +1,316 @@
+/*
+  ==============================================================================
+
+    TapeModel.cpp
+
+  ==============================================================================
+*/
+
+#include "TapeModel.h"
+
+namespace ghostline
+{
+
+namespace
+{
+    // Fills output with one period of noise with the given magnitude per bin
+    // and a random phase; the caller normalises the level
+    template <typename MagnitudeFunction>
+    void makeBandLimitedNoise (int order, juce::int64 seed, float* output, MagnitudeFunction&& magnitude)
+    {
+        juce::dsp::FFT fft (order);
+        const int size = fft.getSize();
+
+        std::vector<float> spectrum (static_cast<size_t> (2 * size), 0.0f);
+        juce::Random random (seed);
+
+        // Bin 0 and Nyquist stay empty: no DC, nothing the table can't represent
+        for (int bin = 1; bin < size / 2; ++bin)
+        {
+            const float phase = random.nextFloat() * juce::MathConstants<float>::twoPi;
+            const float m = magnitude (bin);
+
+            spectrum[static_cast<size_t> (2 * bin)] = m * std::cos (phase);
+            spectrum[static_cast<size_t> (2 * bin + 1)] = m * std::sin (phase);
+        }
+
+        fft.performRealOnlyInverseTransform (spectrum.data());
+        std::copy (spectrum.begin(), spectrum.begin() + size, output);
+    }
+
+    // Period of one pass through the modulation table, in seconds
+    constexpr double wowPeriod = 16.0;      // 0.25 - 2 Hz
+    constexpr double flutterPeriod = 0.8;   // 5 - 40 Hz
+
+    // Largest excursion of the read distance, in seconds
+    constexpr float maxWowDepth = 0.003f;
+    constexpr float maxFlutterDepth = 0.0002f;
+
+    // Head bump: the low-frequency lift of a playback head whose gap is short
+    // next to the wavelength on tape
+    constexpr double headBumpFrequency = 90.0;
+    constexpr double headBumpQ = 1.0;
+    constexpr double headBumpGainDecibels = 3.0;
+
+    // HF loss cutoff from a fresh tape to a worn one
+    constexpr double freshCutoff = 16000.0;
+    constexpr double wornCutoff = 2500.0;
+
+    std::atomic<juce::uint32> instanceCounter { 0 };
+}
+
+//==============================================================================
+TapeNoiseTables::TapeNoiseTables()
+    : hiss (static_cast<size_t> (hissSize))
+{
+    // Wow and flutter: falling 1/f across the band, so the slowest drift dominates
+    makeBandLimitedNoise (12, 0x5eed7a9e, modulation.data(), [] (int bin)
+    {
+        return bin >= lowestModulationBin && bin <= highestModulationBin ? 1.0f / static_cast<float> (bin) : 0.0f;
+    });
+
+    float peak = 0.0f;
+    for (int i = 0; i < modulationSize; ++i)
+        peak = juce::jmax (peak, std::abs (modulation[static_cast<size_t> (i)]));
+
+    for (int i = 0; i < modulationSize; ++i)
+        modulation[static_cast<size_t> (i)] /= peak;
+
+    modulation[modulationSize] = modulation[0];
+    modulation[modulationSize + 1] = modulation[1];
+
+    // Hiss: rising through the lower mids, flat on top, gently rolled off
+    // before Nyquist. Shaped in bins, so the colour follows the sample rate.
+    makeBandLimitedNoise (16, 0x41551ead, hiss.data(), [] (int bin)
+    {
+        const float knee = hissSize / 96.0f;
+        const float rolloff = bin / (hissSize * 0.42f);
+
+        return std::sqrt (bin / (bin + knee)) / std::sqrt (1.0f + rolloff * rolloff * rolloff * rolloff);
+    });
+
+    double sumOfSquares = 0.0;
+    for (auto sample : hiss)
+        sumOfSquares += static_cast<double> (sample) * sample;
+
+    const auto scale = static_cast<float> (1.0 / std::sqrt (sumOfSquares / hissSize));
+    for (auto& sample : hiss)
+        sample *= scale;
+}
+
+const TapeNoiseTables& TapeNoiseTables::getInstance()
+{
+    static const TapeNoiseTables tables;
+    return tables;
+}
+
+//==============================================================================
+TapeModel::TapeModel()
+{
+    // Knuth's multiplicative hash spreads consecutive instances across the table
+    hissStart = static_cast<int> ((instanceCounter++ * 2654435761u) % static_cast<juce::uint32> (TapeNoiseTables::hissSize));
+}
+
+void TapeModel::prepare (double sampleRate, int numChannels)
+{
+    currentSampleRate = sampleRate;
+    channels.resize (static_cast<size_t> (juce::jmax (1, numChannels)));
+
+    wowIncrement = static_cast<float> (TapeNoiseTables::modulationSize / (wowPeriod * sampleRate));
+    flutterIncrement = static_cast<float> (TapeNoiseTables::modulationSize / (flutterPeriod * sampleRate));
+
+    wowDepth = wowAmount * maxWowDepth * static_cast<float> (sampleRate);
+    flutterDepth = flutterAmount * maxFlutterDepth * static_cast<float> (sampleRate);
+    updateFilters();
+
+    reset();
+}
+
+void TapeModel::reset() noexcept
+{
+    const int numChannels = static_cast<int> (channels.size());
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto& state = channels[static_cast<size_t> (ch)];
+
+        state.wowPosition = 0.0f;
+        state.flutterPosition = static_cast<float> (ch * TapeNoiseTables::modulationSize / numChannels);
+
+        // Start on the curve rather than gliding onto it
+        state.currentOffset = wowDepth * tables.getModulation (state.wowPosition)
+                            + flutterDepth * tables.getModulation (state.flutterPosition);
+
+        state.wetFilter = {};
+        state.feedbackFilter = {};
+        state.hissPosition = (hissStart + ch * (TapeNoiseTables::hissSize / numChannels)) % TapeNoiseTables::hissSize;
+    }
+}
+
+void TapeModel::setParameters (float wow, float flutter, float hiss, float age) noexcept
+{
+    const auto sampleRate = static_cast<float> (currentSampleRate);
+
+    wowAmount = wow;
+    flutterAmount = flutter;
+    wowDepth = wow * maxWowDepth * sampleRate;
+    flutterDepth = flutter * maxFlutterDepth * sampleRate;
+
+    // -84 to -48 dB RMS: audible on long tails, never louder than the echoes
+    hissGain = hiss > 0.0f ? juce::Decibels::decibelsToGain (-84.0f + 36.0f * hiss) : 0.0f;
+
+    if (age != tapeAge)
+    {
+        tapeAge = age;
+        updateFilters();
+    }
+}
+
+void TapeModel::updateFilters() noexcept
+{
+    const double nyquistLimit = currentSampleRate * 0.45;
+    const double cutoff = juce::jmin (nyquistLimit, freshCutoff * std::pow (wornCutoff / freshCutoff, static_cast<double> (tapeAge)));
+    lowpassCoefficient = 1.0 - std::exp (-juce::MathConstants<double>::twoPi * cutoff / currentSampleRate);
+
+    // RBJ peaking EQ, normalised by a0
+    const double A = std::pow (10.0, headBumpGainDecibels / 40.0);
+    const double w0 = juce::MathConstants<double>::twoPi * headBumpFrequency / currentSampleRate;
+    const double alpha = std::sin (w0) / (2.0 * headBumpQ);
+    const double cosW0 = std::cos (w0);
+    const double a0 = 1.0 + alpha / A;
+
+    b0 = (1.0 + alpha * A) / a0;
+    b1 = -2.0 * cosW0 / a0;
+    b2 = (1.0 - alpha * A) / a0;
+    a1 = -2.0 * cosW0 / a0;
+    a2 = (1.0 - alpha / A) / a0;
+
+    // The lowpass never boosts, so the bump's peak is the whole filter's peak
+    loopNormalisation = 1.0 / (A * A);
+}
+
+//==============================================================================
+template <typename SampleType>
+void TapeModel::modulate (int channel, SampleType* delaySamples, int numSamples, SampleType minDistance, SampleType maxDistance) noexcept
+{
+    jassert (juce::isPositiveAndBelow (channel, static_cast<int> (channels.size())));
+
+    constexpr auto tableSize = static_cast<float> (TapeNoiseTables::modulationSize);
+    auto& state = channels[static_cast<size_t> (channel)];
+    float& wow = state.wowPosition;
+    float& flutter = state.flutterPosition;
+    float offset = state.currentOffset;
+
+    for (int start = 0; start < numSamples; start += controlInterval)
+    {
+        const int length = juce::jmin (controlInterval, numSamples - start);
+
+        wow += wowIncrement * static_cast<float> (length);
+        if (wow >= tableSize)
+            wow -= tableSize;
+
+        flutter += flutterIncrement * static_cast<float> (length);
+        if (flutter >= tableSize)
+            flutter -= tableSize;
+
+        const float target = wowDepth * tables.getModulation (wow) + flutterDepth * tables.getModulation (flutter);
+        const float step = (target - offset) / static_cast<float> (length);
+
+        SampleType* distances = delaySamples + start;
+        for (int i = 0; i < length; ++i)
+            distances[i] = juce::jlimit (minDistance, maxDistance, distances[i] + offset + step * static_cast<float> (i + 1));
+
+        offset = target;
+    }
+
+    state.currentOffset = offset;
+}
+
+template <typename SampleType>
+void TapeModel::colour (int channel, SampleType* wet, SampleType* feedback, int numSamples, bool feedbackIsSameEcho) noexcept
+{
+    jassert (juce::isPositiveAndBelow (channel, static_cast<int> (channels.size())));
+
+    auto& state = channels[static_cast<size_t> (channel)];
+    const auto normalisation = static_cast<SampleType> (loopNormalisation);
+    filter (state.wetFilter, wet, numSamples);
+
+    if (feedbackIsSameEcho)
+    {
+        juce::FloatVectorOperations::copyWithMultiply (feedback, wet, normalisation, numSamples);
+    }
+    else
+    {
+        filter (state.feedbackFilter, feedback, numSamples);
+        juce::FloatVectorOperations::multiply (feedback, normalisation, numSamples);
+    }
+
+    if (hissGain > 0.0f)
+        addHiss (state.hissPosition, wet, feedback, numSamples);
+}
+
+template <typename SampleType>
+void TapeModel::filter (PlaybackFilter& state, SampleType* samples, int numSamples) const noexcept
+{
+    const auto coefficient = static_cast<SampleType> (lowpassCoefficient);
+    const auto n0 = static_cast<SampleType> (b0), n1 = static_cast<SampleType> (b1), n2 = static_cast<SampleType> (b2);
+    const auto d1 = static_cast<SampleType> (a1), d2 = static_cast<SampleType> (a2);
+
+    auto lowpass = static_cast<SampleType> (state.lowpass);
+    auto z1 = static_cast<SampleType> (state.z1);
+    auto z2 = static_cast<SampleType> (state.z2);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        lowpass += coefficient * (samples[i] - lowpass);
+
+        // Transposed direct form II
+        const SampleType y = n0 * lowpass + z1;
+        z1 = n1 * lowpass - d1 * y + z2;
+        z2 = n2 * lowpass - d2 * y;
+        samples[i] = y;
+    }
+
+    state.lowpass = lowpass;
+    state.z1 = z1;
+    state.z2 = z2;
+}
+
+template <typename SampleType>
+void TapeModel::addHiss (int& position, SampleType* wet, SampleType* feedback, int numSamples) const noexcept
+{
+    // Straight table playback, in at most two runs around the wrap
+    const float* hiss = tables.getHiss();
+
+    for (int done = 0; done < numSamples;)
+    {
+        const int length = juce::jmin (numSamples - done, TapeNoiseTables::hissSize - position);
+
+        if constexpr (std::is_same_v<SampleType, float>)
+        {
+            juce::FloatVectorOperations::addWithMultiply (wet + done, hiss + position, hissGain, length);
+            juce::FloatVectorOperations::addWithMultiply (feedback + done, hiss + position, hissGain, length);
+        }
+        else
+        {
+            for (int i = 0; i < length; ++i)
+            {
+                const auto noise = static_cast<SampleType> (hissGain * hiss[position + i]);
+                wet[done + i] += noise;
+                feedback[done + i] += noise;
+            }
+        }
+
+        done += length;
+        position += length;
+        if (position == TapeNoiseTables::hissSize)
+            position = 0;
+    }
+}
+
+template void TapeModel::modulate (int, float*, int, float, float) noexcept;
+template void TapeModel::modulate (int, double*, int, double, double) noexcept;
+template void TapeModel::colour (int, float*, float*, int, bool) noexcept;
+template void TapeModel::colour (int, double*, double*, int, bool) noexcept;
+
+} // namespace ghostline
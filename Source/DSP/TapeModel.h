@@ -0,0 +1,157 @@
+/*
+  ==============================================================================
+
+    TapeModel.h
+    Tape transport and playback colour for the echo loop: wow and flutter on
+    the read position, then head bump, high-frequency loss and hiss on every
+    pass through the playback head. All noise is read from process-wide
+    tables, never generated per sample.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace ghostline
+{
+
+//==============================================================================
+/**
+    Band-limited noise built once for the process by inverse FFT of a shaped,
+    random-phase spectrum. Each table is exactly periodic, so it loops without
+    a seam, and holds no energy outside the bins it was built from.
+    About 280 KB for the whole process, no matter how many instances are loaded.
+*/
+class TapeNoiseTables
+{
+public:
+    static constexpr int modulationSize = 4096;
+    static constexpr int hissSize = 65536;
+
+    // The modulation table holds bins 4 to 32 of its length: read once every
+    // P seconds it moves between 4 / P and 32 / P Hz
+    static constexpr int lowestModulationBin = 4;
+    static constexpr int highestModulationBin = 32;
+
+    static const TapeNoiseTables& getInstance();
+
+    /** Slow noise with peaks at +-1. position is in [0, modulationSize). */
+    float getModulation (float position) const noexcept
+    {
+        const int index = static_cast<int> (position);
+        const float fraction = position - static_cast<float> (index);
+
+        return modulation[static_cast<size_t> (index)] + fraction * (modulation[static_cast<size_t> (index + 1)] - modulation[static_cast<size_t> (index)]);
+    }
+
+    /** Unit-RMS hiss, rising towards the top octaves, played back one point per sample. */
+    const float* getHiss() const noexcept     { return hiss.data(); }
+
+private:
+    TapeNoiseTables();
+
+    // Two guard points, as in SineTable
+    std::array<float, modulationSize + 2> modulation;
+    std::vector<float> hiss;
+};
+
+//==============================================================================
+/**
+    The transport (wow and flutter) moves the read distance before the delay
+    kernels run. The playback colour runs inside the echo loop on what the
+    heads just read, so every repeat is filtered once more than the last.
+
+    Wow follows the transport and is the same on every channel. Flutter reads
+    its table an equal share of a period apart per channel, like scrape
+    flutter on slightly different track positions, so the channels drift
+    against each other.
+*/
+class TapeModel
+{
+public:
+    // Wow and flutter are evaluated this often and ramped in between, unless
+    // setControlInterval() trades resolution for time
+    static constexpr int defaultControlInterval = 32;
+
+    TapeModel();
+
+    /** Sizes the per-channel state. Not realtime-safe. */
+    void prepare (double sampleRate, int numChannels);
+    void reset() noexcept;
+
+    void setEnabled (bool shouldBeEnabled) noexcept     { enabled = shouldBeEnabled; }
+    bool isEnabled() const noexcept                     { return enabled; }
+
+    void setControlInterval (int samples) noexcept      { controlInterval = juce::jmax (1, samples); }
+
+    /** All four in [0, 1]. age sets how much top end each pass through the heads loses. */
+    void setParameters (float wow, float flutter, float hiss, float age) noexcept;
+
+    /** Adds wow and flutter to numSamples read distances, keeping them inside
+        [minDistance, maxDistance]. Instantiated for float and double, as is colour().
+    */
+    template <typename SampleType>
+    void modulate (int channel, SampleType* delaySamples, int numSamples, SampleType minDistance, SampleType maxDistance) noexcept;
+
+    /** Colours the echo just read: head bump and HF loss, then hiss. What is
+        fed back is scaled so the bump never lifts the loop gain above FEEDBACK.
+        When feedbackIsSameEcho is set (one head), only wet is filtered and
+        feedback is rewritten from it; otherwise the two run through their
+        own filters.
+    */
+    template <typename SampleType>
+    void colour (int channel, SampleType* wet, SampleType* feedback, int numSamples, bool feedbackIsSameEcho) noexcept;
+
+private:
+    // Filter state and coefficients are held in double and run in the
+    // caller's precision; a float loop's state round-trips exactly
+    struct PlaybackFilter
+    {
+        double lowpass = 0.0;
+        double z1 = 0.0, z2 = 0.0;
+    };
+
+    struct ChannelState
+    {
+        float wowPosition = 0.0f;
+        float flutterPosition = 0.0f;
+        float currentOffset = 0.0f;
+        PlaybackFilter wetFilter, feedbackFilter;
+        int hissPosition = 0;
+    };
+
+    template <typename SampleType>
+    void filter (PlaybackFilter& state, SampleType* samples, int numSamples) const noexcept;
+
+    template <typename SampleType>
+    void addHiss (int& position, SampleType* wet, SampleType* feedback, int numSamples) const noexcept;
+    void updateFilters() noexcept;
+
+    bool enabled = false;
+    int controlInterval = defaultControlInterval;
+    double currentSampleRate = 44100.0;
+
+    // Transport, in samples of read distance and table points per sample
+    float wowAmount = 0.0f, flutterAmount = 0.0f;
+    float wowDepth = 0.0f, flutterDepth = 0.0f;
+    float wowIncrement = 0.0f, flutterIncrement = 0.0f;
+
+    // Playback colour: one-pole HF loss into a peaking biquad for the head bump
+    float tapeAge = 0.0f;
+    double lowpassCoefficient = 1.0;
+    double b0 = 1.0, b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;
+    double loopNormalisation = 1.0;
+
+    // Each instance starts its hiss somewhere else in the table, so two
+    // tracks running the plugin don't sum correlated noise
+    float hissGain = 0.0f;
+    int hissStart = 0;
+
+    std::vector<ChannelState> channels;
+
+    const TapeNoiseTables& tables = TapeNoiseTables::getInstance();
+};
+
+} // namespace ghostline
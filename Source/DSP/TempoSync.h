@@ -0,0 +1,109 @@
+/*
+  ==============================================================================
+
+    TempoSync.h
+    Note divisions and the host transport, resolved once per block.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace ghostline
+{
+
+//==============================================================================
+struct NoteDivision
+{
+    const char* name;
+    double beats;   // Length in quarter notes
+};
+
+/** Straight, dotted and triplet divisions, shortest first. */
+inline const std::array<NoteDivision, 19>& getNoteDivisions()
+{
+    static const std::array<NoteDivision, 19> divisions {{
+        { "1/32",   0.125 },
+        { "1/16 T", 1.0 / 6.0 },
+        { "1/32 D", 0.1875 },
+        { "1/16",   0.25 },
+        { "1/8 T",  1.0 / 3.0 },
+        { "1/16 D", 0.375 },
+        { "1/8",    0.5 },
+        { "1/4 T",  2.0 / 3.0 },
+        { "1/8 D",  0.75 },
+        { "1/4",    1.0 },
+        { "1/2 T",  4.0 / 3.0 },
+        { "1/4 D",  1.5 },
+        { "1/2",    2.0 },
+        { "1/1 T",  8.0 / 3.0 },
+        { "1/2 D",  3.0 },
+        { "1/1",    4.0 },
+        { "1/1 D",  6.0 },
+        { "2/1",    8.0 },
+        { "4/1",    16.0 }
+    }};
+
+    return divisions;
+}
+
+inline juce::StringArray getNoteDivisionNames()
+{
+    juce::StringArray names;
+
+    for (const auto& division : getNoteDivisions())
+        names.add (division.name);
+
+    return names;
+}
+
+inline double getNoteDivisionBeats (int index) noexcept
+{
+    const auto& divisions = getNoteDivisions();
+    return divisions[static_cast<size_t> (juce::jlimit (0, static_cast<int> (divisions.size()) - 1, index))].beats;
+}
+
+//==============================================================================
+/** What the host told us at the start of the current block. */
+struct TransportState
+{
+    double bpm = 120.0;
+    double ppqPosition = 0.0;
+    bool hasPosition = false;   // True while the host is playing and reports a PPQ position
+
+    void update (juce::AudioPlayHead* playHead) noexcept
+    {
+        hasPosition = false;
+
+        if (playHead == nullptr)
+            return;
+
+        if (const auto position = playHead->getPosition())
+        {
+            if (const auto hostBpm = position->getBpm())
+                if (*hostBpm > 0.0)
+                    bpm = *hostBpm;
+
+            if (const auto ppq = position->getPpqPosition())
+            {
+                ppqPosition = *ppq;
+                hasPosition = position->getIsPlaying();
+            }
+        }
+    }
+
+    double getSecondsForBeats (double beats) const noexcept
+    {
+        return beats * 60.0 / bpm;
+    }
+
+    /** Where the host will be numSamples into the block, at a steady tempo. */
+    double getPpqPositionAfter (int numSamples, double sampleRate) const noexcept
+    {
+        return ppqPosition + numSamples * bpm / (60.0 * sampleRate);
+    }
+};
+
+} // namespace ghostline
@@ -0,0 +1,106 @@
+/*
+  ==============================================================================
+
+    VisualiserFeed.cpp
+
+  ==============================================================================
+*/
+
+#include "VisualiserFeed.h"
+
+namespace ghostline
+{
+
+VisualiserFeed::VisualiserFeed()
+{
+    envelopeFrames.calloc (static_cast<size_t> (envelopeCapacity));
+    spectrumSamples.calloc (static_cast<size_t> (spectrumCapacity));
+}
+
+void VisualiserFeed::prepare (double sampleRate) noexcept
+{
+    envelopeLength = juce::jmax (1, juce::roundToInt (sampleRate * envelopeSeconds));
+    decimation = juce::jmax (1, static_cast<int> (std::ceil (sampleRate / maxSpectrumRate)));
+    spectrumRate.store (sampleRate / decimation, std::memory_order_relaxed);
+
+    envelopeCount = decimationCount = 0;
+    envelopePeak = decimationSum = 0.0f;
+}
+
+template <typename SampleType>
+void VisualiserFeed::push (const SampleType* echo, int numSamples) noexcept
+{
+    if (! active.load (std::memory_order_relaxed))
+        return;
+
+    // Decimated samples go into the FIFO a batch at a time rather than one by one
+    constexpr int batchSize = 256;
+    float batch[batchSize];
+    int batched = 0;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto sample = static_cast<float> (echo[i]);
+        envelopePeak = juce::jmax (envelopePeak, std::abs (sample));
+        decimationSum += sample;
+
+        if (++envelopeCount == envelopeLength)
+        {
+            write (envelopeFifo, envelopeFrames, &envelopePeak, 1);
+            envelopeCount = 0;
+            envelopePeak = 0.0f;
+        }
+
+        if (++decimationCount == decimation)
+        {
+            batch[batched++] = decimationSum / static_cast<float> (decimation);
+            decimationCount = 0;
+            decimationSum = 0.0f;
+
+            if (batched == batchSize)
+            {
+                write (spectrumFifo, spectrumSamples, batch, batched);
+                batched = 0;
+            }
+        }
+    }
+
+    write (spectrumFifo, spectrumSamples, batch, batched);
+}
+
+template void VisualiserFeed::push (const float*, int) noexcept;
+template void VisualiserFeed::push (const double*, int) noexcept;
+
+int VisualiserFeed::popEnvelope (float* destination, int maxFrames) noexcept
+{
+    return read (envelopeFifo, envelopeFrames, destination, maxFrames);
+}
+
+int VisualiserFeed::popSpectrum (float* destination, int maxSamples) noexcept
+{
+    return read (spectrumFifo, spectrumSamples, destination, maxSamples);
+}
+
+void VisualiserFeed::write (juce::AbstractFifo& fifo, float* storage, const float* values, int numValues) noexcept
+{
+    if (numValues <= 0)
+        return;
+
+    // Whatever doesn't fit is dropped: the reader is behind or away
+    const auto scope = fifo.write (numValues);
+
+    std::copy (values, values + scope.blockSize1, storage + scope.startIndex1);
+    std::copy (values + scope.blockSize1, values + scope.blockSize1 + scope.blockSize2, storage + scope.startIndex2);
+}
+
+int VisualiserFeed::read (juce::AbstractFifo& fifo, const float* storage, float* destination, int maxItems) noexcept
+{
+    const auto scope = fifo.read (maxItems);
+
+    std::copy (storage + scope.startIndex1, storage + scope.startIndex1 + scope.blockSize1, destination);
+    std::copy (storage + scope.startIndex2, storage + scope.startIndex2 + scope.blockSize2, destination + scope.blockSize1);
+
+    return scope.blockSize1 + scope.blockSize2;
+}
+
+} // namespace ghostline
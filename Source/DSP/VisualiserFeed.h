@@ -0,0 +1,76 @@
+/*
+  ==============================================================================
+
+    VisualiserFeed.h
+    Hands the echo from the audio thread to the editor's visualiser through
+    wait-free single-producer, single-consumer FIFOs.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace ghostline
+{
+
+//==============================================================================
+/**
+    Two streams, both already thinned out on the audio thread:
+
+        envelope   The echo's peak magnitude over each envelopeSeconds, for
+                   the scrolling decay trace
+        spectrum   The echo itself, averaged down by a whole factor to at
+                   most maxSpectrumRate, for the spectrogram
+
+    Pushing costs a pass over one channel of the block, and nothing at all
+    while no editor has called setActive (true). The storage is allocated
+    once, up front, so prepare() never pulls it from under the reader. When
+    the editor falls behind, the FIFOs fill and new frames are dropped.
+*/
+class VisualiserFeed
+{
+public:
+    static constexpr double envelopeSeconds = 0.01;
+    static constexpr double maxSpectrumRate = 48000.0;
+
+    static constexpr int envelopeCapacity = 1024;
+    static constexpr int spectrumCapacity = 1 << 15;
+
+    VisualiserFeed();
+
+    /** Audio thread stopped. */
+    void prepare (double sampleRate) noexcept;
+
+    /** Set by the editor while it is on screen. Any thread. */
+    void setActive (bool shouldBeActive) noexcept     { active.store (shouldBeActive, std::memory_order_relaxed); }
+
+    /** Audio thread. Instantiated for float and double. */
+    template <typename SampleType>
+    void push (const SampleType* echo, int numSamples) noexcept;
+
+    /** Reader side: copies out up to maxFrames and returns how many there were. */
+    int popEnvelope (float* destination, int maxFrames) noexcept;
+    int popSpectrum (float* destination, int maxSamples) noexcept;
+
+    double getSpectrumRate() const noexcept           { return spectrumRate.load (std::memory_order_relaxed); }
+
+private:
+    static void write (juce::AbstractFifo&, float* storage, const float* values, int numValues) noexcept;
+    static int read (juce::AbstractFifo&, const float* storage, float* destination, int maxItems) noexcept;
+
+    std::atomic<bool> active { false };
+    std::atomic<double> spectrumRate { maxSpectrumRate };
+
+    // Audio thread only
+    int envelopeLength = 480, envelopeCount = 0;
+    float envelopePeak = 0.0f;
+    int decimation = 1, decimationCount = 0;
+    float decimationSum = 0.0f;
+
+    juce::AbstractFifo envelopeFifo { envelopeCapacity }, spectrumFifo { spectrumCapacity };
+    juce::HeapBlock<float> envelopeFrames, spectrumSamples;
+};
+
+} // namespace ghostline
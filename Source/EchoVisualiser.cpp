@@ -0,0 +1,204 @@
+/*
+  ==============================================================================
+
+    EchoVisualiser.cpp
+
+  ==============================================================================
+*/
+
+#include "EchoVisualiser.h"
+
+namespace
+{
+    constexpr float lowestFrequency = 20.0f;
+    constexpr int gap = 10;
+}
+
+//==============================================================================
+EchoVisualiser::EchoVisualiser (ghostline::VisualiserFeed& feedToShow, juce::Colour background,
+                                juce::Colour trace, juce::Colour low, juce::Colour high)
+    : feed (feedToShow),
+      backgroundColour (background),
+      traceColour (trace),
+      envelopeScratch (static_cast<size_t> (ghostline::VisualiserFeed::envelopeCapacity)),
+      fftData (static_cast<size_t> (2 * fftSize)),
+      spectrumScratch (static_cast<size_t> (ghostline::VisualiserFeed::spectrumCapacity))
+{
+    setOpaque (true);
+    pending.reserve (static_cast<size_t> (fftSize + spectrumScratch.size()));
+
+    // Silence is the background; the loudest bins go through low to high
+    juce::ColourGradient gradient (background, 0.0f, 0.0f, high, 1.0f, 0.0f, false);
+    gradient.addColour (0.5, low);
+
+    for (size_t i = 0; i < palette.size(); ++i)
+        palette[i] = gradient.getColourAtPosition (static_cast<double> (i) / (palette.size() - 1));
+}
+
+EchoVisualiser::~EchoVisualiser()
+{
+    stopTimer();
+    feed.setActive (false);
+}
+
+void EchoVisualiser::visibilityChanged()
+{
+    updateActivity();
+}
+
+void EchoVisualiser::parentHierarchyChanged()
+{
+    updateActivity();
+}
+
+void EchoVisualiser::timerCallback()
+{
+    updateActivity();
+}
+
+void EchoVisualiser::updateActivity()
+{
+    const bool showing = isShowing();
+    feed.setActive (showing);
+
+    if (showing)
+    {
+        stopTimer();
+
+        if (refresh == nullptr)
+            refresh = std::make_unique<juce::VBlankAttachment> (this, [this] { update(); });
+
+        return;
+    }
+
+    refresh.reset();
+
+    // Still on a desktop but minimised or behind a hidden parent: poll until it shows
+    if (isVisible() && getPeer() != nullptr)
+        startTimerHz (4);
+    else
+        stopTimer();
+}
+
+//==============================================================================
+void EchoVisualiser::resized()
+{
+    auto bounds = getLocalBounds();
+    traceArea = bounds.removeFromLeft ((bounds.getWidth() - gap) / 2);
+    spectrogramArea = bounds.withTrimmedLeft (gap);
+
+    envelope.assign (static_cast<size_t> (juce::jmax (1, traceArea.getWidth())), 0.0f);
+    spectrogram = juce::Image (juce::Image::RGB, juce::jmax (1, spectrogramArea.getWidth()), juce::jmax (1, spectrogramArea.getHeight()), false);
+    spectrogram.clear (spectrogram.getBounds(), backgroundColour);
+}
+
+void EchoVisualiser::update()
+{
+    // A minimised window still gets callbacks; let the timer detach them, since
+    // this one can't be destroyed from inside its own callback
+    if (! isShowing())
+    {
+        feed.setActive (false);
+
+        if (! isTimerRunning())
+            startTimerHz (4);
+
+        return;
+    }
+
+    const int numFrames = feed.popEnvelope (envelopeScratch.data(), static_cast<int> (envelopeScratch.size()));
+
+    if (numFrames > 0)
+    {
+        // Scroll by as many columns as frames arrived, keeping the newest
+        const auto shift = static_cast<size_t> (juce::jmin (numFrames, static_cast<int> (envelope.size())));
+        std::rotate (envelope.begin(), envelope.begin() + static_cast<std::ptrdiff_t> (shift), envelope.end());
+        std::copy (envelopeScratch.begin() + (numFrames - static_cast<int> (shift)), envelopeScratch.begin() + numFrames, envelope.end() - static_cast<std::ptrdiff_t> (shift));
+        repaint (traceArea);
+    }
+
+    const int numSamples = feed.popSpectrum (spectrumScratch.data(), static_cast<int> (spectrumScratch.size()));
+    pending.insert (pending.end(), spectrumScratch.begin(), spectrumScratch.begin() + numSamples);
+
+    size_t consumed = 0;
+
+    for (; pending.size() - consumed >= static_cast<size_t> (fftSize); consumed += hopSize)
+        addSpectrumColumn (pending.data() + consumed);
+
+    if (consumed > 0)
+    {
+        pending.erase (pending.begin(), pending.begin() + static_cast<std::ptrdiff_t> (consumed));
+        repaint (spectrogramArea);
+    }
+}
+
+void EchoVisualiser::addSpectrumColumn (const float* samples)
+{
+    std::copy (samples, samples + fftSize, fftData.begin());
+    window.multiplyWithWindowingTable (fftData.data(), static_cast<size_t> (fftSize));
+    fft.performFrequencyOnlyForwardTransform (fftData.data(), true);
+
+    const int width = spectrogram.getWidth();
+    const int height = spectrogram.getHeight();
+    spectrogram.moveImageSection (0, 0, 1, 0, width - 1, height);
+
+    // Each row takes the loudest bin in its slice of the log axis
+    const auto nyquist = static_cast<float> (feed.getSpectrumRate() * 0.5);
+    const float binWidth = 2.0f * nyquist / fftSize;
+    const float ratio = nyquist / lowestFrequency;
+    const float scale = 4.0f / fftSize;   // A sine's amplitude: N / 2 for one side, halved again by the window
+
+    juce::Image::BitmapData pixels (spectrogram, width - 1, 0, 1, height, juce::Image::BitmapData::writeOnly);
+
+    for (int y = 0; y < height; ++y)
+    {
+        const float top = lowestFrequency * std::pow (ratio, 1.0f - static_cast<float> (y) / height);
+        const float bottom = lowestFrequency * std::pow (ratio, 1.0f - static_cast<float> (y + 1) / height);
+        const int firstBin = juce::jlimit (1, fftSize / 2 - 1, static_cast<int> (bottom / binWidth));
+        const int lastBin = juce::jlimit (firstBin, fftSize / 2 - 1, static_cast<int> (top / binWidth));
+
+        float magnitude = 0.0f;
+        for (int bin = firstBin; bin <= lastBin; ++bin)
+            magnitude = juce::jmax (magnitude, fftData[static_cast<size_t> (bin)]);
+
+        const auto index = static_cast<size_t> (juce::roundToInt (toLevel (magnitude * scale) * (palette.size() - 1)));
+        pixels.setPixelColour (0, y, palette[index]);
+    }
+}
+
+float EchoVisualiser::toLevel (float gain) const noexcept
+{
+    return juce::jlimit (0.0f, 1.0f, 1.0f - juce::Decibels::gainToDecibels (gain, floorDecibels) / floorDecibels);
+}
+
+//==============================================================================
+void EchoVisualiser::paint (juce::Graphics& g)
+{
+    g.fillAll (backgroundColour);
+
+    if (g.clipRegionIntersects (traceArea))
+    {
+        const float centre = traceArea.toFloat().getCentreY();
+        const float halfHeight = traceArea.getHeight() * 0.5f;
+
+        g.setColour (traceColour.withAlpha (0.25f));
+        g.drawHorizontalLine (juce::roundToInt (centre), static_cast<float> (traceArea.getX()), static_cast<float> (traceArea.getRight()));
+
+        g.setColour (traceColour);
+        for (size_t i = 0; i < envelope.size(); ++i)
+        {
+            const float extent = toLevel (envelope[i]) * halfHeight;
+
+            if (extent > 0.0f)
+                g.drawVerticalLine (traceArea.getX() + static_cast<int> (i), centre - extent, centre + extent);
+        }
+    }
+
+    if (g.clipRegionIntersects (spectrogramArea))
+        g.drawImage (spectrogram, spectrogramArea.toFloat());
+
+    g.setColour (traceColour.withAlpha (0.7f));
+    g.setFont (11.0f);
+    g.drawText ("ECHO DECAY", traceArea.reduced (4, 2), juce::Justification::topLeft, false);
+    g.drawText ("WET SPECTRUM", spectrogramArea.reduced (4, 2), juce::Justification::topLeft, false);
+}
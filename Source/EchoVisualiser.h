@@ -0,0 +1,76 @@
+/*
+  ==============================================================================
+
+    EchoVisualiser.h
+    The echo as the editor shows it: a scrolling trace of its decay beside a
+    waterfall spectrogram.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DSP/VisualiserFeed.h"
+
+//==============================================================================
+/**
+    Reads what the audio thread pushed into the VisualiserFeed once per
+    display refresh, runs the FFTs here on the message thread, and repaints
+    only the half that received something. The feed is switched off, and the
+    refresh callbacks are detached, whenever the component isn't showing; a
+    slow timer watches for it coming back, since a window restored from
+    minimised sends no hierarchy callback.
+
+    Both halves scroll right to left. The decay trace is the peak level of
+    each 10 ms, on a decibel scale mirrored about the centre line; the
+    spectrogram is one column per FFT hop on a logarithmic frequency axis.
+*/
+class EchoVisualiser  : public juce::Component,
+                        private juce::Timer
+{
+public:
+    EchoVisualiser (ghostline::VisualiserFeed& feedToShow, juce::Colour background,
+                    juce::Colour trace, juce::Colour low, juce::Colour high);
+    ~EchoVisualiser() override;
+
+    void paint (juce::Graphics&) override;
+    void resized() override;
+    void visibilityChanged() override;
+    void parentHierarchyChanged() override;
+
+    static constexpr int fftOrder = 11;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int hopSize = fftSize / 4;
+
+    static constexpr float floorDecibels = -84.0f;
+
+private:
+    void timerCallback() override;
+    void updateActivity();
+    void update();
+    void addSpectrumColumn (const float* samples);
+    float toLevel (float gain) const noexcept;
+
+    ghostline::VisualiserFeed& feed;
+    std::unique_ptr<juce::VBlankAttachment> refresh;
+    const juce::Colour backgroundColour, traceColour;
+    std::array<juce::Colour, 256> palette;
+
+    juce::Rectangle<int> traceArea, spectrogramArea;
+
+    // One peak per pixel column, newest last
+    std::vector<float> envelope;
+    std::vector<float> envelopeScratch;
+
+    // Samples waiting for a full window, the window itself and the FFT's workspace
+    juce::dsp::FFT fft { fftOrder };
+    juce::dsp::WindowingFunction<float> window { static_cast<size_t> (fftSize), juce::dsp::WindowingFunction<float>::hann };
+    std::vector<float> pending;
+    std::vector<float> fftData;
+    std::vector<float> spectrumScratch;
+
+    juce::Image spectrogram;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (EchoVisualiser)
+};
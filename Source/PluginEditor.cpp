@@ -9,12 +9,20 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
+namespace
+{
+    // The layout and the background are drawn at this size and scaled to the window
+    constexpr int designWidth = 800;
+    constexpr int designHeight = 870;
+    
+    const juce::Identifier editorWidthProperty ("editorWidth");
+}
+
 //==============================================================================
 GhostlineAudioProcessorEditor::GhostlineAudioProcessorEditor (GhostlineAudioProcessor& p)
     : AudioProcessorEditor (&p), audioProcessor (p)
 {
-    setSize (800, 600);
-    setBufferedToImage (true);
+    setOpaque (true);
 
     // Delay Time slider
     delayTimeSlider.setSliderStyle (juce::Slider::RotaryHorizontalVerticalDrag);
@@ -137,12 +145,358 @@ GhostlineAudioProcessorEditor::GhostlineAudioProcessorEditor (GhostlineAudioProc
     modDepthLabel.setColour (juce::Label::textColourId, textColor);
     addAndMakeVisible (&modDepthLabel);
     
+    // Mix law: WET and DRY, or the MIX knob through a crossfade
+    initializeSmallKnob (mixSlider, ghostCyan, ghostPurple);
+    initializeLabel (mixLabel, "Mix");
+    mixAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (audioProcessor.apvts, "MIX", mixSlider);
+    
+    initializeSelector (mixLawBox, mixLawLabel, "Mix Law", "MIXLAW");
+    mixLawBox.onChange = [this]
+    {
+        const bool separateLevels = mixLawBox.getSelectedItemIndex() == 0;
+        wetSlider.setEnabled (separateLevels);
+        drySlider.setEnabled (separateLevels);
+        mixSlider.setEnabled (! separateLevels);
+    };
+    mixLawAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment> (audioProcessor.apvts, "MIXLAW", mixLawBox);
+    mixLawBox.onChange();
+    
+    // Modulation Shape selector
+    initializeSelector (modShapeBox, modShapeLabel, "Mod Shape", "MODSHAPE");
+    modShapeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment> (audioProcessor.apvts, "MODSHAPE", modShapeBox);
+    
+    // LFO phase spread across the channels
+    initializeSmallKnob (modSpreadSlider, ghostPurple, ghostOrange);
+    initializeLabel (modSpreadLabel, "Mod Spread");
+    modSpreadAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (audioProcessor.apvts, "MODSPREAD", modSpreadSlider);
+    
+    // Interpolation quality for the delay read
+    initializeSelector (interpolationBox, interpolationLabel, "Interpolation", "INTERP");
+    interpolationAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment> (audioProcessor.apvts, "INTERP", interpolationBox);
+    
+    // Saturation curve and the rate it runs at, with the overdrive only live when a curve is
+    initializeSelector (saturationBox, saturationLabel, "Saturation", "SATURATION");
+    initializeSmallKnob (overdriveSlider, ghostOrange, ghostGreen);
+    initializeLabel (overdriveLabel, "Overdrive");
+    
+    saturationBox.onChange = [this]
+    {
+        overdriveSlider.setEnabled (saturationBox.getSelectedItemIndex() != static_cast<int> (ghostline::SaturationCurve::off));
+    };
+    saturationAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment> (audioProcessor.apvts, "SATURATION", saturationBox);
+    saturationBox.onChange();
+    
+    overdriveAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (audioProcessor.apvts, "OVERDRIVE", overdriveSlider);
+    
+    initializeSelector (oversamplingBox, oversamplingLabel, "Oversampling", "OVERSAMPLE");
+    oversamplingBox.onChange = [this]
+    {
+        const float latency = audioProcessor.getSaturationLatencySamples (oversamplingBox.getSelectedItemIndex());
+        oversamplingLabel.setText ("Oversampling (" + juce::String (latency, 1) + " smp)", juce::dontSendNotification);
+    };
+    oversamplingAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment> (audioProcessor.apvts, "OVERSAMPLE", oversamplingBox);
+    oversamplingBox.onChange();
+    
+    // Tape model
+    initializeToggle (tapeModeButton);
+    tapeModeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment> (audioProcessor.apvts, "TAPEMODE", tapeModeButton);
+    
+    initializeSmallKnob (wowSlider, ghostCyan, ghostPurple);
+    initializeSmallKnob (flutterSlider, ghostGreen, ghostCyan);
+    initializeSmallKnob (hissSlider, ghostPurple, ghostGreen);
+    initializeSmallKnob (tapeAgeSlider, ghostOrange, ghostPurple);
+    initializeLabel (wowLabel, "Wow");
+    initializeLabel (flutterLabel, "Flutter");
+    initializeLabel (hissLabel, "Hiss");
+    initializeLabel (tapeAgeLabel, "Age");
+    
+    wowAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (audioProcessor.apvts, "WOW", wowSlider);
+    flutterAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (audioProcessor.apvts, "FLUTTER", flutterSlider);
+    hissAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (audioProcessor.apvts, "HISS", hissSlider);
+    tapeAgeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (audioProcessor.apvts, "TAPEAGE", tapeAgeSlider);
+    
+    // Loop filters
+    initializeSmallKnob (loopHighPassSlider, ghostGreen, ghostPurple);
+    initializeSmallKnob (loopLowPassSlider, ghostCyan, ghostOrange);
+    initializeSmallKnob (loopTiltSlider, ghostPurple, ghostCyan);
+    initializeLabel (loopHighPassLabel, "Loop HP");
+    initializeLabel (loopLowPassLabel, "Loop LP");
+    initializeLabel (loopTiltLabel, "Tilt");
+    initializeToggle (loopDcButton);
+    
+    loopHighPassAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (audioProcessor.apvts, "LOOPHP", loopHighPassSlider);
+    loopLowPassAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (audioProcessor.apvts, "LOOPLP", loopLowPassSlider);
+    loopTiltAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (audioProcessor.apvts, "LOOPTILT", loopTiltSlider);
+    loopDcAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment> (audioProcessor.apvts, "LOOPDC", loopDcButton);
+    
+    // Diffusion
+    initializeSmallKnob (diffusionSlider, ghostCyan, ghostPurple);
+    initializeSmallKnob (diffusionSizeSlider, ghostGreen, ghostCyan);
+    initializeLabel (diffusionLabel, "Diffusion");
+    initializeLabel (diffusionSizeLabel, "Size");
+    
+    diffusionAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (audioProcessor.apvts, "DIFFUSION", diffusionSlider);
+    diffusionSizeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (audioProcessor.apvts, "DIFFSIZE", diffusionSizeSlider);
+    
+    // Stereo mode, with the cross-feedback amount only live when it is used
+    initializeSelector (stereoModeBox, stereoModeLabel, "Stereo Mode", "STEREOMODE");
+    initializeSmallKnob (crossFeedbackSlider, ghostOrange, ghostPurple);
+    initializeSmallKnob (leftOffsetSlider, ghostGreen, ghostCyan);
+    initializeSmallKnob (rightOffsetSlider, ghostGreen, ghostCyan);
+    initializeLabel (crossFeedbackLabel, "Cross");
+    initializeLabel (leftOffsetLabel, "L Offset");
+    initializeLabel (rightOffsetLabel, "R Offset");
+    
+    stereoModeBox.onChange = [this]
+    {
+        crossFeedbackSlider.setEnabled (stereoModeBox.getSelectedItemIndex() == static_cast<int> (ghostline::StereoMode::crossFeedback));
+    };
+    stereoModeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment> (audioProcessor.apvts, "STEREOMODE", stereoModeBox);
+    stereoModeBox.onChange();
+    
+    crossFeedbackAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (audioProcessor.apvts, "CROSSFEED", crossFeedbackSlider);
+    leftOffsetAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (audioProcessor.apvts, "LEFTOFFSET", leftOffsetSlider);
+    rightOffsetAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (audioProcessor.apvts, "RIGHTOFFSET", rightOffsetSlider);
+    
+    // Long-delay mode: switch, time and storage format
+    initializeToggle (longModeButton);
+    longModeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment> (audioProcessor.apvts, "LONGMODE", longModeButton);
+    
+    initializeKnob (longTimeSlider, longTimeLabel, "Long Time", ghostCyan, ghostGreen, ghostOrange);
+    longTimeSlider.setTextValueSuffix (" s");
+    longTimeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (audioProcessor.apvts, "LONGTIME", longTimeSlider);
+    
+    initializeSelector (storageBox, storageLabel, "Long Storage", "STORAGE");
+    storageAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment> (audioProcessor.apvts, "STORAGE", storageBox);
+    
+    // Tempo sync for the delay time and the LFO
+    initializeSelector (divisionBox, "DIVISION");
+    divisionAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment> (audioProcessor.apvts, "DIVISION", divisionBox);
+    initializeToggle (syncButton);
+    syncAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment> (audioProcessor.apvts, "SYNC", syncButton);
+    
+    initializeSelector (modDivisionBox, "MODDIVISION");
+    modDivisionAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment> (audioProcessor.apvts, "MODDIVISION", modDivisionBox);
+    initializeToggle (modSyncButton);
+    modSyncAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment> (audioProcessor.apvts, "MODSYNC", modSyncButton);
+    
+    // Multi-head echo: switch and head count share a column, then one strip per head
+    initializeSelector (headCountBox, "HEADCOUNT");
+    headCountAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment> (audioProcessor.apvts, "HEADCOUNT", headCountBox);
+    initializeToggle (multiHeadButton);
+    multiHeadAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment> (audioProcessor.apvts, "HEADMODE", multiHeadButton);
+    
+    initializeLabel (headTimeCaption, "Time");
+    initializeLabel (headLevelCaption, "Level");
+    initializeLabel (headPanCaption, "Pan");
+    
+    for (int head = 0; head < static_cast<int> (headControls.size()); ++head)
+    {
+        auto& controls = headControls[static_cast<size_t> (head)];
+        const juce::String prefix = "HEAD" + juce::String (head + 1);
+        
+        initializeLabel (controls.label, juce::String (head + 1));
+        initializeSmallKnob (controls.time, ghostCyan, ghostPurple);
+        initializeSmallKnob (controls.level, ghostGreen, ghostCyan);
+        initializeSmallKnob (controls.pan, ghostOrange, ghostGreen);
+        
+        controls.timeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (audioProcessor.apvts, prefix + "TIME", controls.time);
+        controls.levelAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (audioProcessor.apvts, prefix + "LEVEL", controls.level);
+        controls.panAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (audioProcessor.apvts, prefix + "PAN", controls.pan);
+    }
+    
+    // Adaptive quality: switch, and the governor's tier and load polled a few times a second
+    initializeToggle (adaptiveQualityButton);
+    adaptiveQualityAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment> (audioProcessor.apvts, "ADAPTIVE", adaptiveQualityButton);
+    initializeLabel (qualityLabel, {});
+    qualityLabel.setJustificationType (juce::Justification::centredLeft);
+    qualityLabel.setFont (12.0f);
+    addAndMakeVisible (cpuMeter);
+    traceButton.setColour (juce::TextButton::buttonColourId, spookyBlack);
+    traceButton.setColour (juce::TextButton::textColourOffId, textColor);
+    traceButton.onClick = [this] { saveTrace(); };
+    addAndMakeVisible (traceButton);
+    addAndMakeVisible (visualiser);
+    timerCallback();
+    startTimerHz (10);
+    
     // Initialize background elements with fixed positions
     initializeBackground();
+    
+    // Last, so resized() scales every control. Any size from half to twice
+    // the design, keeping its shape; the last size is saved with the session
+    const int savedWidth = audioProcessor.apvts.state.getProperty (editorWidthProperty, designWidth);
+    const int width = juce::jlimit (designWidth / 2, designWidth * 2, savedWidth);
+    setSize (width, width * designHeight / designWidth);
+    
+    setResizable (true, false);
+    setResizeLimits (designWidth / 2, designHeight / 2, designWidth * 2, designHeight * 2);
+    getConstrainer()->setFixedAspectRatio (static_cast<double> (designWidth) / designHeight);
 }
 
 GhostlineAudioProcessorEditor::~GhostlineAudioProcessorEditor()
 {
+    stopTimer();
+}
+
+void GhostlineAudioProcessorEditor::timerCallback()
+{
+    cpuMeter.update();
+    
+    const auto load = juce::roundToInt (audioProcessor.getCpuLoad() * 100.0f);
+    const auto overruns = cpuMeter.getStatistics().numOverruns;
+    qualityLabel.setText (ghostline::QualityGovernor::getTierName (audioProcessor.getQualityTier())
+                              + " (" + juce::String (load) + "% CPU"
+                              + (overruns > 0 ? ", " + juce::String (overruns) + " over" : juce::String())
+                              + ")",
+                          juce::dontSendNotification);
+}
+
+void GhostlineAudioProcessorEditor::saveTrace()
+{
+    traceChooser = std::make_unique<juce::FileChooser> ("Save processBlock trace",
+                                                        juce::File::getSpecialLocation (juce::File::userDesktopDirectory)
+                                                            .getChildFile ("Ghostline trace.json"),
+                                                        "*.json");
+    
+    traceChooser->launchAsync (juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::warnAboutOverwriting,
+                               [this] (const juce::FileChooser& chooser)
+    {
+        const auto file = chooser.getResult();
+        
+        if (file != juce::File() && ! audioProcessor.getProfiler().writeTrace (file))
+            juce::AlertWindow::showMessageBoxAsync (juce::MessageBoxIconType::WarningIcon, "Trace not saved",
+                                                    "Couldn't write " + file.getFullPathName());
+    });
+}
+
+//==============================================================================
+GhostlineAudioProcessorEditor::CpuMeter::CpuMeter (ghostline::BlockProfiler& profilerToShow, juce::Colour normal,
+                                                   juce::Colour warning, juce::Colour budget)
+    : profiler (profilerToShow), normalColour (normal), warningColour (warning), budgetColour (budget)
+{
+}
+
+void GhostlineAudioProcessorEditor::CpuMeter::update()
+{
+    statistics = profiler.getStatistics();
+    repaint();
+}
+
+void GhostlineAudioProcessorEditor::CpuMeter::mouseDown (const juce::MouseEvent&)
+{
+    profiler.requestReset();
+}
+
+void GhostlineAudioProcessorEditor::CpuMeter::paint (juce::Graphics& g)
+{
+    using Profiler = ghostline::BlockProfiler;
+    
+    const auto bounds = getLocalBounds().toFloat();
+    const float fullScale = Profiler::numBuckets * Profiler::bucketWidth;
+    const float bucketWidth = bounds.getWidth() / Profiler::numBuckets;
+    const auto histogramArea = bounds.withTrimmedBottom (3.0f);
+    
+    g.setColour (juce::Colours::black.withAlpha (0.4f));
+    g.fillRoundedRectangle (bounds, 2.0f);
+    
+    // Log heights, so the rare slow blocks that matter still show beside the common ones
+    const auto tallest = *std::max_element (statistics.histogram.begin(), statistics.histogram.end());
+    
+    if (tallest > 0)
+    {
+        const float scale = histogramArea.getHeight() / std::log1p (static_cast<float> (tallest));
+        
+        for (int i = 0; i < Profiler::numBuckets; ++i)
+        {
+            const auto count = statistics.histogram[static_cast<size_t> (i)];
+            
+            if (count == 0)
+                continue;
+            
+            const float load = i * Profiler::bucketWidth;
+            const float height = juce::jmax (1.0f, std::log1p (static_cast<float> (count)) * scale);
+            
+            g.setColour ((load < ghostline::QualityGovernor::stepDownLoad ? normalColour
+                          : load < 1.0f ? warningColour : juce::Colours::red).withAlpha (0.7f));
+            g.fillRect (bounds.getX() + i * bucketWidth, histogramArea.getBottom() - height, juce::jmax (1.0f, bucketWidth - 1.0f), height);
+        }
+    }
+    
+    // The latest block's load, and the budget it has to stay under
+    const float loadWidth = bounds.getWidth() * juce::jmin (1.0f, statistics.lastLoad / fullScale);
+    g.setColour (statistics.lastLoad < 1.0f ? normalColour : juce::Colours::red);
+    g.fillRect (bounds.getX(), bounds.getBottom() - 2.0f, loadWidth, 2.0f);
+    
+    g.setColour (budgetColour.withAlpha (0.8f));
+    g.drawVerticalLine (juce::roundToInt (bounds.getX() + bounds.getWidth() / fullScale), bounds.getY(), bounds.getBottom());
+}
+
+//==============================================================================
+void GhostlineAudioProcessorEditor::initializeKnob (juce::Slider& slider, juce::Label& label, const juce::String& name,
+                                                    juce::Colour fill, juce::Colour outline, juce::Colour thumb)
+{
+    slider.setSliderStyle (juce::Slider::RotaryHorizontalVerticalDrag);
+    slider.setTextBoxStyle (juce::Slider::TextBoxBelow, false, 80, 20);
+    slider.setTextBoxIsEditable (false);
+    slider.setOpaque (false);
+    slider.setColour (juce::Slider::rotarySliderFillColourId, fill);
+    slider.setColour (juce::Slider::rotarySliderOutlineColourId, outline);
+    slider.setColour (juce::Slider::thumbColourId, thumb);
+    slider.setColour (juce::Slider::textBoxTextColourId, textColor);
+    slider.setColour (juce::Slider::textBoxBackgroundColourId, juce::Colours::transparentBlack);
+    slider.setColour (juce::Slider::textBoxHighlightColourId, juce::Colours::transparentBlack);
+    slider.setColour (juce::Slider::textBoxOutlineColourId, juce::Colours::transparentBlack);
+    addAndMakeVisible (&slider);
+    
+    initializeLabel (label, name);
+}
+
+void GhostlineAudioProcessorEditor::initializeSelector (juce::ComboBox& box, juce::Label& label, const juce::String& name,
+                                                        const juce::String& parameterID)
+{
+    initializeSelector (box, parameterID);
+    initializeLabel (label, name);
+}
+
+void GhostlineAudioProcessorEditor::initializeSelector (juce::ComboBox& box, const juce::String& parameterID)
+{
+    box.addItemList (audioProcessor.apvts.getParameter (parameterID)->getAllValueStrings(), 1);
+    box.setJustificationType (juce::Justification::centred);
+    box.setColour (juce::ComboBox::backgroundColourId, spookyBlack.withAlpha (0.6f));
+    box.setColour (juce::ComboBox::textColourId, textColor);
+    box.setColour (juce::ComboBox::outlineColourId, ghostPurple);
+    box.setColour (juce::ComboBox::arrowColourId, ghostGreen);
+    addAndMakeVisible (&box);
+}
+
+void GhostlineAudioProcessorEditor::initializeLabel (juce::Label& label, const juce::String& name)
+{
+    label.setText (name, juce::dontSendNotification);
+    label.setJustificationType (juce::Justification::centred);
+    label.setColour (juce::Label::textColourId, textColor);
+    addAndMakeVisible (&label);
+}
+
+void GhostlineAudioProcessorEditor::initializeToggle (juce::ToggleButton& button)
+{
+    button.setColour (juce::ToggleButton::textColourId, textColor);
+    button.setColour (juce::ToggleButton::tickColourId, ghostGreen);
+    button.setColour (juce::ToggleButton::tickDisabledColourId, ghostPurple);
+    addAndMakeVisible (&button);
+}
+
+void GhostlineAudioProcessorEditor::initializeSmallKnob (juce::Slider& slider, juce::Colour fill, juce::Colour outline)
+{
+    // No text box; the value pops up while dragging
+    slider.setSliderStyle (juce::Slider::RotaryHorizontalVerticalDrag);
+    slider.setTextBoxStyle (juce::Slider::NoTextBox, false, 0, 0);
+    slider.setPopupDisplayEnabled (true, true, this);
+    slider.setOpaque (false);
+    slider.setColour (juce::Slider::rotarySliderFillColourId, fill);
+    slider.setColour (juce::Slider::rotarySliderOutlineColourId, outline);
+    slider.setColour (juce::Slider::thumbColourId, ghostGreen);
+    addAndMakeVisible (&slider);
 }
 
 //==============================================================================
@@ -155,8 +509,8 @@ void GhostlineAudioProcessorEditor::initializeBackground()
     for (int i = 0; i < 30; ++i)
     {
         FogCircle fog;
-        fog.x = r.nextFloat() * 800.0f;
-        fog.y = r.nextFloat() * 600.0f;
+        fog.x = r.nextFloat() * designWidth;
+        fog.y = r.nextFloat() * designHeight;
         fog.radius = 60.0f + r.nextFloat() * 100.0f;
         fogCircles.push_back (fog);
     }
@@ -165,26 +519,57 @@ void GhostlineAudioProcessorEditor::initializeBackground()
     for (int i = 0; i < 10; ++i)
     {
         OrbCircle orb;
-        orb.x = r.nextFloat() * 800.0f;
-        orb.y = r.nextFloat() * 600.0f;
+        orb.x = r.nextFloat() * designWidth;
+        orb.y = r.nextFloat() * designHeight;
         orb.radius = 20.0f + r.nextFloat() * 40.0f;
         orbCircles.push_back (orb);
     }
-    
-    backgroundInitialized = true;
 }
 
 void GhostlineAudioProcessorEditor::paint (juce::Graphics& g)
 {
-    // Spooky dark background
-    g.fillAll (spookyBlack);
+    // Everything behind the controls is static, so it is drawn once per pixel
+    // size, at the display's own resolution, and shared by editors of that size
+    const float pixelScale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    const int pixelWidth = juce::roundToInt (getWidth() * pixelScale);
+    const int pixelHeight = juce::roundToInt (getHeight() * pixelScale);
+    
+    if (background.getWidth() != pixelWidth || background.getHeight() != pixelHeight)
+        background = getBackgroundImage (pixelWidth, pixelHeight);
+    
+    g.drawImage (background, getLocalBounds().toFloat());
+}
+
+juce::Image GhostlineAudioProcessorEditor::getBackgroundImage (int pixelWidth, int pixelHeight)
+{
+    auto& images = backgroundCache->images;
+    const auto key = std::make_pair (pixelWidth, pixelHeight);
+    
+    if (const auto found = images.find (key); found != images.end())
+        return found->second;
+    
+    // Sizes no editor is showing any more: the cache holds their only reference
+    for (auto it = images.begin(); it != images.end();)
+        it = it->second.getReferenceCount() <= 1 ? images.erase (it) : std::next (it);
+    
+    juce::Image image (juce::Image::RGB, juce::jmax (1, pixelWidth), juce::jmax (1, pixelHeight), false);
     
-    // Reinitialize if size changed
-    if (!backgroundInitialized || fogCircles.empty() || orbCircles.empty())
     {
-        initializeBackground();
+        juce::Graphics g (image);
+        g.addTransform (juce::AffineTransform::scale (pixelWidth / static_cast<float> (designWidth),
+                                                      pixelHeight / static_cast<float> (designHeight)));
+        drawBackground (g);
     }
     
+    images[key] = image;
+    return image;
+}
+
+void GhostlineAudioProcessorEditor::drawBackground (juce::Graphics& g) const
+{
+    // Spooky dark background
+    g.fillAll (spookyBlack);
+    
     // Draw spooky mist/fog effect with cached positions
     g.setColour (ghostCyan.withAlpha (0.2f));
     for (const auto& fog : fogCircles)
@@ -201,6 +586,7 @@ void GhostlineAudioProcessorEditor::paint (juce::Graphics& g)
     
     // Draw title with spooky glow
     g.setFont (juce::Font (56.0f, juce::Font::bold));
+    const int titleX = designWidth / 2 - 180;
     
     // Green glow behind text (slightly more blur)
     g.setColour (ghostGreen.withAlpha (0.5f));
@@ -210,7 +596,7 @@ void GhostlineAudioProcessorEditor::paint (juce::Graphics& g)
         {
             if (i != 0 || j != 0)
             {
-                g.drawText ("GHOSTLINE", getWidth() / 2 - 180 + i, 30 + j, 360, 70,
+                g.drawText ("GHOSTLINE", titleX + i, 30 + j, 360, 70,
                            juce::Justification::centred, false);
             }
         }
@@ -224,24 +610,24 @@ void GhostlineAudioProcessorEditor::paint (juce::Graphics& g)
         {
             if (i != 0 || j != 0)
             {
-                g.drawText ("GHOSTLINE", getWidth() / 2 - 180 + i, 30 + j, 360, 70,
+                g.drawText ("GHOSTLINE", titleX + i, 30 + j, 360, 70,
                            juce::Justification::centred, false);
             }
         }
     }
     
     // Main title
-    juce::ColourGradient titleGradient (ghostCyan, getWidth() / 2 - 180, 30,
-                                       ghostGreen, getWidth() / 2 - 180, 100,
+    juce::ColourGradient titleGradient (ghostCyan, titleX, 30,
+                                       ghostGreen, titleX, 100,
                                        false);
     g.setGradientFill (titleGradient);
-    g.drawText ("GHOSTLINE", getWidth() / 2 - 180, 30, 360, 70,
+    g.drawText ("GHOSTLINE", titleX, 30, 360, 70,
                juce::Justification::centred, false);
     
     // Subtitle
     g.setFont (20.0f);
     g.setColour (ghostPurple.withAlpha (0.9f));
-    g.drawText ("Spooky Space Echo", getWidth() / 2 - 150, 95, 300, 30,
+    g.drawText ("Spooky Space Echo", designWidth / 2 - 150, 95, 300, 30,
                juce::Justification::centred, false);
 }
 
@@ -250,37 +636,162 @@ void GhostlineAudioProcessorEditor::resized()
     const int knobSize = 100;
     const int labelHeight = 25;
     const int startY = 150;
-    const int spacing = (getWidth() - 100 - (knobSize * 6)) / 5;
-    
-    int x = 50;
-    
-    // Delay Time
-    delayTimeSlider.setBounds (x, startY, knobSize, knobSize);
-    delayTimeLabel.setBounds (x, startY + knobSize + 5, knobSize, labelHeight);
-    x += knobSize + spacing;
-    
-    // Feedback
-    feedbackSlider.setBounds (x, startY, knobSize, knobSize);
-    feedbackLabel.setBounds (x, startY + knobSize + 5, knobSize, labelHeight);
-    x += knobSize + spacing;
-    
-    // Wet
-    wetSlider.setBounds (x, startY, knobSize, knobSize);
-    wetLabel.setBounds (x, startY + knobSize + 5, knobSize, labelHeight);
-    x += knobSize + spacing;
-    
-    // Dry
-    drySlider.setBounds (x, startY, knobSize, knobSize);
-    dryLabel.setBounds (x, startY + knobSize + 5, knobSize, labelHeight);
-    x += knobSize + spacing;
-    
-    // Mod Rate
-    modRateSlider.setBounds (x, startY, knobSize, knobSize);
-    modRateLabel.setBounds (x, startY + knobSize + 5, knobSize, labelHeight);
-    x += knobSize + spacing;
-    
-    // Mod Depth
-    modDepthSlider.setBounds (x, startY, knobSize, knobSize);
-    modDepthLabel.setBounds (x, startY + knobSize + 5, knobSize, labelHeight);
+    const int selectorY = startY + knobSize + 50;
+    const int selectorHeight = 24;
+    const int secondRowY = selectorY + selectorHeight + labelHeight + 30;
+    const int spacing = (designWidth - 100 - (knobSize * 6)) / 5;
+    
+    // Left edge of each of the six knob columns
+    auto column = [&] (int index) { return 50 + index * (knobSize + spacing); };
+    
+    auto placeKnob = [&] (juce::Slider& slider, juce::Label& label, int x, int y)
+    {
+        slider.setBounds (x, y, knobSize, knobSize);
+        label.setBounds (x, y + knobSize + 5, knobSize, labelHeight);
+    };
+    
+    auto placeSelector = [&] (juce::Component& box, juce::Component& label, int x, int width)
+    {
+        box.setBounds (x, selectorY, width, selectorHeight);
+        label.setBounds (x, selectorY + selectorHeight + 5, width, labelHeight);
+    };
+    
+    placeKnob (delayTimeSlider, delayTimeLabel, column (0), startY);
+    placeKnob (feedbackSlider, feedbackLabel, column (1), startY);
+    placeKnob (wetSlider, wetLabel, column (2), startY);
+    placeKnob (drySlider, dryLabel, column (3), startY);
+    placeKnob (modRateSlider, modRateLabel, column (4), startY);
+    placeKnob (modDepthSlider, modDepthLabel, column (5), startY);
+    
+    // Selectors under the knobs they belong to
+    longModeButton.setBounds (column (0), selectorY, knobSize, selectorHeight);
+    placeSelector (storageBox, storageLabel, column (1), knobSize);
+    placeSelector (divisionBox, syncButton, column (2), knobSize);
+    placeSelector (headCountBox, multiHeadButton, column (3), knobSize);
+    placeSelector (modShapeBox, modShapeLabel, column (4), knobSize);
+    placeSelector (modDivisionBox, modSyncButton, column (5), knobSize);
+    
+    // Mix law and knob in the top-right corner, clear of the title
+    const int mixKnobSize = 40;
+    const int mixY = 40;
+    mixSlider.setBounds (column (5) - mixKnobSize - 10, mixY, mixKnobSize, mixKnobSize);
+    mixLabel.setBounds (column (5) - mixKnobSize - 10, mixY + mixKnobSize, mixKnobSize, 18);
+    mixLawBox.setBounds (column (5), mixY + 8, knobSize, selectorHeight);
+    mixLawLabel.setBounds (column (5), mixY + 8 + selectorHeight + 5, knobSize, labelHeight);
+    
+    // Adaptive quality in the top-left corner, mirroring the mix controls
+    adaptiveQualityButton.setBounds (column (0), mixY + 8, 160, selectorHeight);
+    qualityLabel.setBounds (column (0), mixY + 8 + selectorHeight + 5, 170, labelHeight);
+    cpuMeter.setBounds (column (0), mixY + 8 + selectorHeight + labelHeight + 6, 120, 18);
+    traceButton.setBounds (column (0) + 124, mixY + 8 + selectorHeight + labelHeight + 6, 46, 18);
+    
+    // Second row of knobs
+    placeKnob (longTimeSlider, longTimeLabel, column (0), secondRowY);
+    
+    const int interpolationY = secondRowY + knobSize + labelHeight + 15;
+    interpolationBox.setBounds (column (0), interpolationY, knobSize, selectorHeight);
+    interpolationLabel.setBounds (column (0), interpolationY + selectorHeight + 5, knobSize, labelHeight);
+    saturationBox.setBounds (column (1), interpolationY, knobSize, selectorHeight);
+    saturationLabel.setBounds (column (1), interpolationY + selectorHeight + 5, knobSize, labelHeight);
+    oversamplingBox.setBounds (column (2), interpolationY, knobSize, selectorHeight);
+    oversamplingLabel.setBounds (column (2) - spacing / 2, interpolationY + selectorHeight + 5, knobSize + spacing, labelHeight);
+    
+    // Tape model: switch, then its four small knobs across the last two columns
+    tapeModeButton.setBounds (column (3), interpolationY, knobSize, selectorHeight);
+    
+    // Mod spread under the tape switch, its label alongside
+    const int spreadKnobSize = 40;
+    const int spreadY = interpolationY + selectorHeight + 4;
+    modSpreadSlider.setBounds (column (3), spreadY, spreadKnobSize, spreadKnobSize);
+    modSpreadLabel.setBounds (column (3) + spreadKnobSize, spreadY, knobSize + spacing - spreadKnobSize, spreadKnobSize);
+    
+    juce::Slider* tapeKnobs[] = { &wowSlider, &flutterSlider, &hissSlider, &tapeAgeSlider };
+    juce::Label* tapeLabels[] = { &wowLabel, &flutterLabel, &hissLabel, &tapeAgeLabel };
+    const int tapeKnobSize = 40;
+    const int tapeWidth = (column (5) + knobSize - column (4)) / 4;
+    
+    for (int i = 0; i < 4; ++i)
+    {
+        const int x = column (4) + i * tapeWidth;
+        tapeKnobs[i]->setBounds (x + (tapeWidth - tapeKnobSize) / 2, interpolationY - 8, tapeKnobSize, tapeKnobSize);
+        tapeLabels[i]->setBounds (x, interpolationY + tapeKnobSize - 8, tapeWidth, 18);
+    }
+    
+    // Per-head strip: row captions, then one narrow column of three knobs per head
+    const int captionWidth = 50;
+    const int headLabelHeight = 18;
+    const int smallKnobSize = 40;
+    const int headsX = column (1) + captionWidth;
+    const int headWidth = (column (5) + knobSize - headsX) / static_cast<int> (headControls.size());
+    const int knobY = secondRowY + headLabelHeight;
+    
+    headTimeCaption.setBounds (column (1), knobY, captionWidth, smallKnobSize);
+    headLevelCaption.setBounds (column (1), knobY + smallKnobSize, captionWidth, smallKnobSize);
+    headPanCaption.setBounds (column (1), knobY + 2 * smallKnobSize, captionWidth, smallKnobSize);
+    
+    for (int head = 0; head < static_cast<int> (headControls.size()); ++head)
+    {
+        auto& controls = headControls[static_cast<size_t> (head)];
+        const int x = headsX + head * headWidth;
+        const int knobX = x + (headWidth - smallKnobSize) / 2;
+        
+        controls.label.setBounds (x, secondRowY, headWidth, headLabelHeight);
+        controls.time.setBounds (knobX, knobY, smallKnobSize, smallKnobSize);
+        controls.level.setBounds (knobX, knobY + smallKnobSize, smallKnobSize, smallKnobSize);
+        controls.pan.setBounds (knobX, knobY + 2 * smallKnobSize, smallKnobSize, smallKnobSize);
+    }
+    
+    // Loop filters along the row under the selectors, same small knobs as the tape model
+    const int loopY = 605;
+    const int loopKnobSize = 40;
+    const int loopWidth = (column (3) - column (0)) / 4;
+    juce::Slider* loopKnobs[] = { &loopHighPassSlider, &loopLowPassSlider, &loopTiltSlider };
+    juce::Label* loopLabels[] = { &loopHighPassLabel, &loopLowPassLabel, &loopTiltLabel };
+    
+    for (int i = 0; i < 3; ++i)
+    {
+        const int x = column (0) + i * loopWidth;
+        loopKnobs[i]->setBounds (x + (loopWidth - loopKnobSize) / 2, loopY, loopKnobSize, loopKnobSize);
+        loopLabels[i]->setBounds (x, loopY + loopKnobSize, loopWidth, 18);
+    }
+    
+    loopDcButton.setBounds (column (0) + 3 * loopWidth, loopY + (loopKnobSize - selectorHeight) / 2, loopWidth, selectorHeight);
+    
+    // Diffusion and the saturation overdrive carry on along the same row, at the same spacing
+    juce::Slider* diffusionKnobs[] = { &diffusionSlider, &diffusionSizeSlider, &overdriveSlider };
+    juce::Label* diffusionLabels[] = { &diffusionLabel, &diffusionSizeLabel, &overdriveLabel };
+    
+    for (int i = 0; i < 3; ++i)
+    {
+        const int x = column (3) + i * loopWidth;
+        diffusionKnobs[i]->setBounds (x + (loopWidth - loopKnobSize) / 2, loopY, loopKnobSize, loopKnobSize);
+        diffusionLabels[i]->setBounds (x, loopY + loopKnobSize, loopWidth, 18);
+    }
+    
+    // Stereo row: the mode selector, then its knobs at the loop row's spacing
+    const int stereoY = 665;
+    stereoModeBox.setBounds (column (0), stereoY + (loopKnobSize - selectorHeight) / 2, knobSize, selectorHeight);
+    stereoModeLabel.setBounds (column (0), stereoY + loopKnobSize, knobSize, 18);
+    
+    juce::Slider* stereoKnobs[] = { &crossFeedbackSlider, &leftOffsetSlider, &rightOffsetSlider };
+    juce::Label* stereoLabels[] = { &crossFeedbackLabel, &leftOffsetLabel, &rightOffsetLabel };
+    
+    for (int i = 0; i < 3; ++i)
+    {
+        const int x = column (1) + i * loopWidth;
+        stereoKnobs[i]->setBounds (x + (loopWidth - loopKnobSize) / 2, stereoY, loopKnobSize, loopKnobSize);
+        stereoLabels[i]->setBounds (x, stereoY + loopKnobSize, loopWidth, 18);
+    }
+    
+    // Visualiser strip under everything else, across the knob columns
+    visualiser.setBounds (column (0), 735, column (5) + knobSize - column (0), 115);
+    
+    // Everything above is in design units; one transform scales the lot, text
+    // included, so it is drawn sharp at any size rather than stretched
+    const auto scale = juce::AffineTransform::scale (getWidth() / static_cast<float> (designWidth));
+    
+    for (auto* child : getChildren())
+        child->setTransform (scale);
+    
+    audioProcessor.apvts.state.setProperty (editorWidthProperty, getWidth(), nullptr);
 }
-
@@ -10,11 +10,13 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "EchoVisualiser.h"
 
 //==============================================================================
 /**
 */
-class GhostlineAudioProcessorEditor  : public juce::AudioProcessorEditor
+class GhostlineAudioProcessorEditor  : public juce::AudioProcessorEditor,
+                                       private juce::Timer
 {
 public:
     GhostlineAudioProcessorEditor (GhostlineAudioProcessor&);
@@ -25,7 +27,20 @@ public:
     void resized() override;
 
 private:
+    void timerCallback() override;
     void initializeBackground();
+    void drawBackground (juce::Graphics&) const;
+    juce::Image getBackgroundImage (int pixelWidth, int pixelHeight);
+    
+    // Shared styling for the controls added alongside the original six knobs
+    void initializeKnob (juce::Slider& slider, juce::Label& label, const juce::String& name,
+                         juce::Colour fill, juce::Colour outline, juce::Colour thumb);
+    void initializeSelector (juce::ComboBox& box, juce::Label& label, const juce::String& name,
+                             const juce::String& parameterID);
+    void initializeSelector (juce::ComboBox& box, const juce::String& parameterID);
+    void initializeLabel (juce::Label& label, const juce::String& name);
+    void initializeToggle (juce::ToggleButton& button);
+    void initializeSmallKnob (juce::Slider& slider, juce::Colour fill, juce::Colour outline);
     GhostlineAudioProcessor& audioProcessor;
 
     // Spooky spacey theme colors
@@ -51,12 +66,147 @@ private:
     juce::Label modRateLabel;
     juce::Label modDepthLabel;
     
+    // One MIX knob instead of WET and DRY, when a crossfade law is chosen
+    juce::ComboBox mixLawBox;
+    juce::Label mixLawLabel;
+    juce::Slider mixSlider;
+    juce::Label mixLabel;
+    
+    juce::ComboBox modShapeBox;
+    juce::Label modShapeLabel;
+    juce::Slider modSpreadSlider;
+    juce::Label modSpreadLabel;
+    
+    juce::ComboBox interpolationBox;
+    juce::Label interpolationLabel;
+    
+    // Record-path saturation; the oversampling label shows the filter latency the loop absorbs
+    juce::ComboBox saturationBox;
+    juce::Label saturationLabel;
+    juce::Slider overdriveSlider;
+    juce::Label overdriveLabel;
+    juce::ComboBox oversamplingBox;
+    juce::Label oversamplingLabel;
+    
+    // Tape model: switch and a small knob for each part of the transport and playback
+    juce::ToggleButton tapeModeButton { "Tape Model" };
+    juce::Slider wowSlider, flutterSlider, hissSlider, tapeAgeSlider;
+    juce::Label wowLabel, flutterLabel, hissLabel, tapeAgeLabel;
+    
+    // Loop filters: a small knob each for the high-pass, low-pass and tilt, and the DC blocker switch
+    juce::Slider loopHighPassSlider, loopLowPassSlider, loopTiltSlider;
+    juce::Label loopHighPassLabel, loopLowPassLabel, loopTiltLabel;
+    juce::ToggleButton loopDcButton { "DC Block" };
+    
+    // Diffusion: how far each echo is smeared, and the size of the space
+    juce::Slider diffusionSlider, diffusionSizeSlider;
+    juce::Label diffusionLabel, diffusionSizeLabel;
+    
+    // Stereo matrix: mode, cross-feedback amount and each side's time offset
+    juce::ComboBox stereoModeBox;
+    juce::Label stereoModeLabel;
+    juce::Slider crossFeedbackSlider, leftOffsetSlider, rightOffsetSlider;
+    juce::Label crossFeedbackLabel, leftOffsetLabel, rightOffsetLabel;
+    
+    // CPU governor: switch and the tier it is on
+    juce::ToggleButton adaptiveQualityButton { "Adaptive Quality" };
+    juce::Label qualityLabel;
+    
+    // Histogram of block loads from the profiler, 0 to 200% of the budget,
+    // with the budget marked and the latest load along the bottom. A click
+    // clears it.
+    class CpuMeter  : public juce::Component
+    {
+    public:
+        CpuMeter (ghostline::BlockProfiler& profilerToShow, juce::Colour normal, juce::Colour warning, juce::Colour budget);
+        
+        void update();
+        void paint (juce::Graphics&) override;
+        void mouseDown (const juce::MouseEvent&) override;
+        
+        const ghostline::BlockProfiler::Statistics& getStatistics() const noexcept { return statistics; }
+        
+    private:
+        ghostline::BlockProfiler& profiler;
+        ghostline::BlockProfiler::Statistics statistics;
+        juce::Colour normalColour, warningColour, budgetColour;
+    };
+    
+    CpuMeter cpuMeter { audioProcessor.getProfiler(), ghostGreen, ghostOrange, ghostCyan };
+    
+    // Echo decay and spectrum along the bottom
+    EchoVisualiser visualiser { audioProcessor.getVisualiserFeed(), spookyBlack, ghostGreen, ghostPurple, ghostCyan };
+    
+    // Saves the last few thousand blocks as a Chrome/Perfetto trace
+    juce::TextButton traceButton { "Trace" };
+    std::unique_ptr<juce::FileChooser> traceChooser;
+    void saveTrace();
+    
+    // Long-delay mode
+    juce::ToggleButton longModeButton { "Long Delay" };
+    juce::Slider longTimeSlider;
+    juce::Label longTimeLabel;
+    juce::ComboBox storageBox;
+    juce::Label storageLabel;
+    
+    // Tempo sync: each division selector has its on/off switch underneath
+    juce::ComboBox divisionBox;
+    juce::ToggleButton syncButton { "Sync" };
+    juce::ComboBox modDivisionBox;
+    juce::ToggleButton modSyncButton { "Mod Sync" };
+    
+    // Multi-head mode: switch, head count and a strip of small knobs per head
+    struct HeadControls
+    {
+        juce::Slider time, level, pan;
+        juce::Label label;
+        std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> timeAttachment, levelAttachment, panAttachment;
+    };
+    
+    juce::ToggleButton multiHeadButton { "Multi-Head" };
+    juce::ComboBox headCountBox;
+    std::array<HeadControls, ghostline::MultiHeadEcho::maxHeads> headControls;
+    juce::Label headTimeCaption, headLevelCaption, headPanCaption;
+    
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> delayTimeAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> feedbackAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> wetAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> dryAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> modRateAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> modDepthAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> mixLawAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> mixAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> modShapeAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> modSpreadAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> interpolationAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> saturationAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> overdriveAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> oversamplingAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> tapeModeAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> wowAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> flutterAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> hissAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> tapeAgeAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> loopHighPassAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> loopLowPassAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> loopTiltAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> loopDcAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> diffusionAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> diffusionSizeAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> stereoModeAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> crossFeedbackAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> leftOffsetAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> rightOffsetAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> adaptiveQualityAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> longModeAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> longTimeAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> storageAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> divisionAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> syncAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> modDivisionAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> modSyncAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> multiHeadAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> headCountAttachment;
 
     // Cached background elements to prevent movement on repaint
     struct FogCircle
@@ -69,7 +219,16 @@ private:
     };
     std::vector<FogCircle> fogCircles;
     std::vector<OrbCircle> orbCircles;
-    bool backgroundInitialized = false;
+    
+    // Background, title included, rendered at each pixel size in use and
+    // shared by every open editor
+    struct BackgroundCache
+    {
+        std::map<std::pair<int, int>, juce::Image> images;
+    };
+    
+    juce::SharedResourcePointer<BackgroundCache> backgroundCache;
+    juce::Image background;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GhostlineAudioProcessorEditor)
 };
@@ -7,9 +7,76 @@
 */
 
 #include "PluginProcessor.h"
-#include "PluginEditor.h"
+#if ! GHOSTLINE_HEADLESS
+ #include "PluginEditor.h"
+#endif
 #include <cmath>
 
+namespace
+{
+    // Which pan gain a channel of the bus takes in multi-head mode
+    float getChannelSide (juce::AudioChannelSet::ChannelType type)
+    {
+        switch (type)
+        {
+            case juce::AudioChannelSet::left:
+            case juce::AudioChannelSet::leftCentre:
+            case juce::AudioChannelSet::leftSurround:
+            case juce::AudioChannelSet::leftSurroundSide:
+            case juce::AudioChannelSet::leftSurroundRear:
+            case juce::AudioChannelSet::wideLeft:
+            case juce::AudioChannelSet::topFrontLeft:
+            case juce::AudioChannelSet::topSideLeft:
+            case juce::AudioChannelSet::topRearLeft:
+                return -1.0f;
+                
+            case juce::AudioChannelSet::right:
+            case juce::AudioChannelSet::rightCentre:
+            case juce::AudioChannelSet::rightSurround:
+            case juce::AudioChannelSet::rightSurroundSide:
+            case juce::AudioChannelSet::rightSurroundRear:
+            case juce::AudioChannelSet::wideRight:
+            case juce::AudioChannelSet::topFrontRight:
+            case juce::AudioChannelSet::topSideRight:
+            case juce::AudioChannelSet::topRearRight:
+                return 1.0f;
+                
+            default:
+                // Centre, LFE, ambisonic and discrete channels
+                return 0.0f;
+        }
+    }
+    
+    // Time for a full-scale echo to fall below threshold, losing feedback on every pass
+    double getDecaySeconds (double secondsPerPass, float feedback, float threshold)
+    {
+        if (feedback >= 1.0f)
+            return std::numeric_limits<double>::infinity();
+        
+        const double passes = feedback > 0.0f ? std::log (static_cast<double> (threshold)) / std::log (static_cast<double> (feedback)) : 0.0;
+        return secondsPerPass * (1.0 + std::ceil (passes));
+    }
+    
+    // Times everything up to the end of its scope, whichever way processBlock returns
+    struct ScopedBlockMeasurement
+    {
+        ScopedBlockMeasurement (ghostline::BlockProfiler& p, ghostline::QualityGovernor& g, int n) noexcept
+            : profiler (p), governor (g), numSamples (n)
+        {
+            profiler.beginBlock();
+        }
+        
+        ~ScopedBlockMeasurement()
+        {
+            governor.addBlock (profiler.endBlock (numSamples), numSamples);
+        }
+        
+        ghostline::BlockProfiler& profiler;
+        ghostline::QualityGovernor& governor;
+        const int numSamples;
+    };
+}
+
 //==============================================================================
 GhostlineAudioProcessor::GhostlineAudioProcessor()
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -28,23 +95,71 @@ GhostlineAudioProcessor::GhostlineAudioProcessor()
     feedbackParam = apvts.getRawParameterValue("FEEDBACK");
     wetLevelParam = apvts.getRawParameterValue("WET");
     dryLevelParam = apvts.getRawParameterValue("DRY");
+    mixParam = apvts.getRawParameterValue("MIX");
+    mixLawParam = apvts.getRawParameterValue("MIXLAW");
     modulationRateParam = apvts.getRawParameterValue("MODRATE");
     modulationDepthParam = apvts.getRawParameterValue("MODDEPTH");
+    modulationShapeParam = apvts.getRawParameterValue("MODSHAPE");
+    modulationSpreadParam = apvts.getRawParameterValue("MODSPREAD");
+    longModeParam = apvts.getRawParameterValue("LONGMODE");
+    longDelayTimeParam = apvts.getRawParameterValue("LONGTIME");
+    storageFormatParam = apvts.getRawParameterValue("STORAGE");
+    delaySyncParam = apvts.getRawParameterValue("SYNC");
+    delayDivisionParam = apvts.getRawParameterValue("DIVISION");
+    modulationSyncParam = apvts.getRawParameterValue("MODSYNC");
+    modulationDivisionParam = apvts.getRawParameterValue("MODDIVISION");
+    multiHeadParam = apvts.getRawParameterValue("HEADMODE");
+    headCountParam = apvts.getRawParameterValue("HEADCOUNT");
+    interpolationParam = apvts.getRawParameterValue("INTERP");
+    saturationParam = apvts.getRawParameterValue("SATURATION");
+    overdriveParam = apvts.getRawParameterValue("OVERDRIVE");
+    oversamplingParam = apvts.getRawParameterValue("OVERSAMPLE");
+    tapeModeParam = apvts.getRawParameterValue("TAPEMODE");
+    wowParam = apvts.getRawParameterValue("WOW");
+    flutterParam = apvts.getRawParameterValue("FLUTTER");
+    hissParam = apvts.getRawParameterValue("HISS");
+    tapeAgeParam = apvts.getRawParameterValue("TAPEAGE");
+    adaptiveQualityParam = apvts.getRawParameterValue("ADAPTIVE");
+    loopHighPassParam = apvts.getRawParameterValue("LOOPHP");
+    loopLowPassParam = apvts.getRawParameterValue("LOOPLP");
+    loopTiltParam = apvts.getRawParameterValue("LOOPTILT");
+    loopDcBlockParam = apvts.getRawParameterValue("LOOPDC");
+    diffusionParam = apvts.getRawParameterValue("DIFFUSION");
+    diffusionSizeParam = apvts.getRawParameterValue("DIFFSIZE");
+    stereoModeParam = apvts.getRawParameterValue("STEREOMODE");
+    crossFeedbackParam = apvts.getRawParameterValue("CROSSFEED");
+    leftOffsetParam = apvts.getRawParameterValue("LEFTOFFSET");
+    rightOffsetParam = apvts.getRawParameterValue("RIGHTOFFSET");
     
-    // Initialize delay buffers with default size (will be resized in prepareToPlay)
-    delayBuffer.resize(2);
-    for (int ch = 0; ch < 2; ++ch)
+    for (int head = 0; head < ghostline::MultiHeadEcho::maxHeads; ++head)
     {
-        delayBuffer[ch].resize(delayBufferSize, 0.0f);
-        
-        // Initialize smoothed delay time
-        smoothedDelayTime[ch].reset(44100.0, 0.05); // 50ms ramp time
-        smoothedDelayTime[ch].setCurrentAndTargetValue(cachedDelayTime);
+        const juce::String prefix = "HEAD" + juce::String (head + 1);
+        headLevelParams[head] = apvts.getRawParameterValue (prefix + "LEVEL");
+        headPanParams[head] = apvts.getRawParameterValue (prefix + "PAN");
+        headTimeParams[head] = apvts.getRawParameterValue (prefix + "TIME");
+    }
+    
+    // Every change to these is queued with the time it arrived
+    const char* automatedIDs[numAutomatedValues] = { "DELAYTIME", "LONGTIME", "FEEDBACK", "WET", "DRY", "MIX" };
+    
+    for (int value = 0; value < numAutomatedValues; ++value)
+    {
+        automatedParameters[value] = apvts.getParameter (automatedIDs[value]);
+        automatedParameters[value]->addListener (this);
     }
+    
+    resyncAutomatedValues();
+    
+    // Delay buffers and per-channel state are sized from the bus layout in prepareToPlay
+    startTimerHz (10);
 }
 
 GhostlineAudioProcessor::~GhostlineAudioProcessor()
 {
+    stopTimer();
+    
+    for (auto* parameter : automatedParameters)
+        parameter->removeListener (this);
 }
 
 //==============================================================================
@@ -82,7 +197,8 @@ bool GhostlineAudioProcessor::isMidiEffect() const
 
 double GhostlineAudioProcessor::getTailLengthSeconds() const
 {
-    return 2.0; // Tail for delay feedback
+    // Worked out from the settings in updateParameters
+    return tailLengthSeconds.load();
 }
 
 int GhostlineAudioProcessor::getNumPrograms()
@@ -113,35 +229,176 @@ void GhostlineAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBl
 {
     currentSampleRate = sampleRate;
     
-    delayBufferSize = static_cast<int> (sampleRate * 1.0); // 1 second max delay
+    // One set of echo state per bus channel, whatever the layout
+    const int numChannels = juce::jmax (1, getTotalNumOutputChannels());
+    const auto layout = getChannelLayoutOfBus (false, 0);
+    
+    channelStates.clear();
+    channelStates.resize (static_cast<size_t> (numChannels));
+    multiHeadEcho.prepare (numChannels);
     
-    // Resize and reinitialize delay buffers
-    for (int ch = 0; ch < 2; ++ch)
+    for (int ch = 0; ch < numChannels; ++ch)
     {
-        delayBuffer[ch].resize(delayBufferSize, 0.0f);
-        writePosition[ch] = 0;
-        lfoPhase[ch] = 0.0f;
+        auto& state = channelStates[static_cast<size_t> (ch)];
         
-        // Initialize smoothed delay time with ramp time of 50ms
-        smoothedDelayTime[ch].reset(sampleRate, 0.05);
-        smoothedDelayTime[ch].setCurrentAndTargetValue(cachedDelayTime);
+        // Give each channel its own random sequence so the Random shape decorrelates them
+        state.lfo.setRandomSeed (0x9e3779b9u + static_cast<juce::uint32> (ch) * 0x85ebca6bu);
+        state.lfo.prepare (sampleRate);
+        
+        state.side = getChannelSide (layout.getTypeOfChannel (ch));
+        multiHeadEcho.setChannelSide (ch, state.side);
     }
     
-    juce::dsp::ProcessSpec spec;
-    spec.sampleRate = sampleRate;
-    spec.maximumBlockSize = static_cast<juce::uint32> (samplesPerBlock);
-    spec.numChannels = static_cast<juce::uint32> (getTotalNumOutputChannels());
+    // Anything still queued is already in the atomics
+    parameterEvents.reset();
+    resyncAutomatedValues();
+    
+    allocateDelayMemory();
+    
+    // Scratch for the channel being processed; every channel reuses it in turn,
+    // except that a linked stereo pair needs both sides' read distances and dry
+    // signal at once. Only the precision the host asked for is allocated
+    const int scratchSize = juce::jmax (1, samplesPerBlock);
+    lfoBuffer.setSize (1, scratchSize);
+    
+    auto sizeLoopBuffers = [] (auto& buffers, int size)
+    {
+        buffers.delaySamples.setSize (2, size);
+        buffers.dry.setSize (2, size);
+        buffers.fade.setSize (2, size);
+    };
+    
+    sizeLoopBuffers (floatBuffers, isUsingDoublePrecision() ? 0 : scratchSize);
+    sizeLoopBuffers (doubleBuffers, isUsingDoublePrecision() ? scratchSize : 0);
+    
+    qualityGovernor.prepare (sampleRate);
+    profiler.prepare (sampleRate);
+    visualiserFeed.prepare (sampleRate);
+    lastQualityTier = 0;
+    interpolationFadeLength = static_cast<int> (sampleRate * 0.02);
+    interpolationFadeRemaining = 0;
+    
+    mixStage.prepare (sampleRate, juce::jmax (1, samplesPerBlock));
+    smoothedFeedback.reset (sampleRate, 0.05);
     
-    wetGain.prepare (spec);
-    dryGain.prepare (spec);
+    feedbackSaturator.prepare (juce::jmax (1, samplesPerBlock), numChannels);
+    tapeModel.prepare (sampleRate, numChannels);
+    feedbackFilter.prepare (sampleRate, numChannels);
+    diffuser.prepare (sampleRate, numChannels);
     
     updateParameters();
+    updateAutomatedTargets();
+    
+    // Heads start on their spacing, the transport on its curve and the gains
+    // at their settings, instead of gliding in
+    multiHeadEcho.reset();
+    tapeModel.reset();
+    mixStage.reset();
+    stereoMatrix.reset();
+    smoothedFeedback.setCurrentAndTargetValue (cachedFeedback);
+}
+
+ghostline::DelayMemoryLayout GhostlineAudioProcessor::getWantedMemoryLayout() const
+{
+    const bool wantsLongDelay = longModeParam != nullptr && longModeParam->load() >= 0.5f;
+    
+    ghostline::DelayMemoryLayout layout;
+    layout.numChannels = juce::jmax (1, static_cast<int> (channelStates.size()));
+    layout.size = static_cast<int> (currentSampleRate * (wantsLongDelay ? maxLongDelaySeconds : maxDelaySeconds));
+    layout.format = wantsLongDelay && storageFormatParam != nullptr
+                      ? static_cast<ghostline::DelayStorageFormat> (static_cast<int> (storageFormatParam->load()))
+                      : ghostline::DelayStorageFormat::float32;
+    
+    // A double-precision loop keeps its history in double too
+    if (layout.format == ghostline::DelayStorageFormat::float32 && isUsingDoublePrecision())
+        layout.format = ghostline::DelayStorageFormat::float64;
+    
+    return layout;
+}
+
+void GhostlineAudioProcessor::allocateDelayMemory()
+{
+    // Audio is stopped here, so build (or clear) the memory directly: no
+    // stale echoes survive a restart or a sample-rate change
+    requestedMemoryLayout = getWantedMemoryLayout();
+    delayMemory.prepare (requestedMemoryLayout);
+    samplesSinceLoudWrite = requestedMemoryLayout.size;
+    longDelayActive = requestedMemoryLayout.size > static_cast<int> (currentSampleRate * maxDelaySeconds);
+    
+    cachedDelayTime = automatedValues[longDelayActive ? automatedLongDelayTime : automatedDelayTime];
+    
+    if (leftOffsetParam != nullptr && rightOffsetParam != nullptr)
+    {
+        cachedLeftOffset = leftOffsetParam->load() * 0.001f;
+        cachedRightOffset = rightOffsetParam->load() * 0.001f;
+    }
+    
+    for (auto& state : channelStates)
+    {
+        state.floatRead = {};
+        state.doubleRead = {};
+        
+        // Initialize smoothed delay time with ramp time of 50ms
+        state.smoothedDelayTime.reset (currentSampleRate, 0.05);
+        state.smoothedDelayTime.setCurrentAndTargetValue (getChannelDelayTime (state, cachedDelayTime));
+    }
+    
+    multiHeadEcho.reset();
+    multiHeadEcho.resetInterpolators();
+    feedbackSaturator.reset();
+    feedbackFilter.reset();
+    diffuser.reset();
+    tapeModel.reset();
+}
+
+void GhostlineAudioProcessor::timerCallback()
+{
+    // The history carries across, so the echoes keep playing through the change
+    const auto wanted = getWantedMemoryLayout();
+    
+    if (wanted == requestedMemoryLayout || delayMemory.getActive() == nullptr)
+        return;
+    
+    requestedMemoryLayout = wanted;
+    delayMemory.requestLayout (wanted);
+}
+
+void GhostlineAudioProcessor::resyncAutomatedValues()
+{
+    for (int value = 0; value < numAutomatedValues; ++value)
+        automatedValues[value] = automatedParameters[value]->convertFrom0to1 (automatedParameters[value]->getValue());
+}
+
+void GhostlineAudioProcessor::parameterValueChanged (int parameterIndex, float newValue)
+{
+    for (int value = 0; value < numAutomatedValues; ++value)
+    {
+        auto* parameter = automatedParameters[value];
+        
+        if (parameter == nullptr || parameter->getParameterIndex() != parameterIndex)
+            continue;
+        
+        // Live changes from any thread but the audio one are placed by when they
+        // arrived; the rest ramp there over a fixed length from the next block
+        const bool stamp = ! isNonRealtime() && juce::Thread::getCurrentThreadId() != audioThread.load (std::memory_order_relaxed);
+        parameterEvents.add (value, parameter->convertFrom0to1 (newValue), stamp);
+        return;
+    }
+}
+
+template <typename SampleType>
+bool GhostlineAudioProcessor::isInputSilent (const juce::AudioBuffer<SampleType>& buffer, int numChannels) const
+{
+    for (int channel = 0; channel < numChannels; ++channel)
+        if (buffer.getMagnitude (channel, 0, buffer.getNumSamples()) >= silenceThreshold)
+            return false;
+    
+    return true;
 }
 
 void GhostlineAudioProcessor::releaseResources()
 {
-    wetGain.reset();
-    dryGain.reset();
+    mixStage.reset();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -151,8 +408,9 @@ bool GhostlineAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts
     juce::ignoreUnused (layouts);
     return true;
   #else
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Any layout from mono up to surround, immersive and ambisonic buses;
+    // every channel gets its own echo
+    if (layouts.getMainOutputChannelSet().isDisabled())
         return false;
 
    #if ! JucePlugin_IsSynth
@@ -165,10 +423,26 @@ bool GhostlineAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts
 }
 #endif
 
+bool GhostlineAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
+}
+
 void GhostlineAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ignoreUnused (midiMessages);
-    
+    processSamples (buffer);
+}
+
+void GhostlineAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    juce::ignoreUnused (midiMessages);
+    processSamples (buffer);
+}
+
+template <typename SampleType>
+void GhostlineAudioProcessor::processSamples (juce::AudioBuffer<SampleType>& buffer)
+{
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
@@ -176,94 +450,426 @@ void GhostlineAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, ju
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    // Safety check - ensure delay buffers are initialized
-    if (delayBuffer.size() < 2 || delayBuffer[0].size() == 0 || delayBuffer[1].size() == 0)
+    // Take over rebuilt delay memory before anything reads it
+    const bool memoryChanged = delayMemory.adoptPending();
+    if (memoryChanged)
+        longDelayActive = delayMemory.getActive()->getLayout().size > static_cast<int> (currentSampleRate * maxDelaySeconds);
+    
+    // Safety check - ensure delay buffers are initialized, for this precision
+    auto* memory = delayMemory.getActive();
+    auto& loopBuffers = getLoopBuffers<SampleType>();
+    
+    if (memory == nullptr || ! memory->suitsPrecision<SampleType>() || lfoBuffer.getNumSamples() == 0
+        || loopBuffers.delaySamples.getNumSamples() == 0 || loopBuffers.dry.getNumSamples() == 0
+        || loopBuffers.fade.getNumSamples() == 0)
         return;
+    
+    // Everything from here on counts against the block's real-time budget
+    const ScopedBlockMeasurement measurement (profiler, qualityGovernor, buffer.getNumSamples());
+    audioThread.store (juce::Thread::getCurrentThreadId(), std::memory_order_relaxed);
 
+    // Tempo, divisions and LFO phase are resolved once per block, never per sample
+    transport.update (getPlayHead());
     updateParameters();
     
+    // A dropped change leaves the queue behind the atomics: start again from them
+    if (parameterEvents.takeOverflow())
+    {
+        parameterEvents.reset();
+        resyncAutomatedValues();
+    }
+    
     const int numSamples = buffer.getNumSamples();
-    const float sampleRate = static_cast<float> (currentSampleRate);
+    parameterEvents.beginBlock (numSamples);
     
-    // Process each channel
-    for (int channel = 0; channel < totalNumInputChannels && channel < 2; ++channel)
+    // Split the block wherever an automated value changes, and into short
+    // steps while feedback glides; every stretch gets its own loop variant
+    for (int start = 0; start < numSamples;)
     {
-        float* channelData = buffer.getWritePointer (channel);
-        const float feedback = cachedFeedback;
-        const float wet = cachedWetLevel;
-        const float dry = cachedDryLevel;
-        const float modRate = cachedModulationRate;
+        parameterEvents.applyUntil (start, automatedValues);
+        updateAutomatedTargets();
+        
+        // A new mode means a new delay time; start there rather than sweep the
+        // heads across the whole history to reach it
+        if (memoryChanged && start == 0)
+            for (auto& state : channelStates)
+                state.smoothedDelayTime.setCurrentAndTargetValue (state.smoothedDelayTime.getTargetValue());
+        
+        int end = juce::jmin (numSamples, parameterEvents.getNextEventSample());
+        
+        if (smoothedFeedback.isSmoothing())
+            end = juce::jmin (end, start + feedbackStepSamples);
+        
+        // A linked stereo pair holds the left side back until the right is ready,
+        // which only works if the whole stretch fits the scratch in one slice
+        if (stereoMatrix.isLinked())
+            end = juce::jmin (end, start + juce::jmin (lfoBuffer.getNumSamples(), loopBuffers.delaySamples.getNumSamples()));
+        
+        juce::AudioBuffer<SampleType> subBlock (buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, end - start);
+        processSubBlock (subBlock, *memory, start);
+        start = end;
+    }
+}
+
+template <typename SampleType>
+void GhostlineAudioProcessor::processSubBlock (juce::AudioBuffer<SampleType>& buffer, ghostline::DelayMemory& memory, int blockOffset)
+{
+    auto& loopBuffers = getLoopBuffers<SampleType>();
+    const bool useCompactStorage = memory.usesCompactStorage();
+    const int delayBufferSize = memory.getLayout().size;
+    const int numSamples = buffer.getNumSamples();
+    const int numChannels = juce::jmin (getTotalNumInputChannels(), static_cast<int> (channelStates.size()), memory.getLayout().numChannels);
+    
+    // Gains move on once per sub-block, whichever path runs
+    mixStage.beginBlock (numSamples);
+    const auto blockFeedback = static_cast<SampleType> (smoothedFeedback.skip (numSamples));
+    
+    // Idle: nothing coming in and nothing any read can reach above the threshold,
+    // so the output would be silence. Keep time moving so the echo picks up in
+    // phase, and skip the loop.
+    if (samplesSinceLoudWrite >= getLongestReadDistance (delayBufferSize) && isInputSilent (buffer, numChannels))
+    {
+        buffer.clear();
+        
+        for (auto& state : channelStates)
+        {
+            state.lfo.advance (numSamples);
+            state.smoothedDelayTime.skip (numSamples);
+        }
+        
+        diffuser.skip();
+        memory.advance (numSamples);
+        samplesSinceLoudWrite += numSamples;
+        return;
+    }
+    
+    const auto sampleRate = static_cast<SampleType> (currentSampleRate);
+    const int maxSamplesPerSlice = juce::jmin (lfoBuffer.getNumSamples(), loopBuffers.delaySamples.getNumSamples(), loopBuffers.dry.getNumSamples());
+    
+    // Every channel runs the same loop on its own state; the scratch buffers are reused in turn.
+    // The LFO stays float in either precision: it only ever moves the read distance
+    const int blockWritePosition = memory.getWritePosition();
+    float* lfoValues = lfoBuffer.getWritePointer (0);
+    const int lfoInterval = qualityGovernor.getLfoInterval();
+    
+    // Crossfade gain at sample i of this block is (fadeStart + i) / fadeLength
+    const bool fadingInterpolation = interpolationFadeRemaining > 0 && ! cachedMultiHead;
+    const int fadeStart = interpolationFadeLength - interpolationFadeRemaining;
+    
+    // Cross-feedback and ping-pong run the two sides of a stereo pair as one loop: the
+    // left is set up and waits, then the right runs both
+    const bool stereoLinked = stereoMatrix.isLinked() && numChannels == 2;
+    ghostline::BasicDelayKernelContext<SampleType> leftContext;
+    int leftWritePosition = blockWritePosition;
+    float leftDistance = 0.0f;
+    
+    // Nothing between the read and the write: a fixed read distance can skip the per-sample array
+    const bool chunkedLoop = feedbackSaturator.isEnabled() || feedbackFilter.isEnabled() || diffuser.isEnabled()
+                             || tapeModel.isEnabled() || fadingInterpolation || stereoLinked;
+    const bool directLoop = ! (chunkedLoop
+                               || cachedMultiHead || useCompactStorage);
+    const auto mixShape = mixStage.getShape();
+    
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto& state = channelStates[static_cast<size_t> (channel)];
+        auto& lfo = state.lfo;
+        auto& smoothedDelayTime = state.smoothedDelayTime;
+        auto& readState = state.getReadState<SampleType>();
+        int writePosition = blockWritePosition;
+        SampleType* channelData = buffer.getWritePointer (channel);
+        SampleType* delaySamples = loopBuffers.delaySamples.getWritePointer (stereoLinked ? channel : 0);
+        SampleType* dry = loopBuffers.dry.getWritePointer (stereoLinked ? channel : 0);
         const float modDepth = cachedModulationDepth;
+        // Keep every read far enough inside the buffer for the widest interpolator
+        const auto minDelaySamples = static_cast<SampleType> (ghostline::interpolationMargin);
+        const auto maxDelaySamples = static_cast<SampleType> (delayBufferSize - ghostline::interpolationMargin);
         
-        const float lfoIncrement = (modRate * 10.0f) / sampleRate; // 0-10 Hz modulation
+        // Channels sit an equal share of MODSPREAD apart around the cycle
+        lfo.setPhaseOffset (cachedModulationSpread * static_cast<float> (channel) / static_cast<float> (numChannels));
+        lfo.setShape (static_cast<ghostline::LfoShape> (cachedModulationShape));
         
-        for (int sample = 0; sample < numSamples; ++sample)
+        if (cachedModulationSync)
         {
-            // Get smoothed delay time (updates smoothly per sample)
-            const float currentSmoothedDelay = smoothedDelayTime[channel].getNextValue();
+            // One LFO cycle per note division, phase-locked to the host's PPQ position
+            // while it plays so realtime and offline renders line up exactly
+            lfo.setFrequency (static_cast<float> (transport.bpm / (60.0 * cachedModulationBeats)));
             
-            // Update LFO phase
-            lfoPhase[channel] += lfoIncrement;
-            if (lfoPhase[channel] >= 1.0f)
-                lfoPhase[channel] -= 1.0f;
-            
-            // Calculate modulated delay time using smoothed delay time
-            const float lfoValue = std::sin (lfoPhase[channel] * juce::MathConstants<float>::twoPi);
-            const float modulatedDelay = currentSmoothedDelay + (lfoValue * modDepth * 0.01f); // Max 10ms modulation
-            float delaySamples = modulatedDelay * sampleRate;
-            
-            // Clamp delay to buffer size to prevent out-of-bounds access
-            delaySamples = juce::jlimit (1.0f, static_cast<float> (delayBufferSize - 1), delaySamples);
-            
-            // Calculate read position with fractional precision for smooth interpolation
-            float readPos = static_cast<float>(writePosition[channel]) - delaySamples;
-            if (readPos < 0.0f)
-                readPos += static_cast<float>(delayBufferSize);
-            
-            // Wrap read position
-            while (readPos >= static_cast<float>(delayBufferSize))
-                readPos -= static_cast<float>(delayBufferSize);
-            while (readPos < 0.0f)
-                readPos += static_cast<float>(delayBufferSize);
-            
-            // Linear interpolation with proper bounds checking
-            const int readPosInt = static_cast<int> (readPos);
-            const float fraction = readPos - static_cast<float>(readPosInt);
-            int readPosNext = readPosInt + 1;
-            if (readPosNext >= delayBufferSize)
-                readPosNext = 0;
+            if (transport.hasPosition)
+                lfo.syncToCycle (transport.getPpqPositionAfter (blockOffset, currentSampleRate) / cachedModulationBeats);
+        }
+        else
+        {
+            lfo.setFrequency (cachedModulationRate * 10.0f); // 0-10 Hz modulation
+        }
+        
+        // Pick this channel's specialisation of the loop once, for the whole block
+        const ghostline::BlockVariant variant { modDepth > 0.0f, smoothedDelayTime.isSmoothing(), mixShape };
+        
+        ghostline::visitBlockVariant (variant, [&] (auto traits)
+        {
+            using Traits = decltype (traits);
             
-            // Safety check for array bounds
-            float delayedSample = 0.0f;
-            if (readPosInt >= 0 && readPosInt < delayBufferSize && 
-                readPosNext >= 0 && readPosNext < delayBufferSize)
+            // Hosts may send more samples than announced in prepareToPlay, so work in
+            // slices no larger than the scratch buffer
+            for (int start = 0; start < numSamples; start += maxSamplesPerSlice)
             {
-                delayedSample = delayBuffer[channel][readPosInt] * (1.0f - fraction) +
-                              delayBuffer[channel][readPosNext] * fraction;
-            }
-            
-            // Mix dry and wet
-            const float input = channelData[sample];
-            const float output = (input * dry) + (delayedSample * wet);
-            
-            // Write to delay buffer with feedback
-            delayBuffer[channel][writePosition[channel]] = input + (delayedSample * feedback);
-            writePosition[channel] = (writePosition[channel] + 1) % delayBufferSize;
+                const int sliceLength = juce::jmin (maxSamplesPerSlice, numSamples - start);
+                
+                // Nobody hears the echo and nothing feeds it back: record the input and move on.
+                // The loop filters and the diffuser would colour even that, so they take the long way
+                if constexpr (Traits::mix == ghostline::MixShape::dryOnly)
+                {
+                    if (blockFeedback == SampleType (0) && ! feedbackFilter.isEnabled() && ! diffuser.isEnabled() && ! stereoLinked)
+                    {
+                        lfo.advance (sliceLength);
+                        
+                        if constexpr (Traits::ramping)
+                            smoothedDelayTime.skip (sliceLength);
+                        
+                        SampleType* input = channelData + start;
+                        memory.visitChannelFor<SampleType> (channel, [&] (const auto& history)
+                        {
+                            ghostline::recordDelayInput (history, input, sliceLength, writePosition);
+                        });
+                        
+                        mixStage.processDryOnly (input, input, sliceLength);
+                        continue;
+                    }
+                }
+                
+                // Set when the whole slice reads at one distance and the direct loop can use it as is
+                bool settledRead = false;
+                SampleType settledDelay = 0;
+                
+                if constexpr (Traits::modulated)
+                {
+                    // Render the whole slice of LFO values at once, or a line through
+                    // every lfoInterval-th value when the governor is saving time
+                    if (lfoInterval > 1)
+                        lfo.processAtControlRate (lfoValues, sliceLength, lfoInterval);
+                    else
+                        lfo.process (lfoValues, sliceLength);
+                    
+                    for (int sample = 0; sample < sliceLength; ++sample)
+                    {
+                        // Calculate modulated delay time using smoothed delay time
+                        const float currentSmoothedDelay = Traits::ramping ? smoothedDelayTime.getNextValue() : smoothedDelayTime.getCurrentValue();
+                        const float modulatedDelay = currentSmoothedDelay + (lfoValues[sample] * modDepth * 0.01f); // Max 10ms modulation
+                        
+                        // Clamp delay to buffer size to prevent out-of-bounds access
+                        delaySamples[sample] = juce::jlimit (minDelaySamples, maxDelaySamples, static_cast<SampleType> (modulatedDelay) * sampleRate);
+                    }
+                }
+                else
+                {
+                    // No modulation: keep the LFO phase moving but skip rendering it
+                    lfo.advance (sliceLength);
+                    
+                    if constexpr (Traits::ramping)
+                    {
+                        for (int sample = 0; sample < sliceLength; ++sample)
+                            delaySamples[sample] = juce::jlimit (minDelaySamples, maxDelaySamples, static_cast<SampleType> (smoothedDelayTime.getNextValue()) * sampleRate);
+                    }
+                    else
+                    {
+                        settledDelay = juce::jlimit (minDelaySamples, maxDelaySamples, static_cast<SampleType> (smoothedDelayTime.getCurrentValue()) * sampleRate);
+                        settledRead = directLoop && settledDelay >= static_cast<SampleType> (ghostline::minimumSettledDelay);
+                        
+                        if (! settledRead)
+                            std::fill (delaySamples, delaySamples + sliceLength, settledDelay);
+                    }
+                }
+                
+                if (tapeModel.isEnabled())
+                    tapeModel.modulate (channel, delaySamples, sliceLength, minDelaySamples, maxDelaySamples);
+                
+                // Read, mix and write back with feedback, several samples at a time
+                ghostline::BasicDelayKernelContext<SampleType> context;
+                context.channelData = channelData + start;
+                context.delayBuffer = useCompactStorage ? nullptr : memory.getMirroredBuffer<SampleType>().getWritePointer (channel);
+                context.delayBufferSize = delayBufferSize;
+                context.writePosition = &writePosition;
+                context.delaySamples = delaySamples;
+                context.numSamples = sliceLength;
+                context.interpolation = cachedInterpolation;
+                context.interpolatorState = &readState.current;
+                context.feedback = blockFeedback;
+                
+                // The loop overwrites the input with the echo; a wet-only mix never needs it again
+                if constexpr (Traits::mix != ghostline::MixShape::wetOnly)
+                    juce::FloatVectorOperations::copy (dry, context.channelData, sliceLength);
+                
+                const float closestDelay = chunkedLoop ? static_cast<float> (juce::FloatVectorOperations::findMinimum (delaySamples, sliceLength))
+                                                           * (cachedMultiHead ? multiHeadEcho.getShortestRatio (channel) : 1.0f)
+                                                       : 0.0f;
+                
+                // Only what goes into the loop is washed; the dry signal stays as it came. The smear
+                // leaves the closest read at least a settled span clear of the write, so the loop
+                // still runs in chunks of a useful length
+                if (diffuser.isEnabled())
+                {
+                    diffuser.beginSlice (channel, sliceLength, closestDelay - feedbackSaturator.getLatencyInSamples()
+                                                                 - static_cast<float> (ghostline::interpolationMargin) - ghostline::minimumSettledDelay);
+                    diffuser.wash (channel, context.channelData, sliceLength);
+                }
+                
+                if (chunkedLoop)
+                {
+                    // Saturation, the loop filters, the smear and tape colour sit inside the loop, so it runs
+                    // in chunks. The oversampling filters and the allpasses delay what gets recorded, so
+                    // every head reads that much closer to keep the echoes on time. The smear's share
+                    // glides through the slice, a step per sample
+                    auto getLatency = [this] (int side) { return feedbackSaturator.getLatencyInSamples() + diffuser.getLatencyInSamples (side); };
+                    
+                    const float shortestDistance = juce::jmax (static_cast<float> (ghostline::interpolationMargin),
+                                                               closestDelay - feedbackSaturator.getLatencyInSamples() - diffuser.getPeakLatencyInSamples (channel));
+                    
+                    auto readSide = [&] (int side, const auto& history, const ghostline::BasicDelayKernelContext<SampleType>& chunk,
+                                         SampleType* wet, SampleType* feedback)
+                    {
+                        const float latency = getLatency (side);
+                        const float latencyStep = diffuser.getLatencyStep (side);
+                        
+                        if (cachedMultiHead)
+                            multiHeadEcho.read (history, side, chunk, latency, wet, feedback, latencyStep);
+                        else
+                            ghostline::readEcho (history, chunk, latency, wet, feedback, latencyStep);
+                    
+                        if (fadingInterpolation)
+                        {
+                            // Read again the old way and blend across; both reads see the same history
+                            auto previous = chunk;
+                            previous.interpolation = fadeFromInterpolation;
+                            previous.interpolatorState = &channelStates[static_cast<size_t> (side)].getReadState<SampleType>().fading;
+                        
+                            SampleType* previousWet = loopBuffers.fade.getWritePointer (0);
+                            ghostline::readEcho (history, previous, latency, previousWet, loopBuffers.fade.getWritePointer (1), latencyStep);
+                        
+                            const SampleType* sideDelaySamples = loopBuffers.delaySamples.getReadPointer (stereoLinked ? side : 0);
+                            const int offset = fadeStart + start + static_cast<int> (chunk.delaySamples - sideDelaySamples);
+                            const SampleType fadeStep = SampleType (1) / static_cast<SampleType> (interpolationFadeLength);
+                        
+                            for (int i = 0; i < chunk.numSamples; ++i)
+                            {
+                                const SampleType gain = juce::jmin (SampleType (1), static_cast<SampleType> (offset + i) * fadeStep);
+                                wet[i] = previousWet[i] + gain * (wet[i] - previousWet[i]);
+                            }
+                        
+                            juce::FloatVectorOperations::copy (feedback, wet, chunk.numSamples);
+                        }
+                    
+                        if (tapeModel.isEnabled())
+                            tapeModel.colour (side, wet, feedback, chunk.numSamples, ! cachedMultiHead);
+                    };
+                    
+                    auto shapeSide = [&] (int side, SampleType* record, int length)
+                    {
+                        if (feedbackFilter.isEnabled())
+                            feedbackFilter.process (side, record, length);
+                    
+                        if (diffuser.isEnabled())
+                            diffuser.smear (side, record, length);
+                    };
+                    
+                    if (! stereoLinked)
+                    {
+                        memory.visitChannelFor<SampleType> (channel, [&] (const auto& history)
+                        {
+                            feedbackSaturator.process (channel, history, context, shortestDistance,
+                                                       [&] (const auto& chunk, SampleType* wet, SampleType* feedback) { readSide (channel, history, chunk, wet, feedback); },
+                                                       [&] (SampleType* record, int length) { shapeSide (channel, record, length); });
+                        });
+                    }
+                    else if (channel == 0)
+                    {
+                        // Nothing is read or written yet; the right side runs both
+                        leftContext = context;
+                        leftContext.writePosition = &leftWritePosition;
+                        leftDistance = shortestDistance;
+                        continue;
+                    }
+                    else
+                    {
+                        const ghostline::BasicDelayKernelContext<SampleType> pair[] = { leftContext, context };
+                        
+                        memory.visitChannelFor<SampleType> (0, [&] (const auto& left)
+                        {
+                            memory.visitChannelFor<SampleType> (1, [&] (const auto& right)
+                            {
+                                feedbackSaturator.processStereo (left, right, pair, stereoMatrix, juce::jmin (leftDistance, shortestDistance), readSide, shapeSide);
+                            });
+                        });
+                        
+                        // The left side's echo is ready now too
+                        visualiserFeed.push (leftContext.channelData, sliceLength);
+                        
+                        if constexpr (Traits::mix == ghostline::MixShape::dryOnly)
+                            mixStage.processDryOnly (leftContext.channelData, loopBuffers.dry.getReadPointer (0), sliceLength);
+                        else
+                            mixStage.process (leftContext.channelData, loopBuffers.dry.getReadPointer (0), start, sliceLength);
+                    }
+                }
+                else if (cachedMultiHead)
+                {
+                    memory.visitChannelFor<SampleType> (channel, [&] (const auto& history) { multiHeadEcho.process (history, channel, context); });
+                }
+                else if (useCompactStorage)
+                {
+                    memory.getCompactBuffer().process (channel, context);
+                }
+                else if (settledRead)
+                {
+                    ghostline::processSettledDelayLoop (context, settledDelay);
+                }
+                else if constexpr (std::is_same_v<SampleType, float>)
+                {
+                    delayKernel.process (context);
+                }
+                else
+                {
+                    // Nothing vectorised in double yet: the reference loop at full precision
+                    ghostline::processDelayLoop (context);
+                }
             
-            channelData[sample] = output;
-        }
+                // The echo before the mix, for the editor; nothing unless one is showing
+                if (channel == 0)
+                    visualiserFeed.push (context.channelData, sliceLength);
+                
+                if constexpr (Traits::mix == ghostline::MixShape::dryOnly)
+                    mixStage.processDryOnly (context.channelData, dry, sliceLength);
+                else
+                    mixStage.process (context.channelData, dry, start, sliceLength);
+            }
+        });
     }
+    
+    // Watch what went into the memory: once everything the reads can reach is
+    // below the threshold, the tail has died away
+    bool wroteSound = false;
+    for (int channel = 0; channel < numChannels && ! wroteSound; ++channel)
+        wroteSound = memory.getMagnitude (channel, blockWritePosition, juce::jmin (numSamples, delayBufferSize)) >= silenceThreshold;
+    
+    samplesSinceLoudWrite = wroteSound ? 0 : samplesSinceLoudWrite + numSamples;
+    interpolationFadeRemaining = juce::jmax (0, interpolationFadeRemaining - numSamples);
+    
+    // Every channel wrote the same span; one count moves them all on
+    memory.advance (numSamples);
 }
 
 //==============================================================================
 bool GhostlineAudioProcessor::hasEditor() const
 {
-    return true;
+    return ! GHOSTLINE_HEADLESS;
 }
 
 juce::AudioProcessorEditor* GhostlineAudioProcessor::createEditor()
 {
+   #if GHOSTLINE_HEADLESS
+    return nullptr;
+   #else
     return new GhostlineAudioProcessorEditor (*this);
+   #endif
 }
 
 //==============================================================================
@@ -286,90 +892,233 @@ void GhostlineAudioProcessor::setStateInformation (const void* data, int sizeInB
 //==============================================================================
 void GhostlineAudioProcessor::updateParameters()
 {
-    const float tolerance = 0.001f;
-    
     // Safety check - ensure parameters are initialized
     if (delayTimeParam == nullptr || feedbackParam == nullptr || 
         wetLevelParam == nullptr || dryLevelParam == nullptr ||
-        modulationRateParam == nullptr || modulationDepthParam == nullptr)
+        mixParam == nullptr || mixLawParam == nullptr ||
+        modulationRateParam == nullptr || modulationDepthParam == nullptr ||
+        modulationShapeParam == nullptr || modulationSpreadParam == nullptr ||
+        longDelayTimeParam == nullptr ||
+        delaySyncParam == nullptr || delayDivisionParam == nullptr ||
+        modulationSyncParam == nullptr || modulationDivisionParam == nullptr ||
+        multiHeadParam == nullptr || headCountParam == nullptr ||
+        interpolationParam == nullptr || saturationParam == nullptr ||
+        oversamplingParam == nullptr || tapeModeParam == nullptr ||
+        wowParam == nullptr || flutterParam == nullptr ||
+        hissParam == nullptr || tapeAgeParam == nullptr ||
+        adaptiveQualityParam == nullptr ||
+        loopHighPassParam == nullptr || loopLowPassParam == nullptr ||
+        loopTiltParam == nullptr || loopDcBlockParam == nullptr ||
+        diffusionParam == nullptr || diffusionSizeParam == nullptr ||
+        stereoModeParam == nullptr || crossFeedbackParam == nullptr)
         return;
     
-    float delayTime = delayTimeParam->load();
-    float feedback = feedbackParam->load();
-    float wet = wetLevelParam->load();
-    float dry = dryLevelParam->load();
-    float modRate = modulationRateParam->load();
-    float modDepth = modulationDepthParam->load();
+    const auto saturation = static_cast<ghostline::SaturationCurve> (static_cast<int> (saturationParam->load()));
+    feedbackSaturator.setCurve (saturation);
+    feedbackSaturator.setOversampling (static_cast<int> (oversamplingParam->load()));
+    
+    tapeModel.setEnabled (tapeModeParam->load() >= 0.5f);
+    tapeModel.setParameters (wowParam->load(), flutterParam->load(), hissParam->load(), tapeAgeParam->load());
+    
+    feedbackFilter.setParameters (loopHighPassParam->load(), loopLowPassParam->load(),
+                                  loopTiltParam->load(), loopDcBlockParam->load() >= 0.5f);
+    diffuser.setParameters (diffusionParam->load(), diffusionSizeParam->load());
+    stereoMatrix.setParameters (static_cast<ghostline::StereoMode> (static_cast<int> (stereoModeParam->load())), crossFeedbackParam->load());
+    
+    // Offline renders have all the time they need; the governor only runs live
+    qualityGovernor.setEnabled (adaptiveQualityParam->load() >= 0.5f && ! isNonRealtime());
+    tapeModel.setControlInterval (qualityGovernor.getTransportInterval());
+    
+    cachedModulationRate = modulationRateParam->load();
+    cachedModulationDepth = modulationDepthParam->load();
+    cachedModulationShape = static_cast<int> (modulationShapeParam->load());
+    cachedMultiHead = multiHeadParam->load() >= 0.5f;
     
-    if (std::abs (delayTime - cachedDelayTime) > tolerance)
+    const auto requestedInterpolation = static_cast<ghostline::InterpolationMode> (static_cast<int> (interpolationParam->load()));
+    const auto interpolation = qualityGovernor.limitInterpolation (requestedInterpolation);
+    const int qualityTier = qualityGovernor.getTier();
+    
+    if (interpolation != cachedInterpolation)
     {
-        cachedDelayTime = delayTime;
+        // Fade from the old read unless the governor is shedding load, when
+        // reading twice would cost more than the step saves
+        const bool shedding = qualityTier > lastQualityTier;
         
-        // Update smoothed delay time target for smooth transitions
-        for (int ch = 0; ch < 2; ++ch)
+        if (! shedding && ! cachedMultiHead && interpolationFadeLength > 0)
+        {
+            fadeFromInterpolation = cachedInterpolation;
+            interpolationFadeRemaining = interpolationFadeLength;
+            
+            for (auto& state : channelStates)
+            {
+                state.floatRead.fading = state.floatRead.current;
+                state.doubleRead.fading = state.doubleRead.current;
+            }
+        }
+        else
         {
-            smoothedDelayTime[ch].setTargetValue(delayTime);
+            interpolationFadeRemaining = 0;
         }
+        
+        // Only the allpass carries state, and it means nothing to another kernel
+        cachedInterpolation = interpolation;
+        for (auto& state : channelStates)
+        {
+            state.floatRead.current = 0.0f;
+            state.doubleRead.current = 0.0;
+        }
+        
+        multiHeadEcho.resetInterpolators();
     }
     
-    if (std::abs (feedback - cachedFeedback) > tolerance)
-    {
-        cachedFeedback = feedback;
-    }
+    lastQualityTier = qualityTier;
     
-    if (std::abs (wet - cachedWetLevel) > tolerance)
+    if (cachedMultiHead)
     {
-        wetGain.setGainLinear (wet);
-        cachedWetLevel = wet;
+        for (int head = 0; head < ghostline::MultiHeadEcho::maxHeads; ++head)
+            multiHeadEcho.setHead (head, headLevelParams[head]->load(), headPanParams[head]->load(), headTimeParams[head]->load());
+        
+        multiHeadEcho.setNumHeads (static_cast<int> (headCountParam->load()));
     }
     
-    if (std::abs (dry - cachedDryLevel) > tolerance)
+    cachedModulationSync = modulationSyncParam->load() >= 0.5f;
+    
+    // Glide towards a new spread so the phase offsets never jump the read position
+    const float spread = modulationSpreadParam->load();
+    cachedModulationSpread += juce::jlimit (-maxSpreadStepPerBlock, maxSpreadStepPerBlock, spread - cachedModulationSpread);
+    cachedModulationBeats = ghostline::getNoteDivisionBeats (static_cast<int> (modulationDivisionParam->load()));
+}
+
+void GhostlineAudioProcessor::updateAutomatedTargets()
+{
+    if (delaySyncParam == nullptr || delayDivisionParam == nullptr || saturationParam == nullptr || overdriveParam == nullptr
+        || mixLawParam == nullptr || tapeModeParam == nullptr || hissParam == nullptr
+        || leftOffsetParam == nullptr || rightOffsetParam == nullptr)
+        return;
+    
+    float delayTime = automatedValues[longDelayActive ? automatedLongDelayTime : automatedDelayTime];
+    
+    if (delaySyncParam->load() >= 0.5f)
     {
-        dryGain.setGainLinear (dry);
-        cachedDryLevel = dry;
+        const double beats = ghostline::getNoteDivisionBeats (static_cast<int> (delayDivisionParam->load()));
+        const double maxSeconds = longDelayActive ? maxLongDelaySeconds : maxDelaySeconds;
+        delayTime = static_cast<float> (juce::jmin (transport.getSecondsForBeats (beats), maxSeconds));
     }
     
-    if (std::abs (modRate - cachedModulationRate) > tolerance)
+    // Overdrive takes the loop past FEEDBACK's clean ceiling, which only a curve can hold
+    float feedback = automatedValues[automatedFeedback];
+    if (static_cast<ghostline::SaturationCurve> (static_cast<int> (saturationParam->load())) != ghostline::SaturationCurve::off)
+        feedback += overdriveParam->load();
+    
+    const float leftOffset = leftOffsetParam->load() * 0.001f;
+    const float rightOffset = rightOffsetParam->load() * 0.001f;
+    
+    // Every change counts, however small: fine automation moves by less than any tolerance
+    if (delayTime != cachedDelayTime || leftOffset != cachedLeftOffset || rightOffset != cachedRightOffset)
     {
-        cachedModulationRate = modRate;
+        cachedDelayTime = delayTime;
+        cachedLeftOffset = leftOffset;
+        cachedRightOffset = rightOffset;
+        
+        // Update smoothed delay time target for smooth transitions
+        for (auto& state : channelStates)
+        {
+            state.smoothedDelayTime.setTargetValue (getChannelDelayTime (state, delayTime));
+        }
     }
     
-    if (std::abs (modDepth - cachedModulationDepth) > tolerance)
+    if (feedback != cachedFeedback)
     {
-        cachedModulationDepth = modDepth;
+        cachedFeedback = feedback;
+        smoothedFeedback.setTargetValue (feedback);
     }
+    
+    // Separate levels, or one MIX knob through a crossfade law
+    const auto mixLaw = static_cast<ghostline::MixLaw> (static_cast<int> (mixLawParam->load()));
+    if (mixLaw == ghostline::MixLaw::separate)
+        mixStage.setLevels (automatedValues[automatedWet], automatedValues[automatedDry]);
+    else
+        mixStage.setMix (automatedValues[automatedMix], mixLaw);
+    
+    // Hiss never stops; otherwise each pass is the longer side's delay plus whatever
+    // the LFO (10 ms) and wow (3 ms) can add to it, and the wash rings on after the last
+    if (tapeModel.isEnabled() && hissParam->load() > 0.0f)
+        tailLengthSeconds = std::numeric_limits<double>::infinity();
+    else
+        tailLengthSeconds = getDecaySeconds (delayTime + juce::jmax (0.0f, leftOffset, rightOffset) + 0.013, feedback, silenceThreshold)
+                              + diffuser.getTailSeconds();
+}
+
+float GhostlineAudioProcessor::getChannelDelayTime (const ChannelState& state, float delayTime) const noexcept
+{
+    // Left channels run early or late by one offset, right channels by the other
+    const float offset = state.side < 0.0f ? cachedLeftOffset : state.side > 0.0f ? cachedRightOffset : 0.0f;
+    return juce::jmax (0.0f, delayTime + offset);
+}
+
+int GhostlineAudioProcessor::getLongestReadDistance (int delayBufferSize) const noexcept
+{
+    // Wherever each side is gliding from or to, plus what the LFO (10 ms) and wow (3 ms)
+    // can add. Latency only brings the reads closer; counting it as well covers what
+    // is still inside the oversampling filters and the smear
+    float longestSeconds = 0.0f;
+    
+    for (const auto& state : channelStates)
+        longestSeconds = juce::jmax (longestSeconds, state.smoothedDelayTime.getCurrentValue(), state.smoothedDelayTime.getTargetValue());
+    
+    const double samples = (longestSeconds + 0.013 + ghostline::Diffuser::maxSmearSeconds) * currentSampleRate
+                             + feedbackSaturator.getLatencyInSamples() + ghostline::interpolationMargin;
+    
+    return static_cast<int> (juce::jmin (static_cast<double> (delayBufferSize), std::ceil (samples)));
 }
 
 //==============================================================================
 juce::AudioProcessorValueTreeState::ParameterLayout GhostlineAudioProcessor::createParameterLayout()
 {
     std::vector<std::unique_ptr<juce::RangedAudioParameter>> params;
+    
+    // Delay time, feedback and the levels are continuous: a step would snap
+    // fine automation to its grid
 
     // Delay Time: 0.01 to 1.0 seconds, default 0.3
     params.push_back (std::make_unique<juce::AudioParameterFloat>(
         juce::ParameterID ("DELAYTIME", 1), "Delay Time",
-        juce::NormalisableRange<float> (0.01f, 1.0f, 0.01f, 0.3f),
+        juce::NormalisableRange<float> (0.01f, 1.0f, 0.0f, 0.3f),
         0.3f, "s"
     ));
 
     // Feedback: 0.0 to 0.95, default 0.3
     params.push_back (std::make_unique<juce::AudioParameterFloat>(
         juce::ParameterID ("FEEDBACK", 1), "Feedback",
-        juce::NormalisableRange<float> (0.0f, 0.95f, 0.01f),
+        juce::NormalisableRange<float> (0.0f, 0.95f, 0.0f),
         0.3f
     ));
 
     // Wet Level: 0.0 to 1.0, default 0.5
     params.push_back (std::make_unique<juce::AudioParameterFloat>(
         juce::ParameterID ("WET", 1), "Wet Level",
-        juce::NormalisableRange<float> (0.0f, 1.0f, 0.01f),
+        juce::NormalisableRange<float> (0.0f, 1.0f, 0.0f),
         0.5f
     ));
 
     // Dry Level: 0.0 to 1.0, default 0.5
     params.push_back (std::make_unique<juce::AudioParameterFloat>(
         juce::ParameterID ("DRY", 1), "Dry Level",
-        juce::NormalisableRange<float> (0.0f, 1.0f, 0.01f),
+        juce::NormalisableRange<float> (0.0f, 1.0f, 0.0f),
+        0.5f
+    ));
+
+    // Mix Law: separate WET and DRY levels, or MIX through a linear or equal-power crossfade, default separate
+    params.push_back (std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID ("MIXLAW", 1), "Mix Law",
+        juce::StringArray { "Wet/Dry", "Linear", "Equal Power" },
+        0
+    ));
+
+    // Mix: 0.0 (all dry) to 1.0 (all wet), default 0.5; used unless MIXLAW is Wet/Dry
+    params.push_back (std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID ("MIX", 1), "Mix",
+        juce::NormalisableRange<float> (0.0f, 1.0f, 0.0f),
         0.5f
     ));
 
@@ -387,6 +1136,247 @@ juce::AudioProcessorValueTreeState::ParameterLayout GhostlineAudioProcessor::cre
         0.0f
     ));
 
+    // Modulation Shape: sine, triangle or smoothed random, default sine
+    params.push_back (std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID ("MODSHAPE", 1), "Modulation Shape",
+        juce::StringArray { "Sine", "Triangle", "Random" },
+        0
+    ));
+
+    // Modulation Spread: LFO phase offset across the channels, 0 keeps them in step
+    params.push_back (std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID ("MODSPREAD", 1), "Modulation Spread",
+        juce::NormalisableRange<float> (0.0f, 1.0f, 0.01f),
+        0.0f
+    ));
+
+    // Interpolation: fractional-delay read quality, cheapest first
+    params.push_back (std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID ("INTERP", 1), "Interpolation",
+        juce::StringArray { "Linear", "Hermite", "Lagrange", "Allpass", "Sinc" },
+        0
+    ));
+
+    // Saturation: record-head curve on input + feedback, default off
+    params.push_back (std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID ("SATURATION", 1), "Saturation",
+        juce::StringArray { "Off", "Tanh", "Tape", "Diode" },
+        0
+    ));
+
+    // Oversampling: rate the saturation curve runs at, default 2x
+    params.push_back (std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID ("OVERSAMPLE", 1), "Oversampling",
+        juce::StringArray { "1x", "2x", "4x", "8x" },
+        1
+    ));
+
+    // Overdrive: 0.0 to 0.55 added to FEEDBACK while SATURATION is on, up to 150% for self-oscillation, default 0
+    params.push_back (std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID ("OVERDRIVE", 1), "Overdrive",
+        juce::NormalisableRange<float> (0.0f, 0.55f, 0.0f),
+        0.0f
+    ));
+
+    // Tape Model: wow, flutter, hiss, head bump and HF loss on every repeat
+    params.push_back (std::make_unique<juce::AudioParameterBool>(
+        juce::ParameterID ("TAPEMODE", 1), "Tape Model",
+        false
+    ));
+
+    // Wow: slow 0.25-2 Hz speed drift, up to 3 ms of read-position movement, default 0.3
+    params.push_back (std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID ("WOW", 1), "Wow",
+        juce::NormalisableRange<float> (0.0f, 1.0f, 0.01f),
+        0.3f
+    ));
+
+    // Flutter: fast 5-40 Hz speed jitter, up to 0.2 ms, default 0.2
+    params.push_back (std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID ("FLUTTER", 1), "Flutter",
+        juce::NormalisableRange<float> (0.0f, 1.0f, 0.01f),
+        0.2f
+    ));
+
+    // Hiss: playback noise from -84 to -48 dB RMS, 0 is silent, default 0.2
+    params.push_back (std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID ("HISS", 1), "Hiss",
+        juce::NormalisableRange<float> (0.0f, 1.0f, 0.01f),
+        0.2f
+    ));
+
+    // Tape Age: high-frequency loss per repeat, 16 kHz fresh to 2.5 kHz worn, default 0.3
+    params.push_back (std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID ("TAPEAGE", 1), "Tape Age",
+        juce::NormalisableRange<float> (0.0f, 1.0f, 0.01f),
+        0.3f
+    ));
+
+    // Long Delay: switches the buffer from 1 s to 60 s and the delay time to LONGTIME
+    params.push_back (std::make_unique<juce::AudioParameterBool>(
+        juce::ParameterID ("LONGMODE", 1), "Long Delay",
+        false
+    ));
+
+    // Long Delay Time: 1.0 to 60.0 seconds, default 4.0
+    params.push_back (std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID ("LONGTIME", 1), "Long Delay Time",
+        juce::NormalisableRange<float> (1.0f, 60.0f, 0.0f, 0.4f),
+        4.0f, "s"
+    ));
+
+    // Long Delay Storage: sample format of the 60 s buffer, default 16-bit
+    params.push_back (std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID ("STORAGE", 1), "Long Delay Storage",
+        juce::StringArray { "32-bit Float", "16-bit", "Block Float" },
+        1
+    ));
+
+    // Delay Sync: take the delay time from DIVISION and the host tempo
+    params.push_back (std::make_unique<juce::AudioParameterBool>(
+        juce::ParameterID ("SYNC", 1), "Delay Sync",
+        false
+    ));
+
+    // Delay Division: straight, dotted and triplet note lengths, default 1/4
+    params.push_back (std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID ("DIVISION", 1), "Delay Division",
+        ghostline::getNoteDivisionNames(),
+        9
+    ));
+
+    // Modulation Sync: lock the LFO to the host transport, one cycle per MODDIVISION
+    params.push_back (std::make_unique<juce::AudioParameterBool>(
+        juce::ParameterID ("MODSYNC", 1), "Modulation Sync",
+        false
+    ));
+
+    // Modulation Division: LFO cycle length, default 1/1
+    params.push_back (std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID ("MODDIVISION", 1), "Modulation Division",
+        ghostline::getNoteDivisionNames(),
+        15
+    ));
+
+    // Multi-Head: RE-201 style read heads sharing the one tape loop
+    params.push_back (std::make_unique<juce::AudioParameterBool>(
+        juce::ParameterID ("HEADMODE", 1), "Multi-Head",
+        false
+    ));
+
+    // Head Count: 4 to 8 active heads, default 4
+    params.push_back (std::make_unique<juce::AudioParameterInt>(
+        juce::ParameterID ("HEADCOUNT", 1), "Head Count",
+        ghostline::MultiHeadEcho::minHeads, ghostline::MultiHeadEcho::maxHeads,
+        ghostline::MultiHeadEcho::minHeads
+    ));
+
+    // Per-head level, pan and spacing. Heads 1-4 default to the classic even
+    // spacing; 5-8 sit halfway between them.
+    const float defaultHeadTimes[]  = { 0.25f, 0.5f, 0.75f, 1.0f, 0.125f, 0.375f, 0.625f, 0.875f };
+    const float defaultHeadLevels[] = { 0.8f, 0.6f, 0.5f, 0.4f, 0.3f, 0.3f, 0.3f, 0.3f };
+    const float defaultHeadPans[]   = { 0.0f, -0.4f, 0.4f, 0.0f, -0.7f, 0.7f, -0.2f, 0.2f };
+
+    for (int head = 0; head < ghostline::MultiHeadEcho::maxHeads; ++head)
+    {
+        const juce::String number (head + 1);
+
+        // Head Level: 0.0 to 1.0
+        params.push_back (std::make_unique<juce::AudioParameterFloat>(
+            juce::ParameterID ("HEAD" + number + "LEVEL", 1), "Head " + number + " Level",
+            juce::NormalisableRange<float> (0.0f, 1.0f, 0.01f),
+            defaultHeadLevels[head]
+        ));
+
+        // Head Pan: -1.0 (left) to 1.0 (right)
+        params.push_back (std::make_unique<juce::AudioParameterFloat>(
+            juce::ParameterID ("HEAD" + number + "PAN", 1), "Head " + number + " Pan",
+            juce::NormalisableRange<float> (-1.0f, 1.0f, 0.01f),
+            defaultHeadPans[head]
+        ));
+
+        // Head Time: 0.05 to 1.0 of the main delay time
+        params.push_back (std::make_unique<juce::AudioParameterFloat>(
+            juce::ParameterID ("HEAD" + number + "TIME", 1), "Head " + number + " Time",
+            juce::NormalisableRange<float> (0.05f, 1.0f, 0.005f),
+            defaultHeadTimes[head]
+        ));
+    }
+
+    // Loop High-Pass: 20 Hz (out of the loop) to 2 kHz, default 20 Hz
+    params.push_back (std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID ("LOOPHP", 1), "Loop High-Pass",
+        juce::NormalisableRange<float> (ghostline::FeedbackFilter::minHighPass, 2000.0f, 0.0f, 0.3f),
+        ghostline::FeedbackFilter::minHighPass, "Hz"
+    ));
+
+    // Loop Low-Pass: 500 Hz to 20 kHz (out of the loop), default 20 kHz
+    params.push_back (std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID ("LOOPLP", 1), "Loop Low-Pass",
+        juce::NormalisableRange<float> (500.0f, ghostline::FeedbackFilter::maxLowPass, 0.0f, 0.3f),
+        ghostline::FeedbackFilter::maxLowPass, "Hz"
+    ));
+
+    // Loop Tilt: -6 dB (darker) to +6 dB (thinner) around 1 kHz, default 0
+    params.push_back (std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID ("LOOPTILT", 1), "Loop Tilt",
+        juce::NormalisableRange<float> (-ghostline::FeedbackFilter::maxTiltDecibels, ghostline::FeedbackFilter::maxTiltDecibels, 0.1f),
+        0.0f, "dB"
+    ));
+
+    // Loop DC Blocker: 5 Hz high-pass in the loop, for saturated feedback
+    params.push_back (std::make_unique<juce::AudioParameterBool>(
+        juce::ParameterID ("LOOPDC", 1), "Loop DC Blocker",
+        false
+    ));
+
+    // Diffusion: 0 (clean repeats, out of the loop) to 1 (every echo a wash), default 0
+    params.push_back (std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID ("DIFFUSION", 1), "Diffusion",
+        juce::NormalisableRange<float> (0.0f, 1.0f, 0.01f),
+        0.0f
+    ));
+
+    // Diffusion Size: 0 (a short, tight smear) to 1 (long lines, a 3 s wash), default 0.5
+    params.push_back (std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID ("DIFFSIZE", 1), "Diffusion Size",
+        juce::NormalisableRange<float> (0.0f, 1.0f, 0.01f),
+        0.5f
+    ));
+
+    // Stereo Mode: each side its own loop, cross-feedback between them, or ping-pong, default independent
+    params.push_back (std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID ("STEREOMODE", 1), "Stereo Mode",
+        juce::StringArray { "Independent", "Cross-Feedback", "Ping-Pong" },
+        0
+    ));
+
+    // Cross-Feedback: share of each side's echo fed back into the other, 0 to 1, default 0.5
+    params.push_back (std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID ("CROSSFEED", 1), "Cross-Feedback",
+        juce::NormalisableRange<float> (0.0f, 1.0f, 0.01f),
+        0.5f
+    ));
+
+    // Left / Right Offset: -50 ms to +50 ms on top of the delay time, default 0
+    params.push_back (std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID ("LEFTOFFSET", 1), "Left Offset",
+        juce::NormalisableRange<float> (-50.0f, 50.0f, 0.0f),
+        0.0f, "ms"
+    ));
+
+    params.push_back (std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID ("RIGHTOFFSET", 1), "Right Offset",
+        juce::NormalisableRange<float> (-50.0f, 50.0f, 0.0f),
+        0.0f, "ms"
+    ));
+
+    // Adaptive Quality: let the CPU governor lower quality when the budget runs short
+    params.push_back (std::make_unique<juce::AudioParameterBool>(
+        juce::ParameterID ("ADAPTIVE", 1), "Adaptive Quality",
+        true
+    ));
+
     return { params.begin(), params.end() };
 }
 
@@ -9,6 +9,28 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "DSP/DelayKernels.h"
+#include "DSP/CompactDelayBuffer.h"
+#include "DSP/DelayMemory.h"
+#include "DSP/ModulationOscillator.h"
+#include "DSP/TempoSync.h"
+#include "DSP/MultiHeadEcho.h"
+#include "DSP/FeedbackSaturator.h"
+#include "DSP/FeedbackFilter.h"
+#include "DSP/Diffuser.h"
+#include "DSP/StereoMatrix.h"
+#include "DSP/TapeModel.h"
+#include "DSP/MixStage.h"
+#include "DSP/BlockVariant.h"
+#include "DSP/QualityGovernor.h"
+#include "DSP/BlockProfiler.h"
+#include "DSP/VisualiserFeed.h"
+#include "DSP/ParameterEventQueue.h"
+
+// Console targets (the benchmark runner) build the processor without its editor
+#ifndef GHOSTLINE_HEADLESS
+ #define GHOSTLINE_HEADLESS 0
+#endif
 
 //==============================================================================
 /**
@@ -17,6 +39,8 @@ class GhostlineAudioProcessor  : public juce::AudioProcessor
                             #if JucePlugin_Enable_ARA
                              , public juce::AudioProcessorARAExtension
                             #endif
+                             , private juce::Timer
+                             , private juce::AudioProcessorParameter::Listener
 {
 public:
     //==============================================================================
@@ -32,6 +56,8 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -66,37 +92,264 @@ public:
     std::atomic<float>* feedbackParam = nullptr;
     std::atomic<float>* wetLevelParam = nullptr;
     std::atomic<float>* dryLevelParam = nullptr;
+    std::atomic<float>* mixParam = nullptr;
+    std::atomic<float>* mixLawParam = nullptr;
     std::atomic<float>* modulationRateParam = nullptr;
     std::atomic<float>* modulationDepthParam = nullptr;
+    std::atomic<float>* modulationShapeParam = nullptr;
+    std::atomic<float>* modulationSpreadParam = nullptr;
+    std::atomic<float>* longModeParam = nullptr;
+    std::atomic<float>* longDelayTimeParam = nullptr;
+    std::atomic<float>* storageFormatParam = nullptr;
+    std::atomic<float>* delaySyncParam = nullptr;
+    std::atomic<float>* delayDivisionParam = nullptr;
+    std::atomic<float>* modulationSyncParam = nullptr;
+    std::atomic<float>* modulationDivisionParam = nullptr;
+    std::atomic<float>* multiHeadParam = nullptr;
+    std::atomic<float>* headCountParam = nullptr;
+    std::atomic<float>* headLevelParams[ghostline::MultiHeadEcho::maxHeads] = {};
+    std::atomic<float>* headPanParams[ghostline::MultiHeadEcho::maxHeads] = {};
+    std::atomic<float>* headTimeParams[ghostline::MultiHeadEcho::maxHeads] = {};
+    std::atomic<float>* interpolationParam = nullptr;
+    std::atomic<float>* saturationParam = nullptr;
+    std::atomic<float>* overdriveParam = nullptr;
+    std::atomic<float>* oversamplingParam = nullptr;
+    std::atomic<float>* tapeModeParam = nullptr;
+    std::atomic<float>* wowParam = nullptr;
+    std::atomic<float>* flutterParam = nullptr;
+    std::atomic<float>* hissParam = nullptr;
+    std::atomic<float>* tapeAgeParam = nullptr;
+    std::atomic<float>* adaptiveQualityParam = nullptr;
+    std::atomic<float>* loopHighPassParam = nullptr;
+    std::atomic<float>* loopLowPassParam = nullptr;
+    std::atomic<float>* loopTiltParam = nullptr;
+    std::atomic<float>* loopDcBlockParam = nullptr;
+    std::atomic<float>* diffusionParam = nullptr;
+    std::atomic<float>* diffusionSizeParam = nullptr;
+    std::atomic<float>* stereoModeParam = nullptr;
+    std::atomic<float>* crossFeedbackParam = nullptr;
+    std::atomic<float>* leftOffsetParam = nullptr;
+    std::atomic<float>* rightOffsetParam = nullptr;
+    
+    // Longest echo available in each mode
+    static constexpr double maxDelaySeconds = 1.0;
+    static constexpr double maxLongDelaySeconds = 60.0;
+    
+    /** Oversampling filter delay for a factor index, for display. The loop
+        compensates it, so it never reaches the host as plugin latency. */
+    float getSaturationLatencySamples (int factorIndex) const noexcept { return feedbackSaturator.getLatencyInSamples (factorIndex); }
+    
+    /** Quality tier the governor has settled on (0 is full quality) and the
+        share of the real-time budget processBlock is using. Any thread. */
+    int getQualityTier() const noexcept     { return qualityGovernor.getTier(); }
+    float getCpuLoad() const noexcept       { return qualityGovernor.getLoad(); }
+    
+    /** Per-block timings: the meter's histogram and overrun count, and trace captures. */
+    ghostline::BlockProfiler& getProfiler() noexcept { return profiler; }
+    
+    /** The first channel's echo, thinned out for the editor's visualiser. */
+    ghostline::VisualiserFeed& getVisualiserFeed() noexcept { return visualiserFeed; }
 
 private:
     //==============================================================================
     // DSP processing - Space Echo style delay with modulation
-    juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::Linear> delayLine;
-    juce::dsp::Gain<float> wetGain;
-    juce::dsp::Gain<float> dryGain;
+    // The loop leaves the echo in the channel; the mix stage blends the dry input back in
+    ghostline::MixStage mixStage;
+    
+    // Feedback glides in steps; the loop takes one value per sub-block
+    juce::SmoothedValue<float> smoothedFeedback;
+    
+    // While feedback glides, sub-blocks are at most this long, so the glide
+    // takes the same steps whatever the host's block size
+    static constexpr int feedbackStepSamples = 32;
+    
+    // The values automation moves most finely. They reach the loop through
+    // the event queue at the sample they changed on, not through the atomics
+    // once per block.
+    enum AutomatedValue
+    {
+        automatedDelayTime = 0,
+        automatedLongDelayTime,
+        automatedFeedback,
+        automatedWet,
+        automatedDry,
+        automatedMix,
+        numAutomatedValues
+    };
+    
+    juce::RangedAudioParameter* automatedParameters[numAutomatedValues] = {};
+    float automatedValues[numAutomatedValues] = {};
+    ghostline::ParameterEventQueue parameterEvents;
+    
+    // Changes made on this thread arrive just before the block they belong to
+    std::atomic<juce::Thread::ThreadID> audioThread { nullptr };
+    
+    // Dynamic delay buffers - sized from the sample rate, all channels in one block.
+    // Long-delay mode with a 16-bit format stores them compactly. A mode or format
+    // change is rebuilt in the background and swapped in at the top of a block.
+    ghostline::DelayMemoryManager delayMemory;
+    ghostline::DelayMemoryLayout requestedMemoryLayout;
+    
+    // Whether the memory the audio thread is using is the long one
+    bool longDelayActive = false;
+    
+    // Everything the echo keeps per bus channel, one contiguous element per
+    // channel, sized from the layout in prepareToPlay
+    struct ChannelState
+    {
+        // Allpass state for the read, and for the outgoing read while the
+        // interpolation mode crossfades; one set per processing precision
+        template <typename SampleType>
+        struct ReadState
+        {
+            SampleType current = 0, fading = 0;
+        };
+        
+        ReadState<float> floatRead;
+        ReadState<double> doubleRead;
+        
+        template <typename SampleType>
+        ReadState<SampleType>& getReadState() noexcept
+        {
+            if constexpr (std::is_same_v<SampleType, double>)
+                return doubleRead;
+            else
+                return floatRead;
+        }
+        
+        ghostline::ModulationOscillator lfo;
+        
+        // Smoothed delay time to prevent clicks when changing delay time
+        juce::SmoothedValue<float> smoothedDelayTime;
+        
+        // -1 left, 1 right, 0 neither: which offset the delay time takes
+        float side = 0.0f;
+    };
+    
+    std::vector<ChannelState> channelStates;
+    
+    // Multi-head mode: several read heads sharing the same delay buffer
+    ghostline::MultiHeadEcho multiHeadEcho;
+    
+    // Oversampled saturation on the record signal, input + feedback
+    ghostline::FeedbackSaturator feedbackSaturator;
+    
+    // High-pass, low-pass, tilt and DC blocking on what is recorded, ahead of the curve
+    ghostline::FeedbackFilter feedbackFilter;
+    
+    // A feedback delay network washing the input, and allpasses smearing each repeat
+    ghostline::Diffuser diffuser;
+    
+    // Cross-feedback and ping-pong between the two sides of a stereo pair
+    ghostline::StereoMatrix stereoMatrix;
+    
+    // Tape transport and playback colour
+    ghostline::TapeModel tapeModel;
     
-    // Dynamic delay buffers - allocated based on sample rate
-    std::vector<std::vector<float>> delayBuffer;
-    int delayBufferSize = 44100;
-    int writePosition[2] = {0, 0};
+    // Trades interpolation and modulation resolution for time when the budget runs short
+    ghostline::QualityGovernor qualityGovernor;
+    int lastQualityTier = 0;
     
-    float lfoPhase[2] = {0.0f, 0.0f};
+    // Times each block for the governor and the editor's meter
+    ghostline::BlockProfiler profiler;
+    
+    ghostline::VisualiserFeed visualiserFeed;
+    
+    // A change of interpolation mode crossfades from the old read to the new one,
+    // except when the governor is shedding load or multi-head is on
+    ghostline::InterpolationMode fadeFromInterpolation = ghostline::InterpolationMode::linear;
+    int interpolationFadeLength = 0;
+    int interpolationFadeRemaining = 0;
+    
+    // Per-sample LFO output for the channel being processed
+    juce::AudioBuffer<float> lfoBuffer;
+    
+    // Per-sample read distance handed to the delay kernel, the dry input it
+    // overwrites, and the outgoing read of an interpolation crossfade, in the
+    // precision the loop runs at
+    template <typename SampleType>
+    struct LoopBuffers
+    {
+        juce::AudioBuffer<SampleType> delaySamples, dry, fade;
+    };
+    
+    LoopBuffers<float> floatBuffers;
+    LoopBuffers<double> doubleBuffers;
+    
+    template <typename SampleType>
+    LoopBuffers<SampleType>& getLoopBuffers() noexcept
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doubleBuffers;
+        else
+            return floatBuffers;
+    }
+    
+    const ghostline::DelayKernel& delayKernel = ghostline::getDelayKernel();
+    
+    // The whole block for either precision; both processBlock overloads land here
+    template <typename SampleType>
+    void processSamples (juce::AudioBuffer<SampleType>& buffer);
+    
+    // One stretch of the block with no parameter change inside it; blockOffset
+    // is where it starts in the host's block
+    template <typename SampleType>
+    void processSubBlock (juce::AudioBuffer<SampleType>& buffer, ghostline::DelayMemory& memory, int blockOffset);
     
     void updateParameters();
     
+    // Delay time, feedback and mix targets from automatedValues; once per sub-block
+    void updateAutomatedTargets();
+    
+    // The delay time with the channel's side offset added
+    float getChannelDelayTime (const ChannelState& state, float delayTime) const noexcept;
+    
+    // How far back any read can reach this sub-block, in samples, up to the memory's size
+    int getLongestReadDistance (int delayBufferSize) const noexcept;
+    
+    // Takes every automated value from its atomic, after a restart or a dropped change
+    void resyncAutomatedValues();
+    
+    void parameterValueChanged (int parameterIndex, float newValue) override;
+    void parameterGestureChanged (int, bool) override {}
+    void allocateDelayMemory();
+    
+    template <typename SampleType>
+    bool isInputSilent (const juce::AudioBuffer<SampleType>& buffer, int numChannels) const;
+    ghostline::DelayMemoryLayout getWantedMemoryLayout() const;
+    
+    // Asks for new delay memory when the long-delay mode or storage format
+    // changes; the audio thread never allocates and never stops
+    void timerCallback() override;
+    
     double currentSampleRate = 44100.0;
+    
+    // -120 dB: below it the input counts as silent and the echo as finished
+    static constexpr float silenceThreshold = 1.0e-6f;
+    
+    // Samples since anything above the threshold was written to the delay
+    // memory; a whole buffer of them means there is no echo left to play
+    juce::int64 samplesSinceLoudWrite = 0;
+    
+    // Updated with the parameters, read by the host from any thread
+    std::atomic<double> tailLengthSeconds { 2.0 };
+    
+    // Host tempo and position, read once at the top of each block
+    ghostline::TransportState transport;
 
     // Cached parameter values
     float cachedDelayTime = 0.3f;
+    float cachedLeftOffset = 0.0f, cachedRightOffset = 0.0f;   // Seconds
     float cachedFeedback = 0.3f;
-    float cachedWetLevel = 0.5f;
-    float cachedDryLevel = 0.5f;
     float cachedModulationRate = 0.5f;
     float cachedModulationDepth = 0.0f;
-    
-    // Smoothed delay time to prevent clicks when changing delay time
-    juce::SmoothedValue<float> smoothedDelayTime[2];
+    int cachedModulationShape = 0;
+    float cachedModulationSpread = 0.0f;
+    static constexpr float maxSpreadStepPerBlock = 0.01f;
+    bool cachedMultiHead = false;
+    ghostline::InterpolationMode cachedInterpolation = ghostline::InterpolationMode::linear;
+    bool cachedModulationSync = false;
+    double cachedModulationBeats = 1.0;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GhostlineAudioProcessor)
 };